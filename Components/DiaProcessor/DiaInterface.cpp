@@ -1,42 +1,32 @@
 #include "DiaInterface.h"
+#include "DiaSession.h"
 
 #include <spdlog/spdlog.h>
 
-#include <Windows.h>
-#include <atlcomcli.h>
-#include <dia2.h>
-
 #include <stdexcept>
 #include <memory>
 #include <unordered_set>
 
 namespace DiaInterface
 {
-  static CComPtr<IDiaSession> s_pSession = nullptr;
-  static CComPtr<IDiaDataSource> s_pDataSource = nullptr;
-  static CComPtr<IDiaSymbol> s_pGlobalScopeSymbol = nullptr;
-
-  void Release()
+  ComScope::ComScope()
   {
-    if (s_pSession)
-      s_pSession.Release();
-    if (s_pDataSource)
-      s_pDataSource.Release();
-    if (s_pGlobalScopeSymbol)
-      s_pGlobalScopeSymbol.Release();
-
-    CoUninitialize();
+    isInitialized = SUCCEEDED(CoInitialize(NULL));
   }
 
-  void InitializeDia(const char* apFileName)
+  ComScope::~ComScope()
   {
-    CoInitialize(NULL);
+    if (isInitialized)
+      CoUninitialize();
+  }
 
+  DiaSession::DiaSession(const char* apFileName)
+  {
     HRESULT result = CoCreateInstance(CLSID_DiaSource,
       NULL,
       CLSCTX_INPROC_SERVER,
       __uuidof(IDiaDataSource),
-      (void**)&s_pDataSource);
+      (void**)&pDataSource);
 
     if (FAILED(result))
       throw std::runtime_error("CoCreateInstance failed.");
@@ -45,13 +35,13 @@ namespace DiaInterface
     auto fileNameUnicode = std::make_unique<WCHAR[]>(fileNameLength);
     MultiByteToWideChar(CP_UTF8, 0, apFileName, -1, fileNameUnicode.get(), fileNameLength);
 
-    if (FAILED(s_pDataSource->loadDataFromPdb(fileNameUnicode.get())))
+    if (FAILED(pDataSource->loadDataFromPdb(fileNameUnicode.get())))
       throw std::runtime_error("loadDataFromPdb failed.");
 
-    if (FAILED(s_pDataSource->openSession(&s_pSession)))
+    if (FAILED(pDataSource->openSession(&pSession)))
       throw std::runtime_error("openSession failed.");
 
-    if (FAILED(s_pSession->get_globalScope(&s_pGlobalScopeSymbol)))
+    if (FAILED(pSession->get_globalScope(&pGlobalScopeSymbol)))
       throw std::runtime_error("get_globalScope failed.");
   }
 
@@ -139,11 +129,14 @@ namespace DiaInterface
     }
   }
 
+  // Counts per conversion, which runs on a single thread, so a file gets the same names
+  // whatever else is converted alongside it.
+  static thread_local size_t s_pointerCounter = 0;
+
   std::string GeneratePointerName()
   {
-    static size_t s_counter = 0;
-    s_counter++;
-    return std::format("pUnk{}", s_counter);
+    s_pointerCounter++;
+    return std::format("pUnk{}", s_pointerCounter);
   }
 
   bool CreateTypeSymbol(USYM& aUsym, IDiaSymbol* apSymbol);
@@ -157,7 +150,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GetNameFromSymbol(apSymbol);
+    symbol.name = aUsym.Intern(GetNameFromSymbol(apSymbol));
 
     LONG offset{};
     apSymbol->get_offset(&offset);
@@ -260,7 +253,7 @@ namespace DiaInterface
     }
   }
 
-  std::optional<USYM::TypeSymbol> CreateBaseTypeSymbol(IDiaSymbol* apSymbol)
+  std::optional<USYM::TypeSymbol> CreateBaseTypeSymbol(USYM& aUsym, IDiaSymbol* apSymbol)
   {
     USYM::TypeSymbol symbol{};
     symbol.type = USYM::TypeSymbol::Type::kBase;
@@ -279,7 +272,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.length = size;
 
-    symbol.name = GetBaseName(static_cast<BasicType>(baseType), size);
+    symbol.name = aUsym.Intern(GetBaseName(static_cast<BasicType>(baseType), size));
 
     return symbol;
   }
@@ -315,7 +308,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GetNameFromSymbol(apSymbol);
+    symbol.name = aUsym.Intern(GetNameFromSymbol(apSymbol));
 
     ULONGLONG length = 0;
     if (apSymbol->get_length(&length) != S_OK)
@@ -337,7 +330,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GetNameFromSymbol(apSymbol);
+    symbol.name = aUsym.Intern(GetNameFromSymbol(apSymbol));
 
     ULONGLONG length = 0;
     if (apSymbol->get_length(&length) != S_OK)
@@ -349,7 +342,7 @@ namespace DiaInterface
     return symbol;
   }
 
-  std::optional<USYM::TypeSymbol> CreatePointerTypeSymbol(IDiaSymbol* apSymbol)
+  std::optional<USYM::TypeSymbol> CreatePointerTypeSymbol(USYM& aUsym, IDiaSymbol* apSymbol)
   {
     USYM::TypeSymbol symbol{};
     symbol.type = USYM::TypeSymbol::Type::kPointer;
@@ -359,7 +352,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GeneratePointerName();
+    symbol.name = aUsym.Intern(GeneratePointerName());
 
     ULONGLONG length = 0;
     if (apSymbol->get_length(&length) != S_OK)
@@ -379,7 +372,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GetNameFromSymbol(apSymbol);
+    symbol.name = aUsym.Intern(GetNameFromSymbol(apSymbol));
 
     IDiaSymbol* pUnderlyingType = nullptr;
     if (apSymbol->get_type(&pUnderlyingType) != S_OK)
@@ -418,7 +411,7 @@ namespace DiaInterface
       return std::nullopt;
     symbol.id = id;
 
-    symbol.name = GetNameFromSymbol(apSymbol);
+    symbol.name = aUsym.Intern(GetNameFromSymbol(apSymbol));
 
     ULONGLONG length = 0;
     if (apSymbol->get_length(&length) != S_OK)
@@ -444,14 +437,16 @@ namespace DiaInterface
 
     // TODO: currently, a previously defined type symbol is redefined.
     // This behavior is probably unwanted.
-    USYM::TypeSymbol& symbol = aUsym.typeSymbols[id];
+    // The placeholder stops recursion on self referencing types. No reference is kept to it,
+    // since creating the members inserts into the type table, which invalidates references.
+    aUsym.typeSymbols[id];
 
     std::optional<USYM::TypeSymbol> symbolResult = std::nullopt;
 
     switch (symTag)
     {
     case SymTagBaseType:
-      symbolResult = CreateBaseTypeSymbol(apSymbol);
+      symbolResult = CreateBaseTypeSymbol(aUsym, apSymbol);
       break;
     case SymTagUDT:
       symbolResult = CreateUDTSymbol(aUsym, apSymbol);
@@ -460,7 +455,7 @@ namespace DiaInterface
       symbolResult = CreateEnumSymbol(aUsym, apSymbol);
       break;
     case SymTagPointerType:
-      symbolResult = CreatePointerTypeSymbol(apSymbol);
+      symbolResult = CreatePointerTypeSymbol(aUsym, apSymbol);
       break;
     case SymTagTypedef:
       symbolResult = CreateTypedefSymbol(aUsym, apSymbol);
@@ -475,15 +470,15 @@ namespace DiaInterface
     if (!symbolResult)
       return false;
 
-    symbol = symbolResult.value();
+    aUsym.typeSymbols[id] = std::move(symbolResult.value());
 
     return true;
   }
 
-  void BuildTypeList(USYM& aUsym, enum SymTagEnum aType)
+  void BuildTypeList(USYM& aUsym, const DiaSession& aSession, enum SymTagEnum aType)
   {
     CComPtr<IDiaEnumSymbols> pCurrentSymbol = nullptr;
-    if (SUCCEEDED(s_pGlobalScopeSymbol->findChildren(aType, nullptr, nsNone, &pCurrentSymbol)))
+    if (SUCCEEDED(aSession.GetGlobalScope()->findChildren(aType, nullptr, nsNone, &pCurrentSymbol)))
     {
       IDiaSymbol* rgelt = nullptr;
       ULONG pceltFetched = 0;
@@ -502,10 +497,10 @@ namespace DiaInterface
     }
   }
 
-  void BuildFunctionList(USYM& aUsym)
+  void BuildFunctionList(USYM& aUsym, const DiaSession& aSession)
   {
     CComPtr<IDiaEnumSymbols> pCurrentSymbol = nullptr;
-    if (SUCCEEDED(s_pGlobalScopeSymbol->findChildren(SymTagFunction, nullptr, nsNone, &pCurrentSymbol)))
+    if (SUCCEEDED(aSession.GetGlobalScope()->findChildren(SymTagFunction, nullptr, nsNone, &pCurrentSymbol)))
     {
       IDiaSymbol* rgelt = nullptr;
       ULONG pceltFetched = 0;
@@ -522,7 +517,7 @@ namespace DiaInterface
         
         symbol.id = id;
 
-        symbol.name = GetNameFromSymbol(pFunction);
+        symbol.name = aUsym.Intern(GetNameFromSymbol(pFunction));
 
         IDiaSymbol* pFunctionType = nullptr;
         pFunction->get_type(&pFunctionType);
@@ -657,16 +652,21 @@ namespace DiaInterface
         result = pFunction->get_virtualAddress(&virtualAddress);
         if (result == S_OK)
           symbol.virtualAddress = virtualAddress;
+
+        ULONGLONG length = 0;
+        result = pFunction->get_length(&length);
+        if (result == S_OK)
+          symbol.length = length;
       }
     }
   }
 
-  void BuildHeader(USYM& aUsym)
+  void BuildHeader(USYM& aUsym, const DiaSession& aSession)
   {
     aUsym.header.originalFormat = USYM::OriginalFormat::kPdb;
     
     DWORD machineType = 0;
-    HRESULT result = s_pGlobalScopeSymbol->get_machineType(&machineType);
+    HRESULT result = aSession.GetGlobalScope()->get_machineType(&machineType);
     if (result == S_OK)
     {
       switch (machineType)
@@ -693,31 +693,40 @@ namespace DiaInterface
   {
     try
     {
-      InitializeDia(apFileName);
-      
+      DiaSession session(apFileName);
+      s_pointerCounter = 0;
+
       USYM usym{};
 
-      BuildHeader(usym);
+      BuildHeader(usym, session);
 
       // TODO: anon structs
       // TODO: padding?
-      BuildTypeList(usym, SymTagBaseType);
-      BuildTypeList(usym, SymTagUDT);
-      BuildTypeList(usym, SymTagEnum);
-      BuildTypeList(usym, SymTagTypedef);
-      BuildTypeList(usym, SymTagPointerType);
-
-      BuildFunctionList(usym);
+      BuildTypeList(usym, session, SymTagBaseType);
+      BuildTypeList(usym, session, SymTagUDT);
+      BuildTypeList(usym, session, SymTagEnum);
+      BuildTypeList(usym, session, SymTagTypedef);
+      BuildTypeList(usym, session, SymTagPointerType);
 
-      Release();
+      BuildFunctionList(usym, session);
 
       return usym;
     }
     catch (const std::exception& e)
     {
       spdlog::error("{}", e.what());
-      Release();
       return std::nullopt;
     }
   }
+
+  std::vector<BatchTiming> CreateUsymsFromFiles(std::span<const std::string> aFileNames, const BatchCallback& aCallback, const BatchOptions& aOptions)
+  {
+    // Every file opens its own session on the thread that took it.
+    const std::vector<uint64_t> sizes = GetFileSizes(aFileNames);
+    return RunBatch(sizes, [&](size_t aIndex, size_t)
+    {
+      std::optional<USYM> usym = CreateUsymFromFile(aFileNames[aIndex].c_str());
+      return aCallback(aIndex, usym);
+    }, aOptions);
+  }
 }
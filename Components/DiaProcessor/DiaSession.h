@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Windows.h>
+#include <atlcomcli.h>
+#include <dia2.h>
+
+namespace DiaInterface
+{
+  // COM initialized on the current thread for as long as the object lives.
+  class ComScope
+  {
+  public:
+    ComScope();
+    ~ComScope();
+
+    ComScope(const ComScope&) = delete;
+    ComScope& operator=(const ComScope&) = delete;
+
+  private:
+    bool isInitialized{};
+  };
+
+  // A PDB opened through DIA, what a conversion reads from. Each conversion opens its own,
+  // so PDBs can be converted on several threads at once. DIA objects belong to the thread that
+  // created them, a session must not be handed to another thread.
+  class DiaSession
+  {
+  public:
+    // Throws std::runtime_error if the PDB can't be loaded.
+    explicit DiaSession(const char* apFileName);
+
+    DiaSession(const DiaSession&) = delete;
+    DiaSession& operator=(const DiaSession&) = delete;
+
+    IDiaSymbol* GetGlobalScope() const { return pGlobalScopeSymbol; }
+
+  private:
+    // Declared first so COM is uninitialized only after the DIA objects are released.
+    ComScope comScope{};
+    CComPtr<IDiaDataSource> pDataSource = nullptr;
+    CComPtr<IDiaSession> pSession = nullptr;
+    CComPtr<IDiaSymbol> pGlobalScopeSymbol = nullptr;
+  };
+}
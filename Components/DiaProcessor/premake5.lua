@@ -9,6 +9,7 @@ project "DiaProcessor"
       "../",
       "../../Vendor/spdlog/include",
       "../../Vendor/DIASDK/include",
+      "../../Libraries/RECore"
    }
    
    libdirs
@@ -18,4 +19,5 @@ project "DiaProcessor"
    }
 
    links "UniversalSymbolsFormat"
-   links "diaguids"
\ No newline at end of file
+   links "diaguids"
+   links "RECore"
\ No newline at end of file
@@ -0,0 +1,1352 @@
+#include "DwarfParser.h"
+
+#include "DWARF.h"
+
+#include <ParallelFor.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace ElfInterface
+{
+	namespace
+	{
+		// Bounds checked little endian reader over a section. Reading past the end
+		// yields zeroes and sets the overflow flag instead of throwing.
+		class Cursor
+		{
+		public:
+			Cursor() = default;
+			Cursor(std::span<const uint8_t> aData, uint64_t aOffset = 0)
+				: pBegin(aData.data()), pCurrent(aData.data()), pEnd(aData.data() + aData.size())
+			{
+				Seek(aOffset);
+			}
+
+			uint64_t GetOffset() const { return pCurrent - pBegin; }
+			bool IsAtEnd() const { return pCurrent >= pEnd; }
+			bool HasOverflowed() const { return overflow; }
+
+			void Seek(uint64_t aOffset)
+			{
+				if (aOffset > static_cast<uint64_t>(pEnd - pBegin))
+				{
+					overflow = true;
+					pCurrent = pEnd;
+					return;
+				}
+
+				pCurrent = pBegin + aOffset;
+			}
+
+			void Skip(uint64_t aCount)
+			{
+				if (aCount > static_cast<uint64_t>(pEnd - pCurrent))
+				{
+					overflow = true;
+					pCurrent = pEnd;
+					return;
+				}
+
+				pCurrent += aCount;
+			}
+
+			uint64_t ReadFixed(size_t aSize)
+			{
+				if (aSize > static_cast<size_t>(pEnd - pCurrent))
+				{
+					overflow = true;
+					pCurrent = pEnd;
+					return 0;
+				}
+
+				uint64_t value = 0;
+				std::memcpy(&value, pCurrent, aSize);
+				pCurrent += aSize;
+				return value;
+			}
+
+			uint8_t ReadU8() { return static_cast<uint8_t>(ReadFixed(1)); }
+			uint16_t ReadU16() { return static_cast<uint16_t>(ReadFixed(2)); }
+			uint32_t ReadU32() { return static_cast<uint32_t>(ReadFixed(4)); }
+			uint64_t ReadU64() { return ReadFixed(8); }
+
+			uint64_t ReadULEB128()
+			{
+				uint64_t value = 0;
+				uint32_t shift = 0;
+
+				while (pCurrent < pEnd)
+				{
+					const uint8_t byte = *pCurrent++;
+					if (shift < 64)
+						value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+					shift += 7;
+
+					if ((byte & 0x80) == 0)
+						return value;
+				}
+
+				overflow = true;
+				return value;
+			}
+
+			int64_t ReadSLEB128()
+			{
+				int64_t value = 0;
+				uint32_t shift = 0;
+				uint8_t byte = 0;
+
+				do
+				{
+					if (pCurrent >= pEnd)
+					{
+						overflow = true;
+						return value;
+					}
+
+					byte = *pCurrent++;
+					if (shift < 64)
+						value |= static_cast<int64_t>(byte & 0x7f) << shift;
+					shift += 7;
+				} while (byte & 0x80);
+
+				if (shift < 64 && (byte & 0x40))
+					value |= -(static_cast<int64_t>(1) << shift);
+
+				return value;
+			}
+
+			std::string_view ReadCString()
+			{
+				const uint8_t* pTerminator = static_cast<const uint8_t*>(std::memchr(pCurrent, 0, pEnd - pCurrent));
+				if (!pTerminator)
+				{
+					overflow = true;
+					pCurrent = pEnd;
+					return {};
+				}
+
+				std::string_view string(reinterpret_cast<const char*>(pCurrent), pTerminator - pCurrent);
+				pCurrent = pTerminator + 1;
+				return string;
+			}
+
+			const uint8_t* GetCurrent() const { return pCurrent; }
+
+		private:
+			const uint8_t* pBegin = nullptr;
+			const uint8_t* pCurrent = nullptr;
+			const uint8_t* pEnd = nullptr;
+			bool overflow = false;
+		};
+
+		std::string_view GetStringAt(std::span<const uint8_t> aSection, uint64_t aOffset)
+		{
+			if (aOffset >= aSection.size())
+				return {};
+
+			Cursor cursor(aSection, aOffset);
+			return cursor.ReadCString();
+		}
+
+		struct AttributeSpec
+		{
+			uint16_t name{};
+			uint16_t form{};
+			int64_t implicitConst{};
+		};
+
+		struct Abbreviation
+		{
+			uint16_t tag{};
+			bool hasChildren{};
+			uint32_t firstSpec{};
+			uint32_t specCount{};
+		};
+
+		// Abbreviation codes are almost always assigned sequentially, so they are stored
+		// in a flat array indexed by code, with a map only as fallback for sparse tables.
+		struct AbbreviationTable
+		{
+			bool Parse(std::span<const uint8_t> aSection, uint64_t aOffset)
+			{
+				Cursor cursor(aSection, aOffset);
+
+				std::vector<std::pair<uint64_t, Abbreviation>> entries{};
+
+				while (!cursor.IsAtEnd())
+				{
+					const uint64_t code = cursor.ReadULEB128();
+					if (code == 0)
+						break;
+
+					Abbreviation& abbreviation = entries.emplace_back(code, Abbreviation{}).second;
+					abbreviation.tag = static_cast<uint16_t>(cursor.ReadULEB128());
+					abbreviation.hasChildren = cursor.ReadU8() == DWARF::DW_CHILDREN_yes;
+					abbreviation.firstSpec = static_cast<uint32_t>(specs.size());
+
+					while (!cursor.IsAtEnd())
+					{
+						AttributeSpec spec{};
+						spec.name = static_cast<uint16_t>(cursor.ReadULEB128());
+						spec.form = static_cast<uint16_t>(cursor.ReadULEB128());
+						if (spec.form == DWARF::DW_FORM_implicit_const)
+							spec.implicitConst = cursor.ReadSLEB128();
+
+						if (spec.name == 0 && spec.form == 0)
+							break;
+
+						specs.push_back(spec);
+					}
+
+					abbreviation.specCount = static_cast<uint32_t>(specs.size()) - abbreviation.firstSpec;
+				}
+
+				if (cursor.HasOverflowed())
+					return false;
+
+				bool isSequential = true;
+				for (size_t i = 0; i < entries.size(); i++)
+				{
+					if (entries[i].first != i + 1)
+					{
+						isSequential = false;
+						break;
+					}
+				}
+
+				if (isSequential)
+				{
+					sequential.reserve(entries.size());
+					for (const auto& [code, abbreviation] : entries)
+						sequential.push_back(abbreviation);
+				}
+				else
+				{
+					for (const auto& [code, abbreviation] : entries)
+						sparse[code] = abbreviation;
+				}
+
+				return true;
+			}
+
+			const Abbreviation* Find(uint64_t aCode) const
+			{
+				if (aCode - 1 < sequential.size())
+					return &sequential[aCode - 1];
+
+				const auto it = sparse.find(aCode);
+				return it != sparse.end() ? &it->second : nullptr;
+			}
+
+			std::vector<Abbreviation> sequential{};
+			std::unordered_map<uint64_t, Abbreviation> sparse{};
+			std::vector<AttributeSpec> specs{};
+		};
+
+		// Value of an attribute before it is interpreted; strings and addresses may be
+		// indices that can only be resolved with the unit's base offsets.
+		struct RawValue
+		{
+			uint16_t form{};
+			uint64_t value{};
+			const uint8_t* pBlock{};
+		};
+
+		// The attributes of a DIE the converter cares about. Everything else is skipped while decoding.
+		struct Die
+		{
+			enum : uint32_t
+			{
+				kName = 1 << 0,
+				kType = 1 << 1,
+				kByteSize = 1 << 2,
+				kMemberLocation = 1 << 3,
+				kDataBitOffset = 1 << 4,
+				kLowPc = 1 << 5,
+				kCount = 1 << 6,
+				kUpperBound = 1 << 7,
+				kLowerBound = 1 << 8,
+				kDeclaration = 1 << 9,
+				kSpecification = 1 << 10,
+				kAbstractOrigin = 1 << 11,
+				kStrOffsetsBase = 1 << 12,
+				kAddrBase = 1 << 13,
+				kHighPc = 1 << 14,
+			};
+
+			bool Has(uint32_t aAttribute) const { return (present & aAttribute) != 0; }
+
+			uint64_t offset{};
+			const Abbreviation* pAbbreviation{};
+			uint32_t present{};
+
+			RawValue name{};
+			RawValue memberLocation{};
+			RawValue lowPc{};
+			RawValue highPc{};
+			uint64_t type{};
+			uint64_t byteSize{};
+			uint64_t dataBitOffset{};
+			uint64_t count{};
+			uint64_t upperBound{};
+			uint64_t lowerBound{};
+			uint64_t specification{};
+			uint64_t abstractOrigin{};
+			uint64_t strOffsetsBase{};
+			uint64_t addrBase{};
+		};
+
+		struct UnitState
+		{
+			const DwarfParser::Unit* pUnit{};
+			AbbreviationTable abbreviations{};
+			uint64_t strOffsetsBase{};
+			uint64_t addrBase{};
+		};
+
+		class UnitDecoder
+		{
+		public:
+			UnitDecoder(const DwarfSections& aSections, const std::vector<DwarfParser::Unit>& aUnits,
+				const std::unordered_map<uint64_t, uint64_t>& aTypeSignatures, DwarfParser::Fragment& aFragment)
+				: sections(aSections), units(aUnits), typeSignatures(aTypeSignatures), fragment(aFragment)
+			{}
+
+			bool Decode(size_t aUnitIndex)
+			{
+				const DwarfParser::Unit& unit = units[aUnitIndex];
+				if (!PrepareUnit(unit, state))
+					return false;
+
+				Cursor cursor(sections.info.first(unit.end), unit.firstDieOffset);
+				Die die{};
+
+				while (!cursor.IsAtEnd())
+				{
+					const uint64_t dieOffset = cursor.GetOffset();
+					const uint64_t code = cursor.ReadULEB128();
+
+					if (code == 0)
+					{
+						if (!scopes.empty())
+							CloseScope();
+						continue;
+					}
+
+					const Abbreviation* pAbbreviation = state.abbreviations.Find(code);
+					if (!pAbbreviation)
+					{
+						spdlog::error("Unknown abbreviation code {} at .debug_info offset {:#x}.", code, dieOffset);
+						return false;
+					}
+
+					if (!DecodeAttributes(cursor, state, *pAbbreviation, dieOffset, die))
+					{
+						spdlog::error("Failed to decode DIE at .debug_info offset {:#x}.", dieOffset);
+						return false;
+					}
+
+					const Scope scope = ProcessDie(die);
+					if (pAbbreviation->hasChildren)
+						scopes.push_back(scope);
+				}
+
+				while (!scopes.empty())
+					CloseScope();
+
+				return !cursor.HasOverflowed();
+			}
+
+		private:
+			struct Scope
+			{
+				enum class Kind : uint8_t
+				{
+					kNone,
+					kType,
+					kFunction,
+				};
+
+				Kind kind{ Kind::kNone };
+				uint16_t tag{};
+				uint32_t index{};
+			};
+
+			struct PendingType
+			{
+				USYM::TypeSymbol symbol{};
+				std::string_view name{};
+				// By field, including the ones without a name.
+				std::vector<std::string_view> fieldNames{};
+				uint32_t enumUnderlyingTypeId{};
+				uint64_t elementCount{};
+				bool hasElementCount{};
+			};
+
+			struct PendingFunction
+			{
+				USYM::FunctionSymbol symbol{};
+				std::string_view name{};
+			};
+
+			bool PrepareUnit(const DwarfParser::Unit& aUnit, UnitState& aState) const
+			{
+				aState.pUnit = &aUnit;
+				aState.abbreviations = AbbreviationTable{};
+
+				if (!aState.abbreviations.Parse(sections.abbrev, aUnit.abbrevOffset))
+				{
+					spdlog::error("Failed to parse abbreviation table at offset {:#x}.", aUnit.abbrevOffset);
+					return false;
+				}
+
+				// The base offsets for indexed strings and addresses live on the unit DIE itself.
+				Cursor cursor(sections.info.first(aUnit.end), aUnit.firstDieOffset);
+				const uint64_t code = cursor.ReadULEB128();
+				const Abbreviation* pAbbreviation = aState.abbreviations.Find(code);
+				if (!pAbbreviation)
+					return code == 0;
+
+				Die die{};
+				if (!DecodeAttributes(cursor, aState, *pAbbreviation, aUnit.firstDieOffset, die))
+					return false;
+
+				aState.strOffsetsBase = die.Has(Die::kStrOffsetsBase) ? die.strOffsetsBase : 0;
+				aState.addrBase = die.Has(Die::kAddrBase) ? die.addrBase : 0;
+
+				// Without an explicit base, DWARF 5 indices start right after the section header.
+				if (!die.Has(Die::kStrOffsetsBase) && aUnit.version >= 5)
+					aState.strOffsetsBase = aUnit.offsetSize == 8 ? 16 : 8;
+				if (!die.Has(Die::kAddrBase) && aUnit.version >= 5)
+					aState.addrBase = aUnit.offsetSize == 8 ? 16 : 8;
+
+				return true;
+			}
+
+			uint64_t ResolveReference(const UnitState& aState, uint16_t aForm, uint64_t aValue) const
+			{
+				switch (aForm)
+				{
+				case DWARF::DW_FORM_ref1:
+				case DWARF::DW_FORM_ref2:
+				case DWARF::DW_FORM_ref4:
+				case DWARF::DW_FORM_ref8:
+				case DWARF::DW_FORM_ref_udata:
+					return aState.pUnit->offset + aValue;
+				case DWARF::DW_FORM_ref_addr:
+					return aValue;
+				case DWARF::DW_FORM_ref_sig8:
+				{
+					const auto it = typeSignatures.find(aValue);
+					return it != typeSignatures.end() ? it->second : 0;
+				}
+				default:
+					// References into supplementary or alternate object files are not supported.
+					return 0;
+				}
+			}
+
+			bool DecodeAttributes(Cursor& aCursor, const UnitState& aState, const Abbreviation& aAbbreviation, uint64_t aOffset, Die& aDie) const
+			{
+				const DwarfParser::Unit& unit = *aState.pUnit;
+
+				aDie.offset = aOffset;
+				aDie.pAbbreviation = &aAbbreviation;
+				aDie.present = 0;
+
+				for (uint32_t i = 0; i < aAbbreviation.specCount; i++)
+				{
+					const AttributeSpec& spec = aState.abbreviations.specs[aAbbreviation.firstSpec + i];
+
+					RawValue value{};
+					value.form = spec.form;
+					if (value.form == DWARF::DW_FORM_indirect)
+						value.form = static_cast<uint16_t>(aCursor.ReadULEB128());
+
+					switch (value.form)
+					{
+					case DWARF::DW_FORM_addr:
+						value.value = aCursor.ReadFixed(unit.addressSize);
+						break;
+					case DWARF::DW_FORM_data1:
+					case DWARF::DW_FORM_ref1:
+					case DWARF::DW_FORM_flag:
+					case DWARF::DW_FORM_strx1:
+					case DWARF::DW_FORM_addrx1:
+						value.value = aCursor.ReadU8();
+						break;
+					case DWARF::DW_FORM_data2:
+					case DWARF::DW_FORM_ref2:
+					case DWARF::DW_FORM_strx2:
+					case DWARF::DW_FORM_addrx2:
+						value.value = aCursor.ReadU16();
+						break;
+					case DWARF::DW_FORM_strx3:
+					case DWARF::DW_FORM_addrx3:
+						value.value = aCursor.ReadFixed(3);
+						break;
+					case DWARF::DW_FORM_data4:
+					case DWARF::DW_FORM_ref4:
+					case DWARF::DW_FORM_ref_sup4:
+					case DWARF::DW_FORM_strx4:
+					case DWARF::DW_FORM_addrx4:
+						value.value = aCursor.ReadU32();
+						break;
+					case DWARF::DW_FORM_data8:
+					case DWARF::DW_FORM_ref8:
+					case DWARF::DW_FORM_ref_sig8:
+					case DWARF::DW_FORM_ref_sup8:
+						value.value = aCursor.ReadU64();
+						break;
+					case DWARF::DW_FORM_data16:
+						aCursor.Skip(16);
+						break;
+					case DWARF::DW_FORM_sdata:
+						value.value = static_cast<uint64_t>(aCursor.ReadSLEB128());
+						break;
+					case DWARF::DW_FORM_udata:
+					case DWARF::DW_FORM_ref_udata:
+					case DWARF::DW_FORM_strx:
+					case DWARF::DW_FORM_addrx:
+					case DWARF::DW_FORM_loclistx:
+					case DWARF::DW_FORM_rnglistx:
+					case DWARF::DW_FORM_GNU_addr_index:
+					case DWARF::DW_FORM_GNU_str_index:
+						value.value = aCursor.ReadULEB128();
+						break;
+					case DWARF::DW_FORM_ref_addr:
+						// DWARF 2 encodes section references with the size of an address.
+						value.value = aCursor.ReadFixed(unit.version <= 2 ? unit.addressSize : unit.offsetSize);
+						break;
+					case DWARF::DW_FORM_strp:
+					case DWARF::DW_FORM_line_strp:
+					case DWARF::DW_FORM_sec_offset:
+					case DWARF::DW_FORM_strp_sup:
+					case DWARF::DW_FORM_GNU_ref_alt:
+					case DWARF::DW_FORM_GNU_strp_alt:
+						value.value = aCursor.ReadFixed(unit.offsetSize);
+						break;
+					case DWARF::DW_FORM_string:
+						value.pBlock = aCursor.GetCurrent();
+						aCursor.ReadCString();
+						break;
+					case DWARF::DW_FORM_block1:
+						value.value = aCursor.ReadU8();
+						value.pBlock = aCursor.GetCurrent();
+						aCursor.Skip(value.value);
+						break;
+					case DWARF::DW_FORM_block2:
+						value.value = aCursor.ReadU16();
+						value.pBlock = aCursor.GetCurrent();
+						aCursor.Skip(value.value);
+						break;
+					case DWARF::DW_FORM_block4:
+						value.value = aCursor.ReadU32();
+						value.pBlock = aCursor.GetCurrent();
+						aCursor.Skip(value.value);
+						break;
+					case DWARF::DW_FORM_block:
+					case DWARF::DW_FORM_exprloc:
+						value.value = aCursor.ReadULEB128();
+						value.pBlock = aCursor.GetCurrent();
+						aCursor.Skip(value.value);
+						break;
+					case DWARF::DW_FORM_flag_present:
+						value.value = 1;
+						break;
+					case DWARF::DW_FORM_implicit_const:
+						value.value = static_cast<uint64_t>(spec.implicitConst);
+						break;
+					default:
+						spdlog::error("Unsupported attribute form {:#x}.", value.form);
+						return false;
+					}
+
+					switch (spec.name)
+					{
+					case DWARF::DW_AT_name:
+						aDie.name = value;
+						aDie.present |= Die::kName;
+						break;
+					case DWARF::DW_AT_type:
+						aDie.type = ResolveReference(aState, value.form, value.value);
+						aDie.present |= Die::kType;
+						break;
+					case DWARF::DW_AT_byte_size:
+						aDie.byteSize = value.value;
+						aDie.present |= Die::kByteSize;
+						break;
+					case DWARF::DW_AT_data_member_location:
+						aDie.memberLocation = value;
+						aDie.present |= Die::kMemberLocation;
+						break;
+					case DWARF::DW_AT_data_bit_offset:
+						aDie.dataBitOffset = value.value;
+						aDie.present |= Die::kDataBitOffset;
+						break;
+					case DWARF::DW_AT_low_pc:
+						aDie.lowPc = value;
+						aDie.present |= Die::kLowPc;
+						break;
+					case DWARF::DW_AT_high_pc:
+						aDie.highPc = value;
+						aDie.present |= Die::kHighPc;
+						break;
+					case DWARF::DW_AT_count:
+						aDie.count = value.value;
+						aDie.present |= Die::kCount;
+						break;
+					case DWARF::DW_AT_upper_bound:
+						aDie.upperBound = value.value;
+						aDie.present |= Die::kUpperBound;
+						break;
+					case DWARF::DW_AT_lower_bound:
+						aDie.lowerBound = value.value;
+						aDie.present |= Die::kLowerBound;
+						break;
+					case DWARF::DW_AT_declaration:
+						if (value.value)
+							aDie.present |= Die::kDeclaration;
+						break;
+					case DWARF::DW_AT_specification:
+						aDie.specification = ResolveReference(aState, value.form, value.value);
+						aDie.present |= Die::kSpecification;
+						break;
+					case DWARF::DW_AT_abstract_origin:
+						aDie.abstractOrigin = ResolveReference(aState, value.form, value.value);
+						aDie.present |= Die::kAbstractOrigin;
+						break;
+					case DWARF::DW_AT_str_offsets_base:
+						aDie.strOffsetsBase = value.value;
+						aDie.present |= Die::kStrOffsetsBase;
+						break;
+					case DWARF::DW_AT_addr_base:
+						aDie.addrBase = value.value;
+						aDie.present |= Die::kAddrBase;
+						break;
+					default:
+						break;
+					}
+				}
+
+				return !aCursor.HasOverflowed();
+			}
+
+			std::string_view ResolveString(const UnitState& aState, const RawValue& aValue) const
+			{
+				switch (aValue.form)
+				{
+				case DWARF::DW_FORM_string:
+					return reinterpret_cast<const char*>(aValue.pBlock);
+				case DWARF::DW_FORM_strp:
+					return GetStringAt(sections.str, aValue.value);
+				case DWARF::DW_FORM_line_strp:
+					return GetStringAt(sections.lineStr, aValue.value);
+				case DWARF::DW_FORM_strx:
+				case DWARF::DW_FORM_strx1:
+				case DWARF::DW_FORM_strx2:
+				case DWARF::DW_FORM_strx3:
+				case DWARF::DW_FORM_strx4:
+				case DWARF::DW_FORM_GNU_str_index:
+				{
+					const uint8_t offsetSize = aState.pUnit->offsetSize;
+					Cursor cursor(sections.strOffsets, aState.strOffsetsBase + aValue.value * offsetSize);
+					const uint64_t stringOffset = cursor.ReadFixed(offsetSize);
+					if (cursor.HasOverflowed())
+						return {};
+					return GetStringAt(sections.str, stringOffset);
+				}
+				default:
+					return {};
+				}
+			}
+
+			uint64_t ResolveAddress(const UnitState& aState, const RawValue& aValue) const
+			{
+				switch (aValue.form)
+				{
+				case DWARF::DW_FORM_addr:
+					return aValue.value;
+				case DWARF::DW_FORM_addrx:
+				case DWARF::DW_FORM_addrx1:
+				case DWARF::DW_FORM_addrx2:
+				case DWARF::DW_FORM_addrx3:
+				case DWARF::DW_FORM_addrx4:
+				case DWARF::DW_FORM_GNU_addr_index:
+				{
+					const uint8_t addressSize = aState.pUnit->addressSize;
+					Cursor cursor(sections.addr, aState.addrBase + aValue.value * addressSize);
+					return cursor.ReadFixed(addressSize);
+				}
+				default:
+					return 0;
+				}
+			}
+
+			// Since DWARF 4, high_pc is the size of the code when it has a constant form,
+			// and the address right after the code only when it has an address form.
+			uint64_t ResolveCodeLength(const UnitState& aState, const RawValue& aHighPc, uint64_t aLowPc) const
+			{
+				switch (aHighPc.form)
+				{
+				case DWARF::DW_FORM_addr:
+				case DWARF::DW_FORM_addrx:
+				case DWARF::DW_FORM_addrx1:
+				case DWARF::DW_FORM_addrx2:
+				case DWARF::DW_FORM_addrx3:
+				case DWARF::DW_FORM_addrx4:
+				case DWARF::DW_FORM_GNU_addr_index:
+				{
+					const uint64_t highPc = ResolveAddress(aState, aHighPc);
+					return highPc > aLowPc ? highPc - aLowPc : 0;
+				}
+				default:
+					return aHighPc.pBlock ? 0 : aHighPc.value;
+				}
+			}
+
+			static uint64_t ResolveMemberLocation(const RawValue& aValue)
+			{
+				if (!aValue.pBlock)
+					return aValue.value;
+
+				// Location expressions for members are DW_OP_plus_uconst or DW_OP_constu in practice.
+				Cursor cursor(std::span<const uint8_t>(aValue.pBlock, aValue.value));
+				const uint8_t operation = cursor.ReadU8();
+				if (operation == DWARF::DW_OP_plus_uconst || operation == DWARF::DW_OP_constu)
+					return cursor.ReadULEB128();
+
+				return 0;
+			}
+
+			// Decodes a DIE elsewhere in .debug_info, used to follow specification and abstract origin links.
+			bool DecodeDieAt(uint64_t aOffset, Die& aDie, const UnitState*& apState)
+			{
+				apState = &state;
+
+				if (aOffset < state.pUnit->firstDieOffset || aOffset >= state.pUnit->end)
+				{
+					const auto it = std::upper_bound(units.begin(), units.end(), aOffset,
+						[](uint64_t aValue, const DwarfParser::Unit& aUnit) { return aValue < aUnit.offset; });
+					if (it == units.begin())
+						return false;
+
+					const DwarfParser::Unit& unit = *(it - 1);
+					if (aOffset >= unit.end)
+						return false;
+
+					if (foreignState.pUnit != &unit && !PrepareUnit(unit, foreignState))
+						return false;
+
+					apState = &foreignState;
+				}
+
+				Cursor cursor(sections.info.first(apState->pUnit->end), aOffset);
+				const Abbreviation* pAbbreviation = apState->abbreviations.Find(cursor.ReadULEB128());
+				if (!pAbbreviation)
+					return false;
+
+				return DecodeAttributes(cursor, *apState, *pAbbreviation, aOffset, aDie);
+			}
+
+			// Fills in the name and type of a DIE that only links to its declaration or abstract instance.
+			// The name is not looked up if apName is null.
+			void ResolveLinkedAttributes(const Die& aDie, std::string_view* apName, uint32_t& aTypeId)
+			{
+				Die current = aDie;
+				// Bound the number of hops in case of malformed, cyclic links.
+				for (int i = 0; i < 8; i++)
+				{
+					uint64_t link = 0;
+					if (current.Has(Die::kSpecification))
+						link = current.specification;
+					else if (current.Has(Die::kAbstractOrigin))
+						link = current.abstractOrigin;
+					else
+						return;
+
+					const UnitState* pState = nullptr;
+					Die linked{};
+					if (link == 0 || !DecodeDieAt(link, linked, pState))
+						return;
+
+					if (apName && apName->empty() && linked.Has(Die::kName))
+						*apName = ResolveString(*pState, linked.name);
+					if (aTypeId == 0 && linked.Has(Die::kType))
+						aTypeId = ToId(linked.type);
+
+					if ((!apName || !apName->empty()) && aTypeId != 0)
+						return;
+
+					current = linked;
+				}
+			}
+
+			static uint32_t ToId(uint64_t aOffset)
+			{
+				return static_cast<uint32_t>(aOffset);
+			}
+
+			Scope ProcessDie(const Die& aDie)
+			{
+				const uint16_t tag = aDie.pAbbreviation->tag;
+				const Scope* pParent = scopes.empty() ? nullptr : &scopes.back();
+
+				switch (tag)
+				{
+				case DWARF::DW_TAG_base_type:
+				case DWARF::DW_TAG_unspecified_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kBase);
+				case DWARF::DW_TAG_structure_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kStruct);
+				case DWARF::DW_TAG_class_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kClass);
+				case DWARF::DW_TAG_union_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kUnion);
+				case DWARF::DW_TAG_interface_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kInterface);
+				case DWARF::DW_TAG_enumeration_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kEnum);
+				case DWARF::DW_TAG_typedef:
+					return AddType(aDie, USYM::TypeSymbol::Type::kTypedef);
+				case DWARF::DW_TAG_array_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kArray);
+				case DWARF::DW_TAG_subroutine_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kUnknown);
+				case DWARF::DW_TAG_pointer_type:
+				case DWARF::DW_TAG_ptr_to_member_type:
+				case DWARF::DW_TAG_reference_type:
+				case DWARF::DW_TAG_rvalue_reference_type:
+					return AddType(aDie, USYM::TypeSymbol::Type::kPointer);
+				case DWARF::DW_TAG_const_type:
+				case DWARF::DW_TAG_volatile_type:
+				case DWARF::DW_TAG_restrict_type:
+				case DWARF::DW_TAG_atomic_type:
+				case DWARF::DW_TAG_immutable_type:
+					fragment.aliases.emplace_back(ToId(aDie.offset), aDie.Has(Die::kType) ? ToId(aDie.type) : 0);
+					return { Scope::Kind::kNone, tag };
+				case DWARF::DW_TAG_member:
+				case DWARF::DW_TAG_enumerator:
+					if (pParent && pParent->kind == Scope::Kind::kType)
+						AddField(aDie, pendingTypes[pParent->index]);
+					return { Scope::Kind::kNone, tag };
+				case DWARF::DW_TAG_subrange_type:
+					if (pParent && pParent->kind == Scope::Kind::kType)
+						AddSubrange(aDie, pendingTypes[pParent->index]);
+					return { Scope::Kind::kNone, tag };
+				case DWARF::DW_TAG_formal_parameter:
+					if (pParent && pParent->kind == Scope::Kind::kFunction)
+						AddParameter(aDie, pendingFunctions[pParent->index].symbol);
+					return { Scope::Kind::kNone, tag };
+				case DWARF::DW_TAG_subprogram:
+					return AddFunction(aDie);
+				default:
+					return { Scope::Kind::kNone, tag };
+				}
+			}
+
+			Scope AddType(const Die& aDie, USYM::TypeSymbol::Type aType)
+			{
+				const uint16_t tag = aDie.pAbbreviation->tag;
+
+				PendingType& pending = pendingTypes.emplace_back();
+				USYM::TypeSymbol& symbol = pending.symbol;
+				symbol.id = ToId(aDie.offset);
+				symbol.type = aType;
+
+				if (aDie.Has(Die::kName))
+					pending.name = ResolveString(state, aDie.name);
+
+				if (aDie.Has(Die::kByteSize))
+					symbol.length = aDie.byteSize;
+				else if (aType == USYM::TypeSymbol::Type::kPointer)
+					symbol.length = state.pUnit->addressSize;
+
+				const uint32_t referencedTypeId = aDie.Has(Die::kType) ? ToId(aDie.type) : 0;
+
+				using Kind = DwarfParser::SyntheticType::Kind;
+
+				// Pointers and arrays keep the type they refer to in typedefSource, just like typedefs,
+				// so the referenced type is part of their identity.
+				switch (tag)
+				{
+				case DWARF::DW_TAG_typedef:
+				case DWARF::DW_TAG_array_type:
+				case DWARF::DW_TAG_pointer_type:
+				case DWARF::DW_TAG_ptr_to_member_type:
+					symbol.typedefSource = referencedTypeId;
+					break;
+				case DWARF::DW_TAG_reference_type:
+					symbol.typedefSource = referencedTypeId;
+					fragment.syntheticTypes.push_back({ symbol.id, Kind::kReference });
+					break;
+				case DWARF::DW_TAG_rvalue_reference_type:
+					symbol.typedefSource = referencedTypeId;
+					fragment.syntheticTypes.push_back({ symbol.id, Kind::kRvalueReference });
+					break;
+				case DWARF::DW_TAG_enumeration_type:
+					pending.enumUnderlyingTypeId = referencedTypeId;
+					break;
+				default:
+					break;
+				}
+
+				if (aDie.pAbbreviation->hasChildren)
+					return { Scope::Kind::kType, tag, static_cast<uint32_t>(pendingTypes.size() - 1) };
+
+				FinishType();
+				return { Scope::Kind::kNone, tag };
+			}
+
+			void AddField(const Die& aDie, PendingType& aParent)
+			{
+				// Static data members are declarations and do not take up space in the type.
+				if (aDie.Has(Die::kDeclaration))
+					return;
+
+				USYM::FieldSymbol& field = aParent.symbol.fields.emplace_back();
+				field.id = ToId(aDie.offset);
+
+				aParent.fieldNames.push_back(aDie.Has(Die::kName) ? ResolveString(state, aDie.name) : std::string_view{});
+
+				if (aDie.pAbbreviation->tag == DWARF::DW_TAG_enumerator)
+				{
+					field.underlyingTypeId = aParent.enumUnderlyingTypeId;
+					return;
+				}
+
+				field.underlyingTypeId = aDie.Has(Die::kType) ? ToId(aDie.type) : 0;
+
+				if (aDie.Has(Die::kMemberLocation))
+					field.offset = ResolveMemberLocation(aDie.memberLocation);
+				else if (aDie.Has(Die::kDataBitOffset))
+					field.offset = aDie.dataBitOffset / 8;
+			}
+
+			void AddSubrange(const Die& aDie, PendingType& aParent)
+			{
+				uint64_t count = 0;
+				if (aDie.Has(Die::kCount))
+					count = aDie.count;
+				else if (aDie.Has(Die::kUpperBound))
+					count = aDie.upperBound + 1 - (aDie.Has(Die::kLowerBound) ? aDie.lowerBound : 0);
+
+				// Multi-dimensional arrays have one subrange per dimension.
+				aParent.elementCount = aParent.hasElementCount ? aParent.elementCount * count : count;
+				aParent.hasElementCount = true;
+			}
+
+			Scope AddFunction(const Die& aDie)
+			{
+				// Declarations (e.g. member functions inside a class) and abstract inline
+				// instances have no code; their definitions are separate DIEs.
+				if (aDie.Has(Die::kDeclaration) || !aDie.Has(Die::kLowPc))
+					return { Scope::Kind::kNone, DWARF::DW_TAG_subprogram };
+
+				PendingFunction& pending = pendingFunctions.emplace_back();
+				USYM::FunctionSymbol& symbol = pending.symbol;
+				symbol.id = ToId(aDie.offset);
+				symbol.virtualAddress = ResolveAddress(state, aDie.lowPc);
+
+				// Functions split over several ranges only have DW_AT_ranges, and keep length 0.
+				if (aDie.Has(Die::kHighPc))
+					symbol.length = ResolveCodeLength(state, aDie.highPc, symbol.virtualAddress);
+
+				pending.name = aDie.Has(Die::kName) ? ResolveString(state, aDie.name) : std::string_view{};
+				symbol.returnTypeId = aDie.Has(Die::kType) ? ToId(aDie.type) : 0;
+
+				if (pending.name.empty() || symbol.returnTypeId == 0)
+					ResolveLinkedAttributes(aDie, &pending.name, symbol.returnTypeId);
+
+				if (aDie.pAbbreviation->hasChildren)
+					return { Scope::Kind::kFunction, DWARF::DW_TAG_subprogram, static_cast<uint32_t>(pendingFunctions.size() - 1) };
+
+				FinishFunction();
+				return { Scope::Kind::kNone, DWARF::DW_TAG_subprogram };
+			}
+
+			void AddParameter(const Die& aDie, USYM::FunctionSymbol& aFunction)
+			{
+				uint32_t typeId = aDie.Has(Die::kType) ? ToId(aDie.type) : 0;
+
+				if (typeId == 0 && aDie.Has(Die::kAbstractOrigin))
+					ResolveLinkedAttributes(aDie, nullptr, typeId);
+
+				aFunction.argumentTypeIds.push_back(typeId);
+			}
+
+			// Scopes nest, so the symbol being finished is always the innermost pending one.
+			void FinishType()
+			{
+				PendingType& pending = pendingTypes.back();
+				USYM::TypeSymbol& symbol = pending.symbol;
+
+				symbol.fieldCount = symbol.fields.size();
+
+				if (symbol.type == USYM::TypeSymbol::Type::kArray)
+					fragment.syntheticTypes.push_back({ symbol.id, DwarfParser::SyntheticType::Kind::kArray, pending.elementCount });
+
+				fragment.typeSymbols.push_back(std::move(symbol));
+				fragment.typeNames.push_back(pending.name);
+				fragment.typeNames.insert(fragment.typeNames.end(), pending.fieldNames.begin(), pending.fieldNames.end());
+				pendingTypes.pop_back();
+			}
+
+			void FinishFunction()
+			{
+				PendingFunction& pending = pendingFunctions.back();
+				USYM::FunctionSymbol& symbol = pending.symbol;
+				symbol.argumentCount = static_cast<uint32_t>(symbol.argumentTypeIds.size());
+
+				fragment.functionSymbols.push_back(std::move(symbol));
+				fragment.functionNames.push_back(pending.name);
+				pendingFunctions.pop_back();
+			}
+
+			void CloseScope()
+			{
+				const Scope scope = scopes.back();
+
+				if (scope.kind == Scope::Kind::kType)
+					FinishType();
+				else if (scope.kind == Scope::Kind::kFunction)
+					FinishFunction();
+
+				scopes.pop_back();
+			}
+
+			const DwarfSections& sections;
+			const std::vector<DwarfParser::Unit>& units;
+			const std::unordered_map<uint64_t, uint64_t>& typeSignatures;
+			DwarfParser::Fragment& fragment;
+
+			UnitState state{};
+			UnitState foreignState{};
+
+			std::vector<Scope> scopes{};
+			std::vector<PendingType> pendingTypes{};
+			std::vector<PendingFunction> pendingFunctions{};
+		};
+	}
+
+	void DwarfParser::Fragment::Clear()
+	{
+		typeSymbols.clear();
+		functionSymbols.clear();
+		typeNames.clear();
+		functionNames.clear();
+		aliases.clear();
+		syntheticTypes.clear();
+	}
+
+	DwarfParser::DwarfParser(const DwarfSections& aSections)
+		: sections(aSections)
+	{}
+
+	bool DwarfParser::ReadUnits()
+	{
+		units.clear();
+		typeSignatures.clear();
+
+		if (sections.info.size() > std::numeric_limits<uint32_t>::max())
+		{
+			spdlog::error(".debug_info is larger than 4GB, DIE offsets do not fit in USYM ids.");
+			return false;
+		}
+
+		Cursor cursor(sections.info);
+
+		while (!cursor.IsAtEnd())
+		{
+			Unit& unit = units.emplace_back();
+			unit.offset = cursor.GetOffset();
+
+			uint64_t length = cursor.ReadU32();
+			unit.offsetSize = 4;
+			if (length == 0xffffffff)
+			{
+				length = cursor.ReadU64();
+				unit.offsetSize = 8;
+			}
+
+			unit.end = cursor.GetOffset() + length;
+			unit.version = cursor.ReadU16();
+
+			if (unit.version < 2 || unit.version > 5)
+			{
+				spdlog::error("Unsupported DWARF version {} in unit at offset {:#x}.", unit.version, unit.offset);
+				return false;
+			}
+
+			if (unit.version >= 5)
+			{
+				unit.unitType = cursor.ReadU8();
+				unit.addressSize = cursor.ReadU8();
+				unit.abbrevOffset = cursor.ReadFixed(unit.offsetSize);
+
+				if (unit.unitType == DWARF::DW_UT_type || unit.unitType == DWARF::DW_UT_split_type)
+				{
+					const uint64_t signature = cursor.ReadU64();
+					const uint64_t typeOffset = cursor.ReadFixed(unit.offsetSize);
+					typeSignatures[signature] = unit.offset + typeOffset;
+				}
+				else if (unit.unitType == DWARF::DW_UT_skeleton || unit.unitType == DWARF::DW_UT_split_compile)
+				{
+					cursor.ReadU64(); // dwo_id
+				}
+			}
+			else
+			{
+				unit.unitType = DWARF::DW_UT_compile;
+				unit.abbrevOffset = cursor.ReadFixed(unit.offsetSize);
+				unit.addressSize = cursor.ReadU8();
+			}
+
+			unit.firstDieOffset = cursor.GetOffset();
+
+			if (cursor.HasOverflowed() || unit.end > sections.info.size())
+			{
+				spdlog::error("Truncated unit header at .debug_info offset {:#x}.", unit.offset);
+				return false;
+			}
+
+			cursor.Seek(unit.end);
+		}
+
+		return true;
+	}
+
+	bool DwarfParser::ParseUnit(size_t aUnitIndex, Fragment& aFragment) const
+	{
+		UnitDecoder decoder(sections, units, typeSignatures, aFragment);
+		return decoder.Decode(aUnitIndex);
+	}
+
+	bool DwarfParser::Parse(USYM& aUsym, size_t aThreadCount)
+	{
+		if (!ReadUnits())
+			return false;
+
+		// Units are independent, so every unit is decoded into its own fragment.
+		// Since ids are DIE offsets, no id remapping is needed when merging them.
+		// Fragments are merged in .debug_info order as soon as the next one is done, which frees them early
+		// and keeps the result the same for every thread count. One thread at a time merges, the others go on decoding.
+		std::vector<Fragment> fragments(units.size());
+		std::vector<bool> isDone(units.size(), false);
+		size_t nextMerge = 0;
+		bool isMerging = false;
+		std::mutex mergeMutex;
+
+		ParallelFor(units.size(), [&](size_t aUnitIndex, size_t)
+		{
+			Fragment& fragment = fragments[aUnitIndex];
+			if (!ParseUnit(aUnitIndex, fragment))
+			{
+				spdlog::error("Failed to parse unit at .debug_info offset {:#x}, skipping it.", units[aUnitIndex].offset);
+				fragment.Clear();
+			}
+
+			std::unique_lock lock(mergeMutex);
+			isDone[aUnitIndex] = true;
+			if (isMerging)
+				return;
+
+			isMerging = true;
+			while (nextMerge < fragments.size() && isDone[nextMerge])
+			{
+				Fragment& next = fragments[nextMerge++];
+				lock.unlock();
+				Merge(aUsym, next);
+				lock.lock();
+			}
+			isMerging = false;
+		}, aThreadCount);
+
+		Finalize(aUsym);
+
+		return true;
+	}
+
+	void DwarfParser::Merge(USYM& aUsym, Fragment& aFragment)
+	{
+		// Equal names across units end up sharing one copy.
+		auto typeName = aFragment.typeNames.begin();
+		for (auto& symbol : aFragment.typeSymbols)
+		{
+			symbol.name = aUsym.Intern(*typeName++);
+			for (auto& field : symbol.fields)
+				field.name = aUsym.Intern(*typeName++);
+
+			aUsym.typeSymbols.emplace(symbol.id, std::move(symbol));
+		}
+
+		auto functionName = aFragment.functionNames.begin();
+		for (auto& symbol : aFragment.functionSymbols)
+		{
+			symbol.name = aUsym.Intern(*functionName++);
+			aUsym.functionSymbols.emplace(symbol.id, std::move(symbol));
+		}
+
+		aliases.insert(aliases.end(), aFragment.aliases.begin(), aFragment.aliases.end());
+		syntheticTypes.insert(syntheticTypes.end(), aFragment.syntheticTypes.begin(), aFragment.syntheticTypes.end());
+
+		aFragment = Fragment{};
+	}
+
+	namespace
+	{
+		class Finalizer
+		{
+		public:
+			Finalizer(USYM& aUsym, const std::vector<std::pair<uint32_t, uint32_t>>& aAliases, const std::vector<DwarfParser::SyntheticType>& aSyntheticTypes)
+				: usym(aUsym)
+			{
+				aliases.reserve(aAliases.size());
+				for (const auto& [from, to] : aAliases)
+					aliases[from] = to;
+
+				syntheticTypes.reserve(aSyntheticTypes.size());
+				for (const auto& syntheticType : aSyntheticTypes)
+					syntheticTypes[syntheticType.id] = syntheticType;
+			}
+
+			void Run()
+			{
+				if (!aliases.empty())
+					ResolveAliases();
+
+				for (auto& [id, symbol] : usym.typeSymbols)
+				{
+					ResolveName(id, 0);
+					ResolveLength(id, 0);
+				}
+			}
+
+		private:
+			uint32_t Resolve(uint32_t aId) const
+			{
+				// Qualifiers can be stacked (const volatile T), bound the chain in case of cycles.
+				for (int i = 0; i < 16; i++)
+				{
+					const auto it = aliases.find(aId);
+					if (it == aliases.end())
+						return aId;
+					aId = it->second;
+				}
+
+				return 0;
+			}
+
+			void ResolveAliases()
+			{
+				for (auto& [id, symbol] : usym.typeSymbols)
+				{
+					symbol.typedefSource = Resolve(symbol.typedefSource);
+					for (auto& field : symbol.fields)
+						field.underlyingTypeId = Resolve(field.underlyingTypeId);
+				}
+
+				for (auto& [id, symbol] : usym.functionSymbols)
+				{
+					symbol.returnTypeId = Resolve(symbol.returnTypeId);
+					for (auto& argumentTypeId : symbol.argumentTypeIds)
+						argumentTypeId = Resolve(argumentTypeId);
+				}
+			}
+
+			std::string_view ResolveName(uint32_t aId, int aDepth)
+			{
+				if (aId == 0)
+					return "void";
+
+				const auto it = usym.typeSymbols.find(aId);
+				if (it == usym.typeSymbols.end())
+					return "?";
+
+				USYM::TypeSymbol& symbol = it->second;
+				if (!symbol.name.empty())
+					return symbol.name;
+
+				if (aDepth > 32)
+					return "?";
+
+				using Kind = DwarfParser::SyntheticType::Kind;
+
+				const auto syntheticIt = syntheticTypes.find(aId);
+				const DwarfParser::SyntheticType* pSynthetic = syntheticIt != syntheticTypes.end() ? &syntheticIt->second : nullptr;
+
+				std::string name{};
+				switch (symbol.type)
+				{
+				case USYM::TypeSymbol::Type::kPointer:
+					name = ResolveName(symbol.typedefSource, aDepth + 1);
+					if (pSynthetic && pSynthetic->kind == Kind::kReference)
+						name += "&";
+					else if (pSynthetic && pSynthetic->kind == Kind::kRvalueReference)
+						name += "&&";
+					else
+						name += "*";
+					break;
+				case USYM::TypeSymbol::Type::kArray:
+					name = ResolveName(symbol.typedefSource, aDepth + 1);
+					name += "[" + std::to_string(pSynthetic ? pSynthetic->elementCount : 0) + "]";
+					break;
+				case USYM::TypeSymbol::Type::kUnknown:
+					name = "<function>";
+					break;
+				default:
+					break;
+				}
+
+				// The recursive calls above do not touch this symbol, so the reference is still valid.
+				symbol.name = usym.Intern(name);
+
+				return symbol.name;
+			}
+
+			uint64_t ResolveLength(uint32_t aId, int aDepth)
+			{
+				const auto it = usym.typeSymbols.find(aId);
+				if (it == usym.typeSymbols.end() || aDepth > 32)
+					return 0;
+
+				USYM::TypeSymbol& symbol = it->second;
+				if (symbol.length != 0)
+					return symbol.length;
+
+				if (symbol.type == USYM::TypeSymbol::Type::kTypedef)
+				{
+					symbol.length = ResolveLength(symbol.typedefSource, aDepth + 1);
+				}
+				else if (symbol.type == USYM::TypeSymbol::Type::kArray)
+				{
+					const auto syntheticIt = syntheticTypes.find(aId);
+					if (syntheticIt != syntheticTypes.end())
+						symbol.length = ResolveLength(symbol.typedefSource, aDepth + 1) * syntheticIt->second.elementCount;
+				}
+
+				return symbol.length;
+			}
+
+			USYM& usym;
+			std::unordered_map<uint32_t, uint32_t> aliases{};
+			std::unordered_map<uint32_t, DwarfParser::SyntheticType> syntheticTypes{};
+		};
+	}
+
+	void DwarfParser::Finalize(USYM& aUsym)
+	{
+		Finalizer finalizer(aUsym, aliases, syntheticTypes);
+		finalizer.Run();
+
+		aliases.clear();
+		syntheticTypes.clear();
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ElfInterface
+{
+	// Raw contents of the DWARF sections the parser reads from.
+	// Only .debug_info and .debug_abbrev are required.
+	struct DwarfSections
+	{
+		std::span<const uint8_t> info{};
+		std::span<const uint8_t> abbrev{};
+		std::span<const uint8_t> str{};
+		std::span<const uint8_t> lineStr{};
+		std::span<const uint8_t> strOffsets{};
+		std::span<const uint8_t> addr{};
+	};
+
+	// Converts the compile units in .debug_info to USYM type and function symbols.
+	// Type, field and function ids are the offsets of their DIEs in .debug_info,
+	// so they are unique across compile units and stable between runs.
+	class DwarfParser
+	{
+	public:
+		struct Unit
+		{
+			uint64_t offset{};
+			uint64_t end{};
+			uint64_t firstDieOffset{};
+			uint64_t abbrevOffset{};
+			uint16_t version{};
+			uint8_t unitType{};
+			uint8_t addressSize{};
+			uint8_t offsetSize{};
+		};
+
+		// Types that have no name in DWARF and are named after the type they refer to once everything is parsed.
+		struct SyntheticType
+		{
+			enum class Kind : uint8_t
+			{
+				kPointer,
+				kReference,
+				kRvalueReference,
+				kArray,
+			};
+
+			uint32_t id{};
+			Kind kind{};
+			uint64_t elementCount{};
+		};
+
+		// Symbols decoded from one or more units, in DIE order.
+		struct Fragment
+		{
+			void Clear();
+
+			// The symbols' names are not set until the fragment is merged and they are interned.
+			std::vector<USYM::TypeSymbol> typeSymbols{};
+			std::vector<USYM::FunctionSymbol> functionSymbols{};
+			// Names pointing into the DWARF sections: each type's, followed by those of its fields,
+			// and each function's, in the order of the symbols.
+			std::vector<std::string_view> typeNames{};
+			std::vector<std::string_view> functionNames{};
+			// Qualifier DIEs (const, volatile, ...) that are resolved to the type they qualify.
+			std::vector<std::pair<uint32_t, uint32_t>> aliases{};
+			std::vector<SyntheticType> syntheticTypes{};
+		};
+
+		DwarfParser(const DwarfSections& aSections);
+
+		bool ReadUnits();
+		const std::vector<Unit>& GetUnits() const { return units; }
+
+		// Parses every unit on aThreadCount threads (0 picks one per core) and finalizes the result.
+		// Units are merged in .debug_info order, so the result does not depend on the thread count.
+		bool Parse(USYM& aUsym, size_t aThreadCount = 0);
+
+		// Decodes a single unit. Safe to call concurrently for different units,
+		// as long as every thread uses its own Fragment.
+		bool ParseUnit(size_t aUnitIndex, Fragment& aFragment) const;
+
+		// Moves the symbols of a fragment into the USYM, and keeps track of what still needs to be resolved.
+		void Merge(USYM& aUsym, Fragment& aFragment);
+
+		// Resolves qualifiers, synthetic names and typedef/array lengths across all merged fragments.
+		void Finalize(USYM& aUsym);
+
+	private:
+		DwarfSections sections{};
+		std::vector<Unit> units{};
+		// Type signature (DW_FORM_ref_sig8) to the offset of the type DIE in its type unit.
+		std::unordered_map<uint64_t, uint64_t> typeSignatures{};
+
+		std::vector<std::pair<uint32_t, uint32_t>> aliases{};
+		std::vector<SyntheticType> syntheticTypes{};
+	};
+}
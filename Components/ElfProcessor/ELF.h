@@ -28,6 +28,21 @@ namespace ELF
     ELFCLASS64 = 2  // 64-bit object file
   };
 
+  enum {
+    ELFDATANONE = 0,
+    ELFDATA2LSB = 1, // Little endian
+    ELFDATA2MSB = 2  // Big endian
+  };
+
+  // Machine architectures (subset).
+  enum {
+    EM_NONE = 0,
+    EM_386 = 3,      // Intel 80386
+    EM_ARM = 40,     // ARM
+    EM_X86_64 = 62,  // AMD x86-64
+    EM_AARCH64 = 183 // ARM AArch64
+  };
+
   struct Elf32_Ehdr
   {
     unsigned char e_ident[EI_NIDENT]; // ELF Identification bytes
@@ -116,6 +131,70 @@ namespace ELF
     uint64_t sh_entsize;
   };
 
+  // Section types (subset).
+  enum : uint32_t {
+    SHT_NULL = 0,      // No associated section (inactive entry)
+    SHT_PROGBITS = 1,  // Program-defined contents
+    SHT_SYMTAB = 2,    // Symbol table
+    SHT_STRTAB = 3,    // String table
+    SHT_HASH = 5,      // Symbol hash table
+    SHT_DYNAMIC = 6,   // Information for dynamic linking
+    SHT_NOTE = 7,      // Notes
+    SHT_NOBITS = 8,    // Occupies no space in the file (.bss)
+    SHT_DYNSYM = 11,   // Symbol table for dynamic linking
+    SHT_GNU_HASH = 0x6ffffff6 // GNU style symbol hash table
+  };
+
+  // Section flags (subset).
+  enum : uint64_t {
+    SHF_WRITE = 0x1,         // Writable during execution
+    SHF_ALLOC = 0x2,         // Occupies memory during execution
+    SHF_EXECINSTR = 0x4,     // Executable machine instructions
+    SHF_COMPRESSED = 0x800   // Contents start with an Elf*_Chdr and are compressed
+  };
+
+  // Header of a SHF_COMPRESSED section.
+  struct Elf32_Chdr
+  {
+    uint32_t ch_type;      // Compression algorithm (ELFCOMPRESS_*)
+    uint32_t ch_size;      // Size of the uncompressed contents
+    uint32_t ch_addralign; // Alignment of the uncompressed contents
+  };
+
+  struct Elf64_Chdr
+  {
+    uint32_t ch_type;
+    uint32_t ch_reserved;
+    uint64_t ch_size;
+    uint64_t ch_addralign;
+  };
+
+  // Compression algorithms.
+  enum : uint32_t {
+    ELFCOMPRESS_ZLIB = 1, // zlib stream
+    ELFCOMPRESS_ZSTD = 2  // Zstandard frame
+  };
+
+  // Header of an entry in a SHT_NOTE section, the same for both classes. The name and
+  // the descriptor follow, each padded to 4 bytes.
+  struct Elf_Nhdr
+  {
+    uint32_t n_namesz; // Size of the name, including the terminator
+    uint32_t n_descsz; // Size of the descriptor
+    uint32_t n_type;   // Note type, its meaning depends on the name
+  };
+
+  // Note types of the "GNU" name (subset).
+  enum : uint32_t {
+    NT_GNU_BUILD_ID = 3 // Unique id of the build, shared with its separate debug file
+  };
+
+  // Special section indices.
+  enum : uint16_t {
+    SHN_UNDEF = 0,        // Undefined, missing, irrelevant, or meaningless
+    SHN_LORESERVE = 0xff00 // Lowest reserved index
+  };
+
   // Symbol bindings.
   enum {
     STB_LOCAL = 0,  // Local symbol, not visible outside obj file containing def
@@ -0,0 +1,706 @@
+#include "ElfEx.h"
+
+#include <Crc32.h>
+#include <Inflate.h>
+#include <ParallelFor.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+
+namespace ElfInterface
+{
+	namespace
+	{
+		uint32_t Load32(std::span<const uint8_t> aData, size_t aOffset)
+		{
+			uint32_t value = 0;
+			std::memcpy(&value, aData.data() + aOffset, sizeof(value));
+			return value;
+		}
+
+		// The NUL terminated string at aOffset, or an empty one if it is not terminated within the table.
+		std::string_view GetString(std::span<const uint8_t> aStrings, size_t aOffset)
+		{
+			if (aOffset >= aStrings.size())
+				return {};
+
+			const char* pString = reinterpret_cast<const char*>(aStrings.data() + aOffset);
+			const void* pTerminator = std::memchr(pString, '\0', aStrings.size() - aOffset);
+			if (!pTerminator)
+				return {};
+
+			return { pString, static_cast<size_t>(static_cast<const char*>(pTerminator) - pString) };
+		}
+
+		uint64_t LoadWord(std::span<const uint8_t> aData, size_t aOffset, bool aIs64Bit)
+		{
+			if (!aIs64Bit)
+				return Load32(aData, aOffset);
+
+			uint64_t value = 0;
+			std::memcpy(&value, aData.data() + aOffset, sizeof(value));
+			return value;
+		}
+
+		// Deflate cannot compress better than this, a larger size in a header is corrupt.
+		constexpr size_t kMaxInflateRatio = 1032;
+
+		constexpr size_t AlignNote(size_t aSize)
+		{
+			return (aSize + 3) & ~size_t(3);
+		}
+	}
+
+	bool ElfEx::Parse(const char* apFileName)
+	{
+		// Only the headers and tables that are looked at get paged in.
+		if (!reader.MapFromFile(apFileName, MappedFile::AccessHint::kRandom))
+			return false;
+
+		if (reader.size < ELF::EI_NIDENT || std::memcmp(reader.GetData(), "\x7f" "ELF", 4) != 0)
+		{
+			spdlog::error("{} is not an ELF file.", apFileName);
+			return false;
+		}
+
+		fileName = apFileName;
+		debugFile.reset();
+
+		ReadFileClass(reader);
+		ReadElfProgramHeader(reader);
+
+		sections.clear();
+		symbols.clear();
+		dynamicSymbols.clear();
+		gnuHash = {};
+		sysvHash = {};
+		decompressedSections.clear();
+		decompressedArena.clear();
+		pendingParts = kSections | kSymbols | kDynamicSymbols;
+
+		return true;
+	}
+
+	const std::vector<Elf_ShdrEx>& ElfEx::GetSections() const
+	{
+		if (pendingParts & kSections)
+		{
+			pendingParts &= ~kSections;
+			ReadSectionHeaders(reader);
+			ReadSectionNames();
+			decompressedSections.assign(sections.size(), std::nullopt);
+		}
+
+		return sections;
+	}
+
+	const std::vector<Elf_SymEx>& ElfEx::GetSymbols() const
+	{
+		if (pendingParts & kSymbols)
+		{
+			pendingParts &= ~kSymbols;
+			if (const Elf_ShdrEx* pSymtab = FindSectionByType(ELF::SHT_SYMTAB))
+				ReadSymbols(reader, *pSymtab, symbols);
+		}
+
+		return symbols;
+	}
+
+	const std::vector<Elf_SymEx>& ElfEx::GetDynamicSymbols() const
+	{
+		if (pendingParts & kDynamicSymbols)
+		{
+			pendingParts &= ~kDynamicSymbols;
+			ReadDynamicSymbols();
+		}
+
+		return dynamicSymbols;
+	}
+
+	const Elf_ShdrEx* ElfEx::FindSection(std::string_view aName) const
+	{
+		for (const auto& section : GetSections())
+		{
+			if (section.name == aName)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	const Elf_ShdrEx* ElfEx::FindSectionByType(uint32_t aType) const
+	{
+		for (const auto& section : GetSections())
+		{
+			if (section.sh_type == aType)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	std::span<const uint8_t> ElfEx::GetSectionData(std::string_view aName)
+	{
+		ElfEx& file = FindContentFile(aName);
+		if (&file != this)
+			return file.GetSectionData(aName);
+
+		const Elf_ShdrEx* pSection = FindContentSection(aName);
+		if (!pSection)
+			return {};
+
+		if (!pSection->IsCompressed())
+			return GetRawSectionData(*pSection);
+
+		const size_t index = pSection - sections.data();
+		if (index >= decompressedSections.size() || !decompressedSections[index])
+		{
+			const std::string_view names[] = { pSection->name };
+			DecompressSections(names, 1);
+		}
+
+		return *decompressedSections[index];
+	}
+
+	std::span<const uint8_t> ElfEx::GetRawSectionData(const Elf_ShdrEx& aSection) const
+	{
+		if (aSection.sh_type == ELF::SHT_NOBITS)
+			return {};
+
+		if (aSection.sh_offset > reader.size || aSection.sh_size > reader.size - aSection.sh_offset)
+		{
+			spdlog::error("Section {} lies outside of the file.", aSection.name);
+			return {};
+		}
+
+		return { reader.GetData() + aSection.sh_offset, aSection.sh_size };
+	}
+
+	void ElfEx::DecompressSections(std::span<const std::string_view> aNames, size_t aThreadCount)
+	{
+		struct Job
+		{
+			size_t index;
+			std::span<const uint8_t> stream;
+			size_t size;
+			size_t offset;
+		};
+
+		// Sections filled in by hand did not go through GetSections, which sizes this.
+		if (decompressedSections.size() < sections.size())
+			decompressedSections.resize(sections.size());
+
+		std::vector<Job> jobs{};
+		size_t totalSize = 0;
+		for (const auto name : aNames)
+		{
+			const Elf_ShdrEx* pSection = FindContentSection(name);
+			if (!pSection || !pSection->IsCompressed())
+				continue;
+
+			const size_t index = pSection - sections.data();
+			if (decompressedSections[index] || std::any_of(jobs.begin(), jobs.end(), [index](const Job& aJob) { return aJob.index == index; }))
+				continue;
+
+			Job job{ index, {}, 0, 0 };
+			if (!ReadCompressionHeader(*pSection, job.stream, job.size))
+			{
+				decompressedSections[index] = std::span<const uint8_t>{};
+				continue;
+			}
+
+			job.offset = totalSize;
+			totalSize += job.size;
+			jobs.push_back(job);
+		}
+
+		if (debugFile)
+			debugFile->DecompressSections(aNames, aThreadCount);
+
+		if (jobs.empty())
+			return;
+
+		// All of them share one buffer, which does not need to be cleared as every byte gets written.
+		auto pBuffer = std::make_unique_for_overwrite<uint8_t[]>(totalSize);
+		uint8_t* pData = pBuffer.get();
+		decompressedArena.push_back(std::move(pBuffer));
+
+		// Largest first, so a large section does not start last and keep a single thread busy at the end.
+		std::sort(jobs.begin(), jobs.end(), [](const Job& aLeft, const Job& aRight) { return aLeft.size > aRight.size; });
+
+		std::vector<uint8_t> results(jobs.size());
+		ParallelFor(jobs.size(), [&](size_t aIndex, size_t)
+		{
+			const Job& job = jobs[aIndex];
+			results[aIndex] = Inflate::DecompressZlib(job.stream.data(), job.stream.size(), pData + job.offset, job.size);
+		}, aThreadCount);
+
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			const Job& job = jobs[i];
+			if (results[i])
+			{
+				decompressedSections[job.index] = std::span<const uint8_t>{ pData + job.offset, job.size };
+			}
+			else
+			{
+				spdlog::error("Failed to decompress section {}.", sections[job.index].name);
+				decompressedSections[job.index] = std::span<const uint8_t>{};
+			}
+		}
+	}
+
+	ElfEx& ElfEx::FindContentFile(std::string_view aName)
+	{
+		if (!debugFile)
+			return *this;
+
+		const Elf_ShdrEx* pSection = FindContentSection(aName);
+		if (pSection && pSection->sh_type != ELF::SHT_NOBITS)
+			return *this;
+
+		return *debugFile;
+	}
+
+	// A note is a Elf_Nhdr, the name and the descriptor. The build id is the descriptor of the
+	// NT_GNU_BUILD_ID note named "GNU", usually in .note.gnu.build-id.
+	std::span<const uint8_t> ElfEx::GetBuildId() const
+	{
+		for (const auto& section : GetSections())
+		{
+			if (section.sh_type != ELF::SHT_NOTE)
+				continue;
+
+			const std::span<const uint8_t> notes = GetRawSectionData(section);
+			for (size_t offset = 0; offset + sizeof(ELF::Elf_Nhdr) <= notes.size();)
+			{
+				ELF::Elf_Nhdr header{};
+				std::memcpy(&header, notes.data() + offset, sizeof(header));
+
+				const size_t nameOffset = offset + sizeof(header);
+				const size_t descriptorOffset = nameOffset + AlignNote(header.n_namesz);
+				if (header.n_namesz > notes.size() || header.n_descsz > notes.size() || descriptorOffset + header.n_descsz > notes.size())
+					break;
+
+				if (header.n_type == ELF::NT_GNU_BUILD_ID && header.n_namesz == 4 && std::memcmp(notes.data() + nameOffset, "GNU", 4) == 0)
+					return notes.subspan(descriptorOffset, header.n_descsz);
+
+				offset = descriptorOffset + AlignNote(header.n_descsz);
+			}
+		}
+
+		return {};
+	}
+
+	// .gnu_debuglink holds the NUL terminated file name, padded to 4 bytes, then the CRC-32 of the whole debug file.
+	bool ElfEx::GetDebugLink(std::string_view& aFileName, uint32_t& aCrc) const
+	{
+		const Elf_ShdrEx* pSection = FindSection(".gnu_debuglink");
+		if (!pSection)
+			return false;
+
+		const std::span<const uint8_t> data = GetRawSectionData(*pSection);
+		aFileName = GetString(data, 0);
+		const size_t crcOffset = AlignNote(aFileName.size() + 1);
+		if (aFileName.empty() || crcOffset + sizeof(uint32_t) > data.size())
+			return false;
+
+		aCrc = Load32(data, crcOffset);
+		return true;
+	}
+
+	bool ElfEx::LoadDebugFile(std::span<const std::string> aDirectories)
+	{
+		debugFile.reset();
+
+		const std::span<const uint8_t> buildId = GetBuildId();
+		if (buildId.size() >= 2)
+		{
+			static constexpr char kHexDigits[] = "0123456789abcdef";
+			std::string hex{};
+			for (const uint8_t byte : buildId)
+			{
+				hex.push_back(kHexDigits[byte >> 4]);
+				hex.push_back(kHexDigits[byte & 0xF]);
+			}
+
+			const std::string relativePath = ".build-id/" + hex.substr(0, 2) + "/" + hex.substr(2) + ".debug";
+			for (const auto& directory : aDirectories)
+			{
+				if (TryDebugFile((std::filesystem::path(directory) / relativePath).string(), std::nullopt))
+					return true;
+			}
+		}
+
+		std::string_view linkName{};
+		uint32_t crc = 0;
+		if (!GetDebugLink(linkName, crc))
+			return false;
+
+		const std::filesystem::path directory = std::filesystem::absolute(fileName).parent_path();
+		std::vector<std::filesystem::path> candidates{ directory / linkName, directory / ".debug" / linkName };
+		for (const auto& debugDirectory : aDirectories)
+		{
+			candidates.push_back(std::filesystem::path(debugDirectory) / directory.relative_path() / linkName);
+			candidates.push_back(std::filesystem::path(debugDirectory) / linkName);
+		}
+
+		for (const auto& candidate : candidates)
+		{
+			if (TryDebugFile(candidate.string(), crc))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool ElfEx::TryDebugFile(const std::string& aFileName, std::optional<uint32_t> aCrc)
+	{
+		std::error_code error{};
+		if (!std::filesystem::is_regular_file(aFileName, error) || std::filesystem::equivalent(aFileName, fileName, error))
+			return false;
+
+		auto pDebugFile = std::make_unique<ElfEx>();
+		if (!pDebugFile->Parse(aFileName.c_str()))
+			return false;
+
+		const std::span<const uint8_t> buildId = GetBuildId();
+		const std::span<const uint8_t> debugBuildId = pDebugFile->GetBuildId();
+		if (!buildId.empty() && !debugBuildId.empty())
+		{
+			if (!std::equal(buildId.begin(), buildId.end(), debugBuildId.begin(), debugBuildId.end()))
+			{
+				spdlog::warn("Skipping {}, its build id does not match {}.", aFileName, fileName);
+				return false;
+			}
+		}
+		else if (aCrc)
+		{
+			// Reads the whole file, so it is only done when there is no build id to compare.
+			pDebugFile->reader.Advise(MappedFile::AccessHint::kSequential);
+			if (Crc32(pDebugFile->reader.GetData(), pDebugFile->reader.size) != *aCrc)
+			{
+				spdlog::warn("Skipping {}, its CRC does not match the .gnu_debuglink of {}.", aFileName, fileName);
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		spdlog::info("Using separate debug file {} for {}.", aFileName, fileName);
+		debugFile = std::move(pDebugFile);
+		return true;
+	}
+
+	USYM::Architecture ElfEx::GetArchitecture() const
+	{
+		switch (elfHeader.e_machine)
+		{
+		case ELF::EM_386:
+			return USYM::Architecture::kX86;
+		case ELF::EM_X86_64:
+			return USYM::Architecture::kX86_64;
+		case ELF::EM_ARM:
+			return USYM::Architecture::kArm32;
+		case ELF::EM_AARCH64:
+			return USYM::Architecture::kArm64;
+		default:
+			return USYM::Architecture::kUnknown;
+		}
+	}
+
+	const Elf_SymEx* ElfEx::FindDynamicSymbol(std::string_view aName) const
+	{
+		GetDynamicSymbols();
+
+		if (!gnuHash.empty())
+			return FindGnuHashSymbol(aName);
+
+		if (!sysvHash.empty())
+			return FindSysvHashSymbol(aName);
+
+		return nullptr;
+	}
+
+	uint32_t ElfEx::GnuHash(std::string_view aName)
+	{
+		uint32_t hash = 5381;
+		for (const char c : aName)
+			hash = hash * 33 + static_cast<uint8_t>(c);
+
+		return hash;
+	}
+
+	uint32_t ElfEx::SysvHash(std::string_view aName)
+	{
+		uint32_t hash = 0;
+		for (const char c : aName)
+		{
+			hash = (hash << 4) + static_cast<uint8_t>(c);
+			const uint32_t high = hash & 0xF0000000;
+			if (high != 0)
+				hash ^= high >> 24;
+			hash &= ~high;
+		}
+
+		return hash;
+	}
+
+	const Elf_ShdrEx* ElfEx::FindContentSection(std::string_view aName) const
+	{
+		if (const Elf_ShdrEx* pSection = FindSection(aName))
+			return pSection;
+
+		constexpr std::string_view kDebugPrefix = ".debug_";
+		if (!aName.starts_with(kDebugPrefix))
+			return nullptr;
+
+		const std::string_view suffix = aName.substr(kDebugPrefix.size());
+		for (const auto& section : GetSections())
+		{
+			if (section.name.starts_with(".zdebug_") && section.name.substr(8) == suffix)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	// SHF_COMPRESSED sections start with an Elf32_Chdr or Elf64_Chdr, .zdebug_* ones with "ZLIB"
+	// and the decompressed size as a 64 bit big endian number. The zlib stream follows either.
+	bool ElfEx::ReadCompressionHeader(const Elf_ShdrEx& aSection, std::span<const uint8_t>& aStream, size_t& aSize) const
+	{
+		const std::span<const uint8_t> data = GetRawSectionData(aSection);
+
+		uint32_t type = 0;
+		uint64_t size = 0;
+		size_t headerSize = 0;
+		if ((aSection.sh_flags & ELF::SHF_COMPRESSED) != 0)
+		{
+			if (is64Bit && data.size() >= sizeof(ELF::Elf64_Chdr))
+			{
+				ELF::Elf64_Chdr header{};
+				std::memcpy(&header, data.data(), sizeof(header));
+				type = header.ch_type;
+				size = header.ch_size;
+				headerSize = sizeof(header);
+			}
+			else if (!is64Bit && data.size() >= sizeof(ELF::Elf32_Chdr))
+			{
+				ELF::Elf32_Chdr header{};
+				std::memcpy(&header, data.data(), sizeof(header));
+				type = header.ch_type;
+				size = header.ch_size;
+				headerSize = sizeof(header);
+			}
+		}
+		else if (data.size() >= 12 && std::memcmp(data.data(), "ZLIB", 4) == 0)
+		{
+			type = ELF::ELFCOMPRESS_ZLIB;
+			for (size_t i = 4; i < 12; i++)
+				size = size << 8 | data[i];
+			headerSize = 12;
+		}
+
+		if (headerSize == 0)
+		{
+			spdlog::error("Section {} has no valid compression header.", aSection.name);
+			return false;
+		}
+
+		if (type != ELF::ELFCOMPRESS_ZLIB)
+		{
+			spdlog::error("Section {} uses unsupported compression type {}.", aSection.name, type);
+			return false;
+		}
+
+		aStream = data.subspan(headerSize);
+		if (size > aStream.size() * kMaxInflateRatio)
+		{
+			spdlog::error("Section {} claims an impossible decompressed size of {} bytes.", aSection.name, size);
+			return false;
+		}
+
+		aSize = static_cast<size_t>(size);
+		return true;
+	}
+
+	// Layout: bucket count, first hashed symbol, bloom filter word count and shift,
+	// then the bloom filter words, the buckets and a hash per hashed symbol.
+	// A chain is a run of symbols whose bucket is the same, the last one has the low bit of its hash set.
+	const Elf_SymEx* ElfEx::FindGnuHashSymbol(std::string_view aName) const
+	{
+		if (gnuHash.size() < 4 * sizeof(uint32_t))
+			return nullptr;
+
+		const uint32_t bucketCount = Load32(gnuHash, 0);
+		const uint32_t symbolOffset = Load32(gnuHash, 4);
+		const uint32_t bloomCount = Load32(gnuHash, 8);
+		const uint32_t bloomShift = Load32(gnuHash, 12);
+
+		const size_t wordSize = is64Bit ? sizeof(uint64_t) : sizeof(uint32_t);
+		const size_t wordBits = wordSize * 8;
+		const size_t bloomOffset = 4 * sizeof(uint32_t);
+		const size_t bucketsOffset = bloomOffset + static_cast<size_t>(bloomCount) * wordSize;
+		const size_t chainsOffset = bucketsOffset + static_cast<size_t>(bucketCount) * sizeof(uint32_t);
+		if (bucketCount == 0 || bloomCount == 0 || chainsOffset > gnuHash.size())
+			return nullptr;
+
+		const uint32_t hash = GnuHash(aName);
+
+		// The bloom filter rules out most names that are not there, with two bits per symbol.
+		const uint64_t bloomWord = LoadWord(gnuHash, bloomOffset + (hash / wordBits) % bloomCount * wordSize, is64Bit);
+		const uint64_t mask = (uint64_t(1) << (hash % wordBits)) | (uint64_t(1) << ((hash >> bloomShift) % wordBits));
+		if ((bloomWord & mask) != mask)
+			return nullptr;
+
+		uint32_t index = Load32(gnuHash, bucketsOffset + (hash % bucketCount) * sizeof(uint32_t));
+		if (index < symbolOffset)
+			return nullptr;
+
+		for (; index < dynamicSymbols.size(); index++)
+		{
+			const size_t chainOffset = chainsOffset + static_cast<size_t>(index - symbolOffset) * sizeof(uint32_t);
+			if (chainOffset + sizeof(uint32_t) > gnuHash.size())
+				return nullptr;
+
+			// The hashed symbols can still include imports, which the dynamic linker skips as well.
+			const uint32_t chainHash = Load32(gnuHash, chainOffset);
+			const Elf_SymEx& symbol = dynamicSymbols[index];
+			if ((chainHash | 1) == (hash | 1) && symbol.IsDefined() && symbol.name == aName)
+				return &symbol;
+
+			if (chainHash & 1)
+				break;
+		}
+
+		return nullptr;
+	}
+
+	// Layout: bucket count, chain count, the buckets, then the chains, which link each symbol
+	// to the next one in the same bucket. Symbol 0 ends a chain.
+	const Elf_SymEx* ElfEx::FindSysvHashSymbol(std::string_view aName) const
+	{
+		if (sysvHash.size() < 2 * sizeof(uint32_t))
+			return nullptr;
+
+		const uint32_t bucketCount = Load32(sysvHash, 0);
+		const uint32_t chainCount = Load32(sysvHash, 4);
+		const size_t bucketsOffset = 2 * sizeof(uint32_t);
+		const size_t chainsOffset = bucketsOffset + static_cast<size_t>(bucketCount) * sizeof(uint32_t);
+		if (bucketCount == 0 || chainsOffset + static_cast<size_t>(chainCount) * sizeof(uint32_t) > sysvHash.size())
+			return nullptr;
+
+		uint32_t index = Load32(sysvHash, bucketsOffset + (SysvHash(aName) % bucketCount) * sizeof(uint32_t));
+
+		// A corrupt table could link the chain into a loop, no chain is longer than the symbols.
+		for (uint32_t steps = 0; index != 0 && index < chainCount && index < dynamicSymbols.size() && steps < chainCount; steps++)
+		{
+			const Elf_SymEx& symbol = dynamicSymbols[index];
+			if (symbol.IsDefined() && symbol.name == aName)
+				return &symbol;
+
+			index = Load32(sysvHash, chainsOffset + static_cast<size_t>(index) * sizeof(uint32_t));
+		}
+
+		return nullptr;
+	}
+
+	void ElfEx::ReadFileClass(Reader& aReader)
+	{
+		aReader.position = 4;
+
+		uint8_t fileClass = 0;
+		aReader.Read(fileClass);
+
+		uint8_t dataEncoding = 0;
+		aReader.Read(dataEncoding);
+		aReader.Reset();
+
+		is64Bit = fileClass == ELF::ELFCLASS64;
+		isLittleEndian = dataEncoding == ELF::ELFDATA2LSB;
+	}
+
+	void ElfEx::ReadElfProgramHeader(Reader& aReader)
+	{
+		elfHeader.Parse(aReader, is64Bit);
+
+		// TODO: this set position probably shouldn't be necessary,
+		// since the program header should come right after the ELF header
+		aReader.position = elfHeader.e_phoff;
+		programHeader.Parse(aReader, is64Bit);
+	}
+
+	void ElfEx::ReadSectionHeaders(Reader& aReader) const
+	{
+		sections.clear();
+
+		aReader.position = elfHeader.e_shoff;
+		sections.reserve(elfHeader.e_shnum);
+
+		for (size_t i = 0; i < elfHeader.e_shnum; i++)
+		{
+			// TODO: advance the reader one section entry? since the first one is null.
+			// also, reserve - 1. same for symbols. skip by e_shentsize
+			auto& section = sections.emplace_back();
+			section.Parse(aReader, is64Bit);
+		}
+	}
+
+	void ElfEx::ReadSectionNames() const
+	{
+		if (elfHeader.e_shstrndx == 0 || elfHeader.e_shstrndx >= sections.size())
+			return;
+
+		const std::span<const uint8_t> names = GetRawSectionData(sections[elfHeader.e_shstrndx]);
+		for (auto& section : sections)
+			section.name = GetString(names, section.sh_name);
+	}
+
+	void ElfEx::ReadSymbols(Reader& aReader, const Elf_ShdrEx& aSection, std::vector<Elf_SymEx>& aSymbols) const
+	{
+		const std::span<const uint8_t> data = GetRawSectionData(aSection);
+		const size_t typeSize = is64Bit ? sizeof(ELF::Elf64_Sym) : sizeof(ELF::Elf32_Sym);
+		const size_t count = data.size() / typeSize;
+		if (count == 0)
+			return;
+
+		aReader.position = aSection.sh_offset;
+
+		// TODO: skip first symbol entry, which is null (ala sections)?
+		aSymbols.resize(count);
+		for (auto& symbol : aSymbols)
+			symbol.Parse(aReader, is64Bit);
+
+		if (aSection.sh_link >= sections.size())
+			return;
+
+		const std::span<const uint8_t> strings = GetRawSectionData(sections[aSection.sh_link]);
+		for (auto& symbol : aSymbols)
+			symbol.name = GetString(strings, symbol.st_name);
+	}
+
+	void ElfEx::ReadDynamicSymbols() const
+	{
+		const Elf_ShdrEx* pDynsym = FindSectionByType(ELF::SHT_DYNSYM);
+		if (!pDynsym)
+			return;
+
+		ReadSymbols(reader, *pDynsym, dynamicSymbols);
+
+		// Both tables hash the symbols of the .dynsym they link to.
+		for (const auto& section : sections)
+		{
+			if (section.sh_link != static_cast<uint32_t>(pDynsym - sections.data()))
+				continue;
+
+			if (section.sh_type == ELF::SHT_GNU_HASH)
+				gnuHash = GetRawSectionData(section);
+			else if (section.sh_type == ELF::SHT_HASH)
+				sysvHash = GetRawSectionData(section);
+		}
+	}
+}
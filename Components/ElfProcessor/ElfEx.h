@@ -0,0 +1,279 @@
+#pragma once
+
+#include "ELF.h"
+
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include <Reader.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ElfInterface
+{
+	struct Elf_EhdrEx : public ELF::Elf64_Ehdr
+	{
+		void Parse(Reader& aReader, bool aIs64Bit)
+		{
+			if (aIs64Bit)
+				Convert<ELF::Elf64_Ehdr>(aReader);
+			else
+				Convert<ELF::Elf32_Ehdr>(aReader);
+		}
+
+	private:
+		template <class T>
+		void Convert(Reader& aReader)
+		{
+			T elfHeader{};
+			aReader.Read(elfHeader);
+
+			e_type = elfHeader.e_type;
+			e_machine = elfHeader.e_machine;
+			e_version = elfHeader.e_version;
+			e_entry = elfHeader.e_entry;
+			e_phoff = elfHeader.e_phoff;
+			e_shoff = elfHeader.e_shoff;
+			e_flags = elfHeader.e_flags;
+			e_ehsize = elfHeader.e_ehsize;
+			e_phentsize = elfHeader.e_phentsize;
+			e_phnum = elfHeader.e_phnum;
+			e_shentsize = elfHeader.e_shentsize;
+			e_shnum = elfHeader.e_shnum;
+			e_shstrndx = elfHeader.e_shstrndx;
+		}
+	};
+
+	struct Elf_PhdrEx : public ELF::Elf64_Phdr
+	{
+		void Parse(Reader& aReader, bool aIs64Bit)
+		{
+			if (aIs64Bit)
+				Convert<ELF::Elf64_Phdr>(aReader);
+			else
+				Convert<ELF::Elf32_Phdr>(aReader);
+		}
+
+	private:
+		template <class T>
+		void Convert(Reader& aReader)
+		{
+			T programHeader{};
+			aReader.Read(programHeader);
+
+			p_type = programHeader.p_type;
+			p_offset = programHeader.p_offset;
+			p_vaddr = programHeader.p_vaddr;
+			p_paddr = programHeader.p_paddr;
+			p_filesz = programHeader.p_filesz;
+			p_memsz = programHeader.p_memsz;
+			p_flags = programHeader.p_flags;
+			p_align = programHeader.p_align;
+		}
+	};
+
+	struct Elf_ShdrEx : public ELF::Elf64_Shdr
+	{
+		void Parse(Reader& aReader, bool aIs64Bit)
+		{
+			if (aIs64Bit)
+				Convert<ELF::Elf64_Shdr>(aReader);
+			else
+				Convert<ELF::Elf32_Shdr>(aReader);
+		}
+
+	private:
+		template <class T>
+		void Convert(Reader& aReader)
+		{
+			T sectionHeader{};
+			aReader.Read(sectionHeader);
+			
+			sh_name = sectionHeader.sh_name;
+			sh_type = sectionHeader.sh_type;
+			sh_flags = sectionHeader.sh_flags;
+			sh_addr = sectionHeader.sh_addr;
+			sh_offset = sectionHeader.sh_offset;
+			sh_size = sectionHeader.sh_size;
+			sh_link = sectionHeader.sh_link;
+			sh_info = sectionHeader.sh_info;
+			sh_addralign = sectionHeader.sh_addralign;
+			sh_entsize = sectionHeader.sh_entsize;
+		}
+
+	public:
+		// SHF_COMPRESSED, or named .zdebug_*, how compressed DWARF was marked before there was a flag for it.
+		bool IsCompressed() const
+		{
+			return (sh_flags & ELF::SHF_COMPRESSED) != 0 || name.starts_with(".zdebug_");
+		}
+
+		// Points into the mapped .shstrtab, valid as long as the ElfEx that read it.
+		std::string_view name{};
+	};
+
+	struct Elf_SymEx : public ELF::Elf64_Sym
+	{
+		void Parse(Reader& aReader, bool aIs64Bit)
+		{
+			if (aIs64Bit)
+				Convert<ELF::Elf64_Sym>(aReader);
+			else
+				Convert<ELF::Elf32_Sym>(aReader);
+		}
+
+		bool IsFunctionSymbol() const
+		{
+			return getType() == ELF::STT_FUNC;
+		}
+
+		// Undefined symbols are imports from other files, they have no address here.
+		bool IsDefined() const
+		{
+			return st_shndx != ELF::SHN_UNDEF;
+		}
+
+		bool IsTypeSymbol() const
+		{
+			// TODO: this isn't good, check what type enum is used for user defined types.
+			return getType() != ELF::STT_FUNC;
+		}
+		
+	private:
+		template <class T>
+		void Convert(Reader& aReader)
+		{
+			T symbol{};
+			aReader.Read(symbol);
+
+			st_name = symbol.st_name;
+			st_info = symbol.st_info;
+			st_other = symbol.st_other;
+			st_shndx = symbol.st_shndx;
+			st_value = symbol.st_value;
+			st_size = symbol.st_size;
+		}
+
+	public:
+		// Points into the mapped string table, valid as long as the ElfEx that read it.
+		std::string_view name{};
+	};
+
+	// An ELF file mapped into memory. Parse only reads the ELF and program headers; the section
+	// headers, symbol tables and string tables are read on first use and kept until the next
+	// Parse, and section contents are not read at all unless a caller touches them. This keeps
+	// looking at the architecture, the build id or a single section of a large file cheap.
+	// Loading on first use is not synchronized, so one ElfEx must not be used from several
+	// threads at once.
+	struct ElfEx
+	{
+		bool Parse(const char* apFileName);
+
+		const std::vector<Elf_ShdrEx>& GetSections() const;
+		// .symtab, which stripped files do not have.
+		const std::vector<Elf_SymEx>& GetSymbols() const;
+		// .dynsym, the symbols the file exports and imports.
+		const std::vector<Elf_SymEx>& GetDynamicSymbols() const;
+
+		const Elf_ShdrEx* FindSection(std::string_view aName) const;
+		// First section of the type, e.g. SHT_DYNSYM, which unlike names survives stripping.
+		const Elf_ShdrEx* FindSectionByType(uint32_t aType) const;
+		// FindSection, falling back to .zdebug_* for a .debug_* name.
+		const Elf_ShdrEx* FindContentSection(std::string_view aName) const;
+
+		// Contents of a section. Compressed sections are decompressed on first use and kept until
+		// the next Parse, a .debug_* name also finds the section as .zdebug_*. Anything else points
+		// straight into the mapped file.
+		std::span<const uint8_t> GetSectionData(std::string_view aName);
+		// Contents as stored in the file, compressed or not.
+		std::span<const uint8_t> GetRawSectionData(const Elf_ShdrEx& aSection) const;
+
+		// Decompresses the sections of the list that are compressed, each on its own thread, so
+		// GetSectionData can return them right away. Sections that are not compressed, missing
+		// or decompressed already are skipped.
+		void DecompressSections(std::span<const std::string_view> aNames, size_t aThreadCount = 0);
+
+		// The file holding the contents of a section: this one, or the separate debug file if the
+		// section is missing here or was stripped to SHT_NOBITS.
+		ElfEx& FindContentFile(std::string_view aName);
+
+		// Descriptor of the NT_GNU_BUILD_ID note, empty if there is none.
+		std::span<const uint8_t> GetBuildId() const;
+		// File name and CRC-32 of the separate debug file from .gnu_debuglink. Returns false if there is none.
+		bool GetDebugLink(std::string_view& aFileName, uint32_t& aCrc) const;
+
+		// Looks for the separate debug file of a stripped file, the way gdb does: by build id as
+		// .build-id/xx/yyyy.debug under each of aDirectories, then by its .gnu_debuglink name next to
+		// this file, in .debug next to it, and in each of aDirectories with and without this file's
+		// directory appended. The first file whose build id, or else CRC, matches becomes debugFile.
+		bool LoadDebugFile(std::span<const std::string> aDirectories);
+
+		USYM::Architecture GetArchitecture() const;
+
+		// Looks up a symbol defined in .dynsym with the file's own .gnu.hash, or .hash if
+		// there is none, so nothing has to be indexed first. Returns nullptr if there is no
+		// such symbol, or no hash table.
+		const Elf_SymEx* FindDynamicSymbol(std::string_view aName) const;
+
+		static uint32_t GnuHash(std::string_view aName);
+		static uint32_t SysvHash(std::string_view aName);
+
+	private:
+		void ReadFileClass(Reader& aReader);
+		void ReadElfProgramHeader(Reader& aReader);
+		void ReadSectionHeaders(Reader& aReader) const;
+		void ReadSectionNames() const;
+		// Reads the symbols of a SHT_SYMTAB or SHT_DYNSYM section, with names from its linked string table.
+		void ReadSymbols(Reader& aReader, const Elf_ShdrEx& aSection, std::vector<Elf_SymEx>& aSymbols) const;
+		// .dynsym and the hash tables that link to it.
+		void ReadDynamicSymbols() const;
+
+		// Where the compressed stream of the section starts and how large it is decompressed.
+		bool ReadCompressionHeader(const Elf_ShdrEx& aSection, std::span<const uint8_t>& aStream, size_t& aSize) const;
+		// Parses aFileName as the debug file of this one if it is one, checking aCrc unless both files have a build id.
+		bool TryDebugFile(const std::string& aFileName, std::optional<uint32_t> aCrc);
+
+		const Elf_SymEx* FindGnuHashSymbol(std::string_view aName) const;
+		const Elf_SymEx* FindSysvHashSymbol(std::string_view aName) const;
+
+	public:
+		std::string fileName{};
+		// Kept alive so section contents can be referenced without copying them. Its position is
+		// scratch state for reading tables, which happens on first use in const getters too.
+		mutable Reader reader{};
+		bool is64Bit{};
+		bool isLittleEndian{};
+		Elf_EhdrEx elfHeader{};
+		Elf_PhdrEx programHeader{};
+		// Read on first use, through GetSections, GetSymbols and GetDynamicSymbols.
+		mutable std::vector<Elf_ShdrEx> sections{};
+		mutable std::vector<Elf_SymEx> symbols{};
+		mutable std::vector<Elf_SymEx> dynamicSymbols{};
+		// The hash tables of .dynsym, read with it, either can be missing.
+		mutable std::span<const uint8_t> gnuHash{};
+		mutable std::span<const uint8_t> sysvHash{};
+		// Decompressed contents by section index: none if not attempted, empty if decompression failed.
+		mutable std::vector<std::optional<std::span<const uint8_t>>> decompressedSections{};
+		// Owns the decompressed contents, one allocation per DecompressSections call.
+		std::vector<std::unique_ptr<uint8_t[]>> decompressedArena{};
+		// Separate debug file found by LoadDebugFile, mapped on its own.
+		std::unique_ptr<ElfEx> debugFile{};
+
+	private:
+		enum Part : uint8_t
+		{
+			kSections = 1 << 0,
+			kSymbols = 1 << 1,
+			kDynamicSymbols = 1 << 2,
+		};
+
+		// Parts that are not read yet. Parse sets them all; an ElfEx that was never parsed
+		// has nothing to read, so its members can be filled in by hand.
+		mutable uint8_t pendingParts{};
+	};
+}
@@ -1,298 +1,159 @@
 #include "ElfInterface.h"
 
-#include "ELF.h"
+#include "ElfEx.h"
+#include "DwarfParser.h"
 
+#include <algorithm>
 #include <spdlog/spdlog.h>
+#include <span>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <Reader.h>
 
 namespace ElfInterface
 {
-	struct Elf_EhdrEx : public ELF::Elf64_Ehdr
+	namespace
 	{
-		void Parse(Reader& aReader, bool aIs64Bit)
+		// .symtab, from the separate debug file if strip removed it from this one.
+		const std::vector<Elf_SymEx>& GetSymbolTable(const ElfEx& aElf)
 		{
-			if (aIs64Bit)
-				Convert<ELF::Elf64_Ehdr>(aReader);
-			else
-				Convert<ELF::Elf32_Ehdr>(aReader);
-		}
-
-	private:
-		template <class T>
-		void Convert(Reader& aReader)
-		{
-			T elfHeader{};
-			aReader.Read(elfHeader);
+			if (aElf.GetSymbols().empty() && aElf.debugFile)
+				return aElf.debugFile->GetSymbols();
 
-			e_type = elfHeader.e_type;
-			e_machine = elfHeader.e_machine;
-			e_version = elfHeader.e_version;
-			e_entry = elfHeader.e_entry;
-			e_phoff = elfHeader.e_phoff;
-			e_shoff = elfHeader.e_shoff;
-			e_flags = elfHeader.e_flags;
-			e_ehsize = elfHeader.e_ehsize;
-			e_phentsize = elfHeader.e_phentsize;
-			e_phnum = elfHeader.e_phnum;
-			e_shentsize = elfHeader.e_shentsize;
-			e_shnum = elfHeader.e_shnum;
-			e_shstrndx = elfHeader.e_shstrndx;
+			return aElf.GetSymbols();
 		}
-	};
 
-	struct Elf_PhdrEx : public ELF::Elf64_Phdr
-	{
-		void Parse(Reader& aReader, bool aIs64Bit)
+		// Functions that DWARF describes with DW_AT_ranges instead of high_pc have no length,
+		// but their symbol in .symtab usually has a size. The symbol table is only read if needed.
+		void FillMissingFunctionLengths(USYM& aUsym, const ElfEx& aElf)
 		{
-			if (aIs64Bit)
-				Convert<ELF::Elf64_Phdr>(aReader);
-			else
-				Convert<ELF::Elf32_Phdr>(aReader);
-		}
+			const bool isLengthMissing = std::any_of(aUsym.functionSymbols.begin(), aUsym.functionSymbols.end(), [](const auto& aEntry) {
+				return aEntry.second.length == 0;
+			});
 
-	private:
-		template <class T>
-		void Convert(Reader& aReader)
-		{
-			T programHeader{};
-			aReader.Read(programHeader);
+			if (!isLengthMissing)
+				return;
 
-			p_type = programHeader.p_type;
-			p_offset = programHeader.p_offset;
-			p_vaddr = programHeader.p_vaddr;
-			p_paddr = programHeader.p_paddr;
-			p_filesz = programHeader.p_filesz;
-			p_memsz = programHeader.p_memsz;
-			p_flags = programHeader.p_flags;
-			p_align = programHeader.p_align;
-		}
-	};
+			std::unordered_map<uint64_t, uint64_t> sizes{};
+			for (const auto& symbol : GetSymbolTable(aElf))
+			{
+				if (symbol.IsFunctionSymbol() && symbol.st_value != 0 && symbol.st_size != 0)
+					sizes.emplace(symbol.st_value, symbol.st_size);
+			}
 
-	struct Elf_ShdrEx : public ELF::Elf64_Shdr
-	{
-		void Parse(Reader& aReader, bool aIs64Bit)
-		{
-			if (aIs64Bit)
-				Convert<ELF::Elf64_Shdr>(aReader);
-			else
-				Convert<ELF::Elf32_Shdr>(aReader);
-		}
+			for (auto& [id, function] : aUsym.functionSymbols)
+			{
+				if (function.length != 0)
+					continue;
 
-	private:
-		template <class T>
-		void Convert(Reader& aReader)
-		{
-			T sectionHeader{};
-			aReader.Read(sectionHeader);
-			
-			sh_name = sectionHeader.sh_name;
-			sh_type = sectionHeader.sh_type;
-			sh_flags = sectionHeader.sh_flags;
-			sh_addr = sectionHeader.sh_addr;
-			sh_offset = sectionHeader.sh_offset;
-			sh_size = sectionHeader.sh_size;
-			sh_link = sectionHeader.sh_link;
-			sh_info = sectionHeader.sh_info;
-			sh_addralign = sectionHeader.sh_addralign;
-			sh_entsize = sectionHeader.sh_entsize;
+				const auto it = sizes.find(function.virtualAddress);
+				if (it != sizes.end())
+					function.length = it->second;
+			}
 		}
 
-	public:
-		std::string name{};
-	};
-
-	struct Elf_SymEx : public ELF::Elf64_Sym
-	{
-		void Parse(Reader& aReader, bool aIs64Bit)
+		// Files without DWARF still name their functions in .symtab, or in .dynsym once stripped.
+		// That gives names, addresses and lengths, enough to symbolize, but no types.
+		void AddFunctionsFromSymbols(USYM& aUsym, const std::vector<Elf_SymEx>& aSymbols)
 		{
-			if (aIs64Bit)
-				Convert<ELF::Elf64_Sym>(aReader);
-			else
-				Convert<ELF::Elf32_Sym>(aReader);
-		}
+			std::vector<const Elf_SymEx*> functions{};
+			for (const auto& symbol : aSymbols)
+			{
+				if (symbol.IsFunctionSymbol() && symbol.IsDefined() && symbol.st_value != 0 && !symbol.name.empty())
+					functions.push_back(&symbol);
+			}
 
-		bool IsFunctionSymbol() const
-		{
-			return getType() == ELF::STT_FUNC;
-		}
+			// Aliases share an address, only the first one is kept.
+			std::stable_sort(functions.begin(), functions.end(), [](const Elf_SymEx* apLeft, const Elf_SymEx* apRight) {
+				return apLeft->st_value < apRight->st_value;
+			});
+			functions.erase(std::unique(functions.begin(), functions.end(), [](const Elf_SymEx* apLeft, const Elf_SymEx* apRight) {
+				return apLeft->st_value == apRight->st_value;
+			}), functions.end());
 
-		bool IsTypeSymbol() const
-		{
-			// TODO: this isn't good, check what type enum is used for user defined types.
-			return getType() != ELF::STT_FUNC;
-		}
-		
-	private:
-		template <class T>
-		void Convert(Reader& aReader)
-		{
-			T symbol{};
-			aReader.Read(symbol);
+			aUsym.functionSymbols.reserve(aUsym.functionSymbols.size() + functions.size());
 
-			st_name = symbol.st_name;
-			st_info = symbol.st_info;
-			st_other = symbol.st_other;
-			st_shndx = symbol.st_shndx;
-			st_value = symbol.st_value;
-			st_size = symbol.st_size;
+			// There are no DIE offsets to use as ids, so functions are numbered by address.
+			uint32_t id = 1;
+			for (const Elf_SymEx* pSymbol : functions)
+			{
+				USYM::FunctionSymbol function{};
+				function.id = id++;
+				function.name = aUsym.Intern(pSymbol->name);
+				function.virtualAddress = pSymbol->st_value;
+				function.length = pSymbol->st_size;
+				function.callingConvention = USYM::CallingConvention::kUnknown;
+				aUsym.functionSymbols.emplace(function.id, std::move(function));
+			}
 		}
+	}
 
-	public:
-		std::string name{};
-	};
-
-	struct ElfEx
+	std::optional<USYM> CreateUsymFromFile(const char* apFileName, size_t aThreadCount, std::span<const std::string> aDebugDirectories)
 	{
-		bool Parse(const char* apFileName)
-		{
-			Reader reader{};
-			if (!reader.LoadFromFile(apFileName))
-				return false;
-
-			ReadFileClass(reader);
-			ReadElfProgramHeader(reader);
-			ReadSectionHeaders(reader);
-			ReadSymbols(reader);
+		USYM usym{};
 
-			return true;
-		}
+		// Everything read from the file lives in here, and only for this call, which is what
+		// lets conversions run on several threads at once.
+		ElfEx elf{};
+		if (!elf.Parse(apFileName))
+			return std::nullopt;
 
-	private:
-		void ReadFileClass(Reader& aReader)
+		if (!elf.isLittleEndian)
 		{
-			aReader.position = 4;
-
-			uint8_t fileClass = 0;
-			aReader.Read(fileClass);
-			aReader.Reset();
-			
-			is64Bit = fileClass == ELF::ELFCLASS64;
+			spdlog::error("Big endian ELF files are not supported.");
+			return std::nullopt;
 		}
 
-		void ReadElfProgramHeader(Reader& aReader)
-		{
-			elfHeader.Parse(aReader, is64Bit);
+		usym.header.originalFormat = USYM::OriginalFormat::kDwarf;
+		usym.header.architecture = elf.GetArchitecture();
 
-			// TODO: this set position probably shouldn't be necessary,
-			// since the program header should come right after the ELF header
-			aReader.position = elfHeader.e_phoff;
-			programHeader.Parse(aReader, is64Bit);
-		}
+		// Stripped files keep their DWARF, and .symtab, in a separate debug file.
+		const Elf_ShdrEx* pOwnInfo = elf.FindContentSection(".debug_info");
+		if (!pOwnInfo || pOwnInfo->sh_type == ELF::SHT_NOBITS)
+			elf.LoadDebugFile(aDebugDirectories);
 
-		void ReadSectionHeaders(Reader& aReader)
-		{
-			sections.clear();
+		// Compressed sections are all inflated up front, side by side.
+		constexpr std::string_view kDwarfSectionNames[] = { ".debug_info", ".debug_abbrev", ".debug_str", ".debug_line_str", ".debug_str_offsets", ".debug_addr" };
+		elf.DecompressSections(kDwarfSectionNames, aThreadCount);
 
-			aReader.position = elfHeader.e_shoff;
-			sections.reserve(elfHeader.e_shnum);
-			
-			for (size_t i = 0; i < elfHeader.e_shnum; i++)
-			{
-				// TODO: advance the reader one section entry? since the first one is null.
-				// also, reserve - 1. same for symbols. skip by e_shentsize
-				auto& section = sections.emplace_back();
-				section.Parse(aReader, is64Bit);
-			}
-		}
+		DwarfSections dwarfSections{};
+		dwarfSections.info = elf.GetSectionData(".debug_info");
+		dwarfSections.abbrev = elf.GetSectionData(".debug_abbrev");
+		dwarfSections.str = elf.GetSectionData(".debug_str");
+		dwarfSections.lineStr = elf.GetSectionData(".debug_line_str");
+		dwarfSections.strOffsets = elf.GetSectionData(".debug_str_offsets");
+		dwarfSections.addr = elf.GetSectionData(".debug_addr");
 
-		void ReadSymbols(Reader& aReader)
+		if (dwarfSections.info.empty() || dwarfSections.abbrev.empty())
 		{
-			symbols.clear();
-
-			size_t symtabOffset = 0;
-			size_t symtabSize = 0;
-
-			for (auto& section : sections)
-			{
-				section.name = GetSectionName(aReader, section);
-				if (section.name == ".symtab")
-				{
-					symtabOffset = section.sh_offset;
-					symtabSize = section.sh_size;
-				}
-			}
-
-			if (symtabSize == 0)
-				return;
-			
-			aReader.position = symtabOffset;
-			size_t typeSize = is64Bit ? sizeof(ELF::Elf64_Sym) : sizeof(ELF::Elf32_Sym);
-			const size_t count = symtabSize / typeSize;
-
-			// TODO: skip first symbol entry, which is null (ala sections)?
-			symbols.reserve(count);
-			for (size_t i = 0; i < count; i++)
-			{
-				ELF::Elf64_Sym& symbol = symbols.emplace_back();
-				aReader.Read(symbol);
-			}
-
-			for (const auto& section : sections)
-			{
-				if (section.name == ".strtab")
-				{
-					for (auto& symbol : symbols)
-					{
-						if (symbol.st_name != 0)
-						{
-							aReader.position = section.sh_offset + symbol.st_name;
-							symbol.name = aReader.ReadString();
-						}
-					}
-
-					break;
-				}
-			}
+			spdlog::warn("No DWARF debug information found in {}, only taking functions from the symbol table.", apFileName);
+			const std::vector<Elf_SymEx>& symbols = GetSymbolTable(elf);
+			AddFunctionsFromSymbols(usym, symbols.empty() ? elf.GetDynamicSymbols() : symbols);
+			return usym;
 		}
 
-		std::string GetSectionName(Reader& aReader, const Elf_ShdrEx& aSection)
-		{
-			if (elfHeader.e_shstrndx == 0)
-				return "";
-
-			const auto& stringSection = sections[elfHeader.e_shstrndx];
-
-			size_t oldPosition = aReader.position;
-			aReader.position = stringSection.sh_offset + aSection.sh_name;
-			
-			std::string name = aReader.ReadString();
-			
-			aReader.position = oldPosition;
+		// The DIEs are decoded front to back; a decompressed .debug_info is not part of the mapping.
+		ElfEx& infoFile = elf.FindContentFile(".debug_info");
+		if (const Elf_ShdrEx* pInfo = infoFile.FindContentSection(".debug_info"); pInfo && !pInfo->IsCompressed())
+			infoFile.reader.Advise(MappedFile::AccessHint::kSequential, dwarfSections.info.data() - infoFile.reader.GetData(), dwarfSections.info.size());
 
-			return name;
-		}
+		DwarfParser parser(dwarfSections);
+		if (!parser.Parse(usym, aThreadCount))
+			return std::nullopt;
 
-	public:
-		bool is64Bit;
-		Elf_EhdrEx elfHeader{};
-		Elf_PhdrEx programHeader{};
-		std::vector<Elf_ShdrEx> sections{};
-		std::vector<Elf_SymEx> symbols{};
-	};
+		FillMissingFunctionLengths(usym, elf);
 
-	static ElfEx s_elf{};
+		return usym;
+	}
 
-	std::optional<USYM> CreateUsymFromFile(const char* apFileName)
+	std::vector<BatchTiming> CreateUsymsFromFiles(std::span<const std::string> aFileNames, const BatchCallback& aCallback, const BatchOptions& aOptions, std::span<const std::string> aDebugDirectories)
 	{
-		USYM usym{};
-
-		if (!s_elf.Parse(apFileName))
-			return std::nullopt;
-
-		for (const auto& symbol : s_elf.symbols)
+		// The files are the unit of work, each is converted on the single thread that took it.
+		const std::vector<uint64_t> sizes = GetFileSizes(aFileNames);
+		return RunBatch(sizes, [&](size_t aIndex, size_t)
 		{
-			spdlog::info("{}", symbol.name);
-			if (symbol.IsTypeSymbol())
-			{
-				// TODO: do type processing
-			}
-			else if (symbol.IsFunctionSymbol())
-			{
-				// TODO: do function processing
-			}
-		}
-
-		return usym;
+			std::optional<USYM> usym = CreateUsymFromFile(aFileNames[aIndex].c_str(), 1, aDebugDirectories);
+			return aCallback(aIndex, usym);
+		}, aOptions);
 	}
 }
@@ -2,9 +2,28 @@
 
 #include <UniversalSymbolsFormat/USYM.h>
 
+#include <BatchScheduler.h>
+
+#include <functional>
 #include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace ElfInterface
 {
-	std::optional<USYM> CreateUsymFromFile(const char* apFileName);
+	// Compile units are converted on aThreadCount threads; 0 uses one thread per core.
+	// The DWARF of a stripped file is read from its separate debug file, found by build id or
+	// .gnu_debuglink next to the file and in aDebugDirectories, e.g. /usr/lib/debug.
+	// Keeps no state between calls, so files can be converted on several threads at once.
+	std::optional<USYM> CreateUsymFromFile(const char* apFileName, size_t aThreadCount = 0, std::span<const std::string> aDebugDirectories = {});
+
+	// Receives the result of each file of a batch by its index in the batch, on the thread that
+	// converted it, as soon as it is done. The USYM can be moved out of it. Returns whether the
+	// file was handled, e.g. written.
+	using BatchCallback = std::function<bool(size_t aIndex, std::optional<USYM>& aUsym)>;
+
+	// Converts aFileNames with RunBatch, largest first, one file per thread at a time, and returns
+	// the timing of each. Results are not kept, aCallback decides what to write and when to free them.
+	std::vector<BatchTiming> CreateUsymsFromFiles(std::span<const std::string> aFileNames, const BatchCallback& aCallback, const BatchOptions& aOptions = {}, std::span<const std::string> aDebugDirectories = {});
 }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// Maps code addresses to the functions in a SymbolTable that contain them.
+//
+// The start addresses are kept in Eytzinger order: an implicit binary search tree stored
+// breadth first, so the top levels of every search share the same few cache lines and each
+// further level touches at most one new one, where a binary search over a sorted array
+// jumps across the whole array. Function ranges are assumed not to overlap, like code does.
+// Like NameIndex, the index is built by the first lookup and rebuilt after the table changed.
+class AddressIndex
+{
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  AddressIndex() = default;
+  // An index belongs to one table, so a moved index starts out empty.
+  AddressIndex(AddressIndex&&) noexcept {}
+  AddressIndex& operator=(AddressIndex&&) noexcept
+  {
+    Invalidate();
+    return *this;
+  }
+
+  // Writes the position in aTable of the function containing each of aAddresses to
+  // aPositions, or npos. Functions without an address are left out, and functions
+  // without a length only contain their first address.
+  template <class T>
+  void Find(const SymbolTable<T>& aTable, std::span<const uint64_t> aAddresses, std::span<uint32_t> aPositions)
+  {
+    std::scoped_lock lock(mutex);
+
+    if (pTable != &aTable || version != aTable.GetVersion())
+      Build(aTable);
+
+    for (size_t i = 0; i < aAddresses.size(); i++)
+      aPositions[i] = Find(aAddresses[i]);
+  }
+
+  void Invalidate()
+  {
+    std::scoped_lock lock(mutex);
+    pTable = nullptr;
+  }
+
+private:
+  struct Range
+  {
+    uint64_t start{};
+    uint64_t end{};
+    uint32_t position{};
+  };
+
+  template <class T>
+  void Build(const SymbolTable<T>& aTable)
+  {
+    ranges.clear();
+    ranges.reserve(aTable.size());
+
+    uint32_t position = 0;
+    for (const auto& [id, symbol] : aTable)
+    {
+      if (symbol.virtualAddress != 0)
+        ranges.push_back({ symbol.virtualAddress, symbol.virtualAddress + std::max<uint64_t>(symbol.length, 1), position });
+
+      position++;
+    }
+
+    // Of functions that start at the same address, the search ends on the last one,
+    // so ordering those by descending position makes it find the first in the table.
+    std::sort(ranges.begin(), ranges.end(), [](const Range& aLeft, const Range& aRight) {
+      return aLeft.start != aRight.start ? aLeft.start < aRight.start : aLeft.position > aRight.position;
+    });
+
+    // Node 0 is unused, so the children of node k are 2k and 2k + 1.
+    starts.assign(ranges.size() + 1, 0);
+    ranks.assign(ranges.size() + 1, 0);
+
+    uint32_t rank = 0;
+    Fill(1, rank);
+
+    pTable = &aTable;
+    version = aTable.GetVersion();
+  }
+
+  // An in-order walk of the tree visits the nodes in sorted order.
+  void Fill(size_t aNode, uint32_t& aRank)
+  {
+    if (aNode >= starts.size())
+      return;
+
+    Fill(2 * aNode, aRank);
+    starts[aNode] = ranges[aRank].start;
+    ranks[aNode] = aRank++;
+    Fill(2 * aNode + 1, aRank);
+  }
+
+  uint32_t Find(uint64_t aAddress) const
+  {
+    const size_t count = ranges.size();
+
+    // Descend to a leaf, going right while the start is at or below the address.
+    size_t node = 1;
+    while (node <= count)
+      node = 2 * node + (starts[node] <= aAddress);
+
+    // The path is in the bits of node, 1 for every step to the right. Dropping the trailing
+    // steps to the right and the last step to the left gives the first start above the address.
+    node >>= std::countr_one(node) + 1;
+
+    const size_t above = node == 0 ? count : ranks[node];
+    if (above == 0)
+      return npos;
+
+    const Range& range = ranges[above - 1];
+    return aAddress < range.end ? range.position : npos;
+  }
+
+  std::mutex mutex{};
+  const void* pTable = nullptr;
+  uint64_t version = 0;
+  // Sorted by start address.
+  std::vector<Range> ranges{};
+  // Start address and rank in ranges of every tree node.
+  std::vector<uint64_t> starts{};
+  std::vector<uint32_t> ranks{};
+};
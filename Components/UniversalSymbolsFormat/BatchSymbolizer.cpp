@@ -0,0 +1,121 @@
+#include "BatchSymbolizer.h"
+#include "Serializers/IndexedBinaryDeserializer.h"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+bool BatchSymbolizer::AddFile(const std::string& aFileName)
+{
+  File file{};
+  file.fileName = aFileName;
+
+  std::vector<Function> functions{};
+
+  // Both binary formats use the .usym extension, the magic tells them apart.
+  if (IndexedBinaryDeserializer::IsIndexedBinaryFile(aFileName))
+  {
+    if (!file.view.Open(aFileName))
+      return false;
+
+    functions.reserve(file.view.GetFunctions().size());
+    for (const auto& record : file.view.GetFunctions())
+    {
+      if (record.virtualAddress != 0)
+        functions.push_back({ record.virtualAddress, record.virtualAddress + std::max<uint64_t>(file.view.GetLength(record), 1), file.view.GetString(record.name) });
+    }
+  }
+  else
+  {
+    file.pUsym = std::make_unique<USYM>();
+    if (file.pUsym->Deserialize(aFileName.c_str()) != IDeserializer::DeserializeResult::kOk)
+    {
+      spdlog::error("Failed to load {}.", aFileName);
+      return false;
+    }
+
+    functions.reserve(file.pUsym->functionSymbols.size());
+    for (const auto& [id, symbol] : file.pUsym->functionSymbols)
+    {
+      if (symbol.virtualAddress != 0)
+        functions.push_back({ symbol.virtualAddress, symbol.virtualAddress + std::max<uint64_t>(symbol.length, 1), symbol.name });
+    }
+  }
+
+  SetFunctions(file, functions);
+  files.push_back(std::move(file));
+
+  return true;
+}
+
+void BatchSymbolizer::SetFunctions(File& aFile, std::vector<Function>& aFunctions)
+{
+  // Like USYM::Symbolize, the first of functions that start at the same address wins.
+  std::stable_sort(aFunctions.begin(), aFunctions.end(), [](const Function& aLeft, const Function& aRight) {
+    return aLeft.start < aRight.start;
+  });
+  aFunctions.erase(std::unique(aFunctions.begin(), aFunctions.end(), [](const Function& aLeft, const Function& aRight) {
+    return aLeft.start == aRight.start;
+  }), aFunctions.end());
+
+  aFile.starts.reserve(aFunctions.size());
+  aFile.ends.reserve(aFunctions.size());
+  aFile.names.reserve(aFunctions.size());
+  for (const Function& function : aFunctions)
+  {
+    aFile.starts.push_back(function.start);
+    aFile.ends.push_back(function.end);
+    aFile.names.push_back(function.name);
+  }
+}
+
+void BatchSymbolizer::Symbolize(std::span<const uint64_t> aAddresses, std::span<Result> aResults)
+{
+  std::fill(aResults.begin(), aResults.begin() + aAddresses.size(), Result{});
+
+  // Sorting the addresses along with their indices keeps the comparisons in cache.
+  order.resize(aAddresses.size());
+  for (uint32_t i = 0; i < order.size(); i++)
+    order[i] = { aAddresses[i], i };
+
+  std::sort(order.begin(), order.end());
+
+  for (uint32_t i = 0; i < files.size() && !order.empty(); i++)
+  {
+    Sweep(i, aResults);
+
+    // Later files only get the addresses that are still unresolved, in the same order.
+    order.erase(std::remove_if(order.begin(), order.end(), [aResults](const std::pair<uint64_t, uint32_t>& aEntry) {
+      return aResults[aEntry.second].IsResolved();
+    }), order.end());
+  }
+}
+
+void BatchSymbolizer::Sweep(uint32_t aFileIndex, std::span<Result> aResults)
+{
+  const File& file = files[aFileIndex];
+  const size_t count = file.starts.size();
+
+  // The first function that starts above the previous address. Addresses only go up,
+  // so the search for the next one starts here, and gallops to cover large gaps quickly.
+  size_t next = 0;
+  for (const auto& [address, index] : order)
+  {
+    size_t low = next;
+    size_t high = next;
+    for (size_t step = 1; high < count && file.starts[high] <= address; step *= 2)
+    {
+      low = high + 1;
+      high += step;
+    }
+
+    next = std::upper_bound(file.starts.begin() + low, file.starts.begin() + std::min(high, count), address) - file.starts.begin();
+    if (next == 0 || address >= file.ends[next - 1])
+      continue;
+
+    Result& result = aResults[index];
+    result.name = file.names[next - 1];
+    result.offset = address - file.starts[next - 1];
+    result.fileIndex = aFileIndex;
+  }
+}
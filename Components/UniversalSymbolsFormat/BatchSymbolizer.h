@@ -0,0 +1,70 @@
+#pragma once
+
+#include "USYM.h"
+#include "UsymView.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Resolves large batches of addresses to functions in one or more .usym files.
+//
+// Indexed files are mapped through UsymView, version 1 files are loaded into a USYM.
+// The functions of every file are sorted by address once, when the file is added.
+// Each batch is sorted as well and swept against them, so consecutive addresses,
+// like the samples of a profile, share the searches instead of each doing its own.
+// Files are searched in the order they were added; the first that contains an address wins.
+class BatchSymbolizer
+{
+public:
+  static constexpr uint32_t kNoFile = UINT32_MAX;
+
+  struct Result
+  {
+    // Points into the file's symbols, valid while the symbolizer lives.
+    std::string_view name{};
+    uint64_t offset{};
+    uint32_t fileIndex = kNoFile;
+
+    bool IsResolved() const { return fileIndex != kNoFile; }
+  };
+
+  bool AddFile(const std::string& aFileName);
+
+  size_t GetFileCount() const { return files.size(); }
+  const std::string& GetFileName(uint32_t aFileIndex) const { return files[aFileIndex].fileName; }
+
+  // Writes the function containing each of aAddresses to aResults, which must be as large.
+  void Symbolize(std::span<const uint64_t> aAddresses, std::span<Result> aResults);
+
+private:
+  struct File
+  {
+    std::string fileName{};
+    UsymView view{};
+    std::unique_ptr<USYM> pUsym{};
+    // Sorted function start addresses, and the end and name of each function.
+    std::vector<uint64_t> starts{};
+    std::vector<uint64_t> ends{};
+    std::vector<std::string_view> names{};
+  };
+
+  struct Function
+  {
+    uint64_t start{};
+    uint64_t end{};
+    std::string_view name{};
+  };
+
+  // Sorts aFunctions, in table order, into aFile.
+  static void SetFunctions(File& aFile, std::vector<Function>& aFunctions);
+  void Sweep(uint32_t aFileIndex, std::span<Result> aResults);
+
+  std::vector<File> files{};
+  // Addresses of the current batch and their indices, sorted. Kept to reuse the allocation.
+  std::vector<std::pair<uint64_t, uint32_t>> order{};
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "StringPool.h"
+#include "SymbolTable.h"
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Positions of the symbols in a SymbolTable, by interned name.
+//
+// The index is built by the first lookup, and rebuilt by the first lookup after symbols
+// were added to or removed from the table, which SymbolTable::GetVersion() tells.
+// Renaming a symbol in place does not change the version; call Invalidate() after doing so.
+// All symbols that share a name, like overloads, are found, in table order.
+class NameIndex
+{
+public:
+  NameIndex() = default;
+  // An index belongs to one table, so a moved index starts out empty.
+  NameIndex(NameIndex&&) noexcept {}
+  NameIndex& operator=(NameIndex&&) noexcept
+  {
+    Invalidate();
+    return *this;
+  }
+
+  // Returns the positions in aTable of the symbols named aName, which has to be interned
+  // in the same pool as the symbol names. Valid until the table or the index changes.
+  template <class T>
+  std::span<const uint32_t> Find(const SymbolTable<T>& aTable, InternedName aName)
+  {
+    std::scoped_lock lock(mutex);
+
+    if (pTable != &aTable || version != aTable.GetVersion())
+      Build(aTable);
+
+    const auto it = ranges.find(aName.data());
+    if (it == ranges.end())
+      return {};
+
+    return { positions.data() + it->second.first, it->second.second };
+  }
+
+  void Invalidate()
+  {
+    std::scoped_lock lock(mutex);
+    pTable = nullptr;
+  }
+
+private:
+  template <class T>
+  void Build(const SymbolTable<T>& aTable)
+  {
+    ranges.clear();
+    ranges.reserve(aTable.size());
+
+    // Count the symbols per name first, so the positions of every name can be stored together.
+    for (const auto& [id, symbol] : aTable)
+    {
+      if (!symbol.name.empty())
+        ranges[symbol.name.data()].second++;
+    }
+
+    uint32_t first = 0;
+    for (auto& [name, range] : ranges)
+    {
+      range.first = first;
+      first += range.second;
+      range.second = 0;
+    }
+
+    positions.resize(first);
+
+    uint32_t position = 0;
+    for (const auto& [id, symbol] : aTable)
+    {
+      if (!symbol.name.empty())
+      {
+        auto& range = ranges.find(symbol.name.data())->second;
+        positions[range.first + range.second++] = position;
+      }
+
+      position++;
+    }
+
+    pTable = &aTable;
+    version = aTable.GetVersion();
+  }
+
+  std::mutex mutex{};
+  const void* pTable = nullptr;
+  uint64_t version = 0;
+  // Interned names are equal only if they share their storage, so the characters' address is the key.
+  // The value is the first position of the name in positions, and its symbol count.
+  std::unordered_map<const char*, std::pair<uint32_t, uint32_t>> ranges{};
+  std::vector<uint32_t> positions{};
+};
@@ -0,0 +1,391 @@
+#include "BinaryDeserializer.h"
+#include "BlockCompressedReader.h"
+#include "CompactEncoding.h"
+
+#include "../USYM.h"
+
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// Smallest encoded size of each record, which is with an empty name and no fields or arguments.
+	constexpr size_t kMinimumFieldSize = sizeof(uint32_t) + 1 + sizeof(uint32_t) + sizeof(size_t) + sizeof(bool) + sizeof(uint32_t);
+	constexpr size_t kMinimumTypeSize = sizeof(uint32_t) + 1 + sizeof(USYM::TypeSymbol::Type) + sizeof(uint64_t) * 2 + sizeof(size_t) + sizeof(uint32_t);
+	constexpr size_t kMinimumFunctionSize = sizeof(uint32_t) + 1 + sizeof(uint32_t) * 2 + sizeof(size_t) + sizeof(USYM::CallingConvention) + sizeof(size_t);
+
+	// The same in the compact encoding, where every varint takes at least a byte.
+	constexpr size_t kMinimumCompactFieldSize = 5;
+	constexpr size_t kMinimumCompactTypeSize = 6 + sizeof(USYM::TypeSymbol::Type);
+	constexpr size_t kMinimumCompactFunctionSize = 7 + sizeof(USYM::CallingConvention);
+}
+
+void BinaryDeserializer::Setup(const std::string& aSourceFileName, USYM* apUsym)
+{
+	sourceFileName = aSourceFileName;
+	pUsym = apUsym;
+	isCompact = false;
+	names.clear();
+}
+
+bool BinaryDeserializer::ReadFromFile()
+{
+	// Names are interned as they are read, so the mapping is not needed afterwards.
+	if (!reader.MapFromFile(sourceFileName, MappedFile::AccessHint::kSequential))
+		return false;
+
+	if (!BlockCompressedReader::IsBlockCompressed(reader.GetData(), reader.size))
+		return true;
+
+	// Compressed files are decompressed as a whole, on all cores, and read like any other.
+	BlockCompressedReader blocks{};
+	if (!blocks.Open(reader.GetData(), reader.size))
+		return false;
+
+	auto pPayload = std::make_unique_for_overwrite<uint8_t[]>(blocks.GetSize());
+	if (!blocks.ReadAll(pPayload.get()))
+		return false;
+
+	reader.pData = std::move(pPayload);
+	reader.pMapping = nullptr;
+	reader.size = blocks.GetSize();
+	reader.position = 0;
+
+	return true;
+}
+
+bool BinaryDeserializer::ReadCount(size_t& aCount, size_t aMinimumElementSize)
+{
+	if (!reader.Read(aCount))
+		return false;
+
+	return aCount <= (reader.size - reader.position) / aMinimumElementSize;
+}
+
+bool BinaryDeserializer::ReadName(InternedName& aName)
+{
+	std::string_view name{};
+	if (!reader.ReadStringView(name))
+		return false;
+
+	aName = pUsym->Intern(name);
+
+	return true;
+}
+
+bool BinaryDeserializer::ReadBool(bool& aValue)
+{
+	uint8_t value = 0;
+	if (!reader.Read(value))
+		return false;
+
+	aValue = value != 0;
+
+	return true;
+}
+
+bool BinaryDeserializer::DeserializeHeader()
+{
+	if (!reader.Read(pUsym->header.magic)
+		|| !reader.Read(pUsym->header.originalFormat)
+		|| !reader.Read(pUsym->header.architecture))
+		return false;
+
+	// The compact magic only tells the encoding, the symbols get the usual one.
+	isCompact = pUsym->header.magic == CompactEncoding::kMagic;
+	if (isCompact)
+		pUsym->header.magic = USYM::Header{}.magic;
+
+	if (pUsym->header.magic != USYM::Header{}.magic)
+	{
+		spdlog::error("{} is not a binary USYM file.", sourceFileName);
+		return false;
+	}
+
+	return true;
+}
+
+bool BinaryDeserializer::DeserializeTypeSymbols()
+{
+	if (isCompact)
+		return DeserializeCompactTypeSymbols();
+
+	size_t symbolCount = 0;
+	if (!ReadCount(symbolCount, kMinimumTypeSize))
+		return false;
+
+	pUsym->typeSymbols.reserve(pUsym->typeSymbols.size() + symbolCount);
+	pUsym->strings.Reserve(pUsym->strings.GetCount() + symbolCount);
+
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		USYM::TypeSymbol typeSymbol{};
+
+		if (!reader.Read(typeSymbol.id)
+			|| !ReadName(typeSymbol.name)
+			|| !reader.Read(typeSymbol.type)
+			|| !reader.Read(typeSymbol.length)
+			|| !reader.Read(typeSymbol.fieldCount))
+			return false;
+
+		size_t parameterCount = 0;
+		if (!ReadCount(parameterCount, kMinimumFieldSize))
+			return false;
+
+		typeSymbol.fields.resize(parameterCount);
+		for (auto& field : typeSymbol.fields)
+		{
+			if (!reader.Read(field.id)
+				|| !ReadName(field.name)
+				|| !reader.Read(field.underlyingTypeId)
+				|| !reader.Read(field.offset)
+				|| !ReadBool(field.isAnonymousUnion)
+				|| !reader.Read(field.unionId))
+				return false;
+		}
+
+		if (!reader.Read(typeSymbol.typedefSource))
+			return false;
+
+		const uint32_t id = typeSymbol.id;
+		if (!pUsym->typeSymbols.emplace(id, std::move(typeSymbol)).second)
+			spdlog::warn("Duplicate type symbol {} in {}, keeping the first one.", id, sourceFileName);
+	}
+
+	return true;
+}
+
+bool BinaryDeserializer::DeserializeFunctionSymbols()
+{
+	if (isCompact)
+		return DeserializeCompactFunctionSymbols();
+
+	size_t symbolCount = 0;
+	if (!ReadCount(symbolCount, kMinimumFunctionSize))
+		return false;
+
+	pUsym->functionSymbols.reserve(pUsym->functionSymbols.size() + symbolCount);
+
+	// Table position of every function read, to apply the lengths to, or npos for duplicates.
+	std::vector<size_t> positions{};
+	positions.reserve(symbolCount);
+
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		USYM::FunctionSymbol functionSymbol{};
+
+		if (!reader.Read(functionSymbol.id)
+			|| !ReadName(functionSymbol.name)
+			|| !reader.Read(functionSymbol.returnTypeId)
+			|| !reader.Read(functionSymbol.argumentCount))
+			return false;
+
+		size_t argumentTypeIdCount = 0;
+		if (!ReadCount(argumentTypeIdCount, sizeof(uint32_t)))
+			return false;
+
+		// The ids are stored back to back, so they are copied in one go.
+		functionSymbol.argumentTypeIds.resize(argumentTypeIdCount);
+		if (argumentTypeIdCount != 0
+			&& !reader.ReadImpl(functionSymbol.argumentTypeIds.data(), argumentTypeIdCount * sizeof(uint32_t)))
+			return false;
+
+		if (!reader.Read(functionSymbol.callingConvention)
+			|| !reader.Read(functionSymbol.virtualAddress))
+			return false;
+
+		const uint32_t id = functionSymbol.id;
+		const auto [it, isNew] = pUsym->functionSymbols.emplace(id, std::move(functionSymbol));
+		if (!isNew)
+			spdlog::warn("Duplicate function symbol {} in {}, keeping the first one.", id, sourceFileName);
+
+		positions.push_back(isNew ? static_cast<size_t>(it - pUsym->functionSymbols.begin()) : SymbolTable<USYM::FunctionSymbol>::npos);
+	}
+
+	// Files written before function lengths were added end here.
+	if (reader.position == reader.size)
+		return true;
+
+	size_t lengthCount = 0;
+	if (!ReadCount(lengthCount, sizeof(uint64_t)) || lengthCount != symbolCount)
+		return false;
+
+	for (const size_t position : positions)
+	{
+		uint64_t length = 0;
+		if (!reader.Read(length))
+			return false;
+
+		if (position != SymbolTable<USYM::FunctionSymbol>::npos)
+			(pUsym->functionSymbols.begin() + position)->second.length = length;
+	}
+
+	return true;
+}
+
+bool BinaryDeserializer::ReadVarint(uint64_t& aValue)
+{
+	const size_t size = CompactEncoding::DecodeVarint(reader.GetDataAtPosition(), reader.size - reader.position, aValue);
+	reader.Advance(size);
+	return size != 0;
+}
+
+bool BinaryDeserializer::ReadVarint(uint32_t& aValue)
+{
+	uint64_t value = 0;
+	if (!ReadVarint(value) || value > UINT32_MAX)
+		return false;
+
+	aValue = static_cast<uint32_t>(value);
+	return true;
+}
+
+bool BinaryDeserializer::ReadCompactCount(size_t& aCount, size_t aMinimumElementSize)
+{
+	uint64_t count = 0;
+	if (!ReadVarint(count) || count > (reader.size - reader.position) / aMinimumElementSize)
+		return false;
+
+	aCount = static_cast<size_t>(count);
+	return true;
+}
+
+bool BinaryDeserializer::ReadCompactName(InternedName& aName)
+{
+	uint64_t value = 0;
+	if (!ReadVarint(value))
+		return false;
+
+	if (value & 1)
+	{
+		if ((value >> 1) >= names.size())
+			return false;
+
+		aName = names[value >> 1];
+		return true;
+	}
+
+	const uint64_t length = value >> 1;
+	if (length > reader.size - reader.position)
+		return false;
+
+	aName = pUsym->Intern(std::string_view(reinterpret_cast<const char*>(reader.GetDataAtPosition()), static_cast<size_t>(length)));
+	reader.Advance(static_cast<size_t>(length));
+
+	if (!aName.empty())
+		names.push_back(aName);
+
+	return true;
+}
+
+bool BinaryDeserializer::DeserializeCompactTypeSymbols()
+{
+	using CompactEncoding::DecodeDelta;
+
+	size_t symbolCount = 0;
+	if (!ReadCompactCount(symbolCount, kMinimumCompactTypeSize))
+		return false;
+
+	pUsym->typeSymbols.reserve(pUsym->typeSymbols.size() + symbolCount);
+	pUsym->strings.Reserve(pUsym->strings.GetCount() + symbolCount);
+
+	uint32_t previousId = 0;
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		USYM::TypeSymbol typeSymbol{};
+
+		uint64_t id = 0;
+		if (!ReadVarint(id))
+			return false;
+
+		typeSymbol.id = previousId = static_cast<uint32_t>(DecodeDelta(id, previousId));
+
+		size_t fieldRecordCount = 0;
+		if (!ReadCompactName(typeSymbol.name)
+			|| !reader.Read(typeSymbol.type)
+			|| !ReadVarint(typeSymbol.length)
+			|| !ReadVarint(typeSymbol.fieldCount)
+			|| !ReadCompactCount(fieldRecordCount, kMinimumCompactFieldSize))
+			return false;
+
+		typeSymbol.fields.resize(fieldRecordCount);
+		uint32_t previousFieldId = typeSymbol.id;
+		uint64_t previousOffset = 0;
+		for (auto& field : typeSymbol.fields)
+		{
+			uint64_t fieldId = 0;
+			uint64_t offset = 0;
+			uint64_t unionValue = 0;
+			if (!ReadVarint(fieldId)
+				|| !ReadCompactName(field.name)
+				|| !ReadVarint(field.underlyingTypeId)
+				|| !ReadVarint(offset)
+				|| !ReadVarint(unionValue)
+				|| (unionValue >> 1) > UINT32_MAX)
+				return false;
+
+			field.id = previousFieldId = static_cast<uint32_t>(DecodeDelta(fieldId, previousFieldId));
+			field.offset = static_cast<size_t>(previousOffset = DecodeDelta(offset, previousOffset));
+			field.isAnonymousUnion = (unionValue & 1) != 0;
+			field.unionId = static_cast<uint32_t>(unionValue >> 1);
+		}
+
+		if (!ReadVarint(typeSymbol.typedefSource))
+			return false;
+
+		const uint32_t typeId = typeSymbol.id;
+		if (!pUsym->typeSymbols.emplace(typeId, std::move(typeSymbol)).second)
+			spdlog::warn("Duplicate type symbol {} in {}, keeping the first one.", typeId, sourceFileName);
+	}
+
+	return true;
+}
+
+bool BinaryDeserializer::DeserializeCompactFunctionSymbols()
+{
+	using CompactEncoding::DecodeDelta;
+
+	size_t symbolCount = 0;
+	if (!ReadCompactCount(symbolCount, kMinimumCompactFunctionSize))
+		return false;
+
+	pUsym->functionSymbols.reserve(pUsym->functionSymbols.size() + symbolCount);
+
+	uint32_t previousId = 0;
+	uint64_t previousAddress = 0;
+	for (size_t i = 0; i < symbolCount; i++)
+	{
+		USYM::FunctionSymbol functionSymbol{};
+
+		uint64_t id = 0;
+		size_t argumentTypeIdCount = 0;
+		if (!ReadVarint(id)
+			|| !ReadCompactName(functionSymbol.name)
+			|| !ReadVarint(functionSymbol.returnTypeId)
+			|| !ReadVarint(functionSymbol.argumentCount)
+			|| !ReadCompactCount(argumentTypeIdCount, 1))
+			return false;
+
+		functionSymbol.id = previousId = static_cast<uint32_t>(DecodeDelta(id, previousId));
+
+		functionSymbol.argumentTypeIds.resize(argumentTypeIdCount);
+		for (auto& argumentTypeId : functionSymbol.argumentTypeIds)
+		{
+			if (!ReadVarint(argumentTypeId))
+				return false;
+		}
+
+		uint64_t address = 0;
+		if (!reader.Read(functionSymbol.callingConvention)
+			|| !ReadVarint(address)
+			|| !ReadVarint(functionSymbol.length))
+			return false;
+
+		functionSymbol.virtualAddress = previousAddress = DecodeDelta(address, previousAddress);
+
+		const uint32_t functionId = functionSymbol.id;
+		if (!pUsym->functionSymbols.emplace(functionId, std::move(functionSymbol)).second)
+			spdlog::warn("Duplicate function symbol {} in {}, keeping the first one.", functionId, sourceFileName);
+	}
+
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "IDeserializer.h"
+#include "../StringPool.h"
+
+#include <Reader.h>
+
+#include <cstdint>
+#include <vector>
+
+// Reads the files written by BinarySerializer, in either encoding.
+class BinaryDeserializer final : public IDeserializer
+{
+public:
+	void Setup(const std::string& aSourceFileName, USYM* apUsym) override;
+
+protected:
+	bool ReadFromFile() override;
+	bool DeserializeHeader() override;
+	bool DeserializeTypeSymbols() override;
+	bool DeserializeFunctionSymbols() override;
+
+private:
+	// Reads an element count, and rejects counts that cannot fit in the rest of the file.
+	bool ReadCount(size_t& aCount, size_t aMinimumElementSize);
+	bool ReadName(InternedName& aName);
+	bool ReadBool(bool& aValue);
+
+	bool DeserializeCompactTypeSymbols();
+	bool DeserializeCompactFunctionSymbols();
+	bool ReadVarint(uint64_t& aValue);
+	bool ReadVarint(uint32_t& aValue);
+	bool ReadCompactCount(size_t& aCount, size_t aMinimumElementSize);
+	bool ReadCompactName(InternedName& aName);
+
+	Reader reader{};
+	bool isCompact = false;
+	// Every name read so far in the compact encoding, which later names can refer to.
+	std::vector<InternedName> names{};
+};
@@ -1,53 +1,83 @@
 #include "BinarySerializer.h"
+#include "CompactEncoding.h"
 
 #include "../USYM.h"
 
+#include <spdlog/spdlog.h>
+
+BinarySerializer::BinarySerializer(Encoding aEncoding, Compression aCompression)
+	: encoding(aEncoding)
+	, compression(aCompression)
+{
+}
+
 void BinarySerializer::Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym)
 {
 	targetFileName = aTargetFileNameNoExtension + ".usym";
 	pUsym = apUsym;
+	nameIndices.clear();
 }
 
 bool BinarySerializer::WriteToFile()
 {
-	return writer.WriteToFile(targetFileName);
+	// The container has a magic of its own, which it fills in last.
+	if (compression == Compression::kBlocks)
+		return compressedWriter.Close();
+
+	// Everything else is written by now, so a file that is cut off has no valid magic.
+	const uint32_t magic = GetMagic();
+	writer.Patch(0, &magic, sizeof(magic));
+
+	return writer.Close();
 }
 
 bool BinarySerializer::SerializeHeader()
 {
-	writer.Write(pUsym->header.magic);
-	writer.Write(pUsym->header.originalFormat);
-	writer.Write(pUsym->header.architecture);
+	const bool isOpen = compression == Compression::kBlocks ? compressedWriter.Open(targetFileName) : writer.Open(targetFileName);
+	if (!isOpen)
+	{
+		spdlog::error("Failed to create {}.", targetFileName);
+		return false;
+	}
+
+	// Uncompressed files get their magic last, see WriteToFile().
+	const uint32_t magic = compression == Compression::kBlocks ? GetMagic() : 0;
+	Write(magic);
+	Write(pUsym->header.originalFormat);
+	Write(pUsym->header.architecture);
 
 	return true;
 }
 
 bool BinarySerializer::SerializeTypeSymbols()
 {
+	if (encoding == Encoding::kCompact)
+		return SerializeCompactTypeSymbols();
+
 	const size_t symbolCount = pUsym->typeSymbols.size();
-	writer.Write(symbolCount);
+	Write(symbolCount);
 
 	for (const auto& [id, typeSymbol] : pUsym->typeSymbols)
 	{
-		writer.Write(typeSymbol.id);
-		writer.WriteString(typeSymbol.name);
-		writer.Write(typeSymbol.type);
-		writer.Write(typeSymbol.length);
-		writer.Write(typeSymbol.fieldCount);
+		Write(typeSymbol.id);
+		WriteString(typeSymbol.name);
+		Write(typeSymbol.type);
+		Write(typeSymbol.length);
+		Write(typeSymbol.fieldCount);
 
 		const size_t parameterCount = typeSymbol.fields.size();
-		writer.Write(parameterCount);
+		Write(parameterCount);
 		for (const auto& field : typeSymbol.fields)
 		{
-			writer.Write(field.id);
-			writer.WriteString(field.name);
-			writer.Write(field.underlyingTypeId);
-			writer.Write(field.offset);
-			writer.Write(field.isAnonymousUnion);
-			writer.Write(field.unionId);
+			Write(field.id);
+			WriteString(field.name);
+			Write(field.underlyingTypeId);
+			Write(field.offset);
+			Write(field.isAnonymousUnion);
+			Write(field.unionId);
 		}
 
-		writer.Write(typeSymbol.typedefSource);
+		Write(typeSymbol.typedefSource);
 	}
 
 	return true;
@@ -55,25 +85,152 @@ bool BinarySerializer::SerializeTypeSymbols()
 
 bool BinarySerializer::SerializeFunctionSymbols()
 {
+	if (encoding == Encoding::kCompact)
+		return SerializeCompactFunctionSymbols();
+
 	const size_t symbolCount = pUsym->functionSymbols.size();
-	writer.Write(symbolCount);
+	Write(symbolCount);
 
 	for (const auto& [id, functionSymbol] : pUsym->functionSymbols)
 	{
-		writer.Write(functionSymbol.id);
-		writer.WriteString(functionSymbol.name);
-		writer.Write(functionSymbol.returnTypeId);
-		writer.Write(functionSymbol.argumentCount);
+		Write(functionSymbol.id);
+		WriteString(functionSymbol.name);
+		Write(functionSymbol.returnTypeId);
+		Write(functionSymbol.argumentCount);
 
 		const size_t argumentTypeIdCount = functionSymbol.argumentTypeIds.size();
-		writer.Write(argumentTypeIdCount);
+		Write(argumentTypeIdCount);
 		for (const auto argumentTypeId : functionSymbol.argumentTypeIds)
 		{
-			writer.Write(argumentTypeId);
+			Write(argumentTypeId);
+		}
+
+		Write(functionSymbol.callingConvention);
+		Write(functionSymbol.virtualAddress);
+	}
+
+	// Function lengths were added to the format later. They follow all of the functions,
+	// in the same order, so files written before can still be read.
+	Write(symbolCount);
+	for (const auto& [id, functionSymbol] : pUsym->functionSymbols)
+		Write(functionSymbol.length);
+
+	return true;
+}
+
+uint32_t BinarySerializer::GetMagic() const
+{
+	return encoding == Encoding::kCompact ? CompactEncoding::kMagic : pUsym->header.magic;
+}
+
+void BinarySerializer::WriteImpl(const void* apSource, size_t aLength)
+{
+	if (compression == Compression::kBlocks)
+		compressedWriter.WriteImpl(apSource, aLength);
+	else
+		writer.WriteImpl(apSource, aLength);
+}
+
+void BinarySerializer::WriteString(std::string_view aSource)
+{
+	if (compression == Compression::kBlocks)
+		compressedWriter.WriteString(aSource);
+	else
+		writer.WriteString(aSource);
+}
+
+void BinarySerializer::WriteVarint(uint64_t aValue)
+{
+	uint8_t bytes[CompactEncoding::kMaxVarintSize];
+	WriteImpl(bytes, CompactEncoding::EncodeVarint(aValue, bytes));
+}
+
+void BinarySerializer::WriteCompactName(std::string_view aName)
+{
+	if (!aName.empty())
+	{
+		const auto [it, isNew] = nameIndices.emplace(aName.data(), static_cast<uint32_t>(nameIndices.size()));
+		if (!isNew)
+		{
+			WriteVarint(CompactEncoding::EncodeNameReference(it->second));
+			return;
 		}
+	}
+
+	WriteVarint(CompactEncoding::EncodeNewName(aName.size()));
+	WriteImpl(aName.data(), aName.size());
+}
+
+bool BinarySerializer::SerializeCompactTypeSymbols()
+{
+	using CompactEncoding::EncodeDelta;
+
+	nameIndices.reserve(pUsym->strings.GetCount());
+
+	WriteVarint(pUsym->typeSymbols.size());
+
+	uint32_t previousId = 0;
+	for (const auto& [id, typeSymbol] : pUsym->typeSymbols)
+	{
+		WriteVarint(EncodeDelta(typeSymbol.id, previousId));
+		previousId = typeSymbol.id;
+
+		WriteCompactName(typeSymbol.name);
+		Write(typeSymbol.type);
+		WriteVarint(typeSymbol.length);
+		WriteVarint(typeSymbol.fieldCount);
+
+		// Field ids follow the id of their type, and offsets mostly go up.
+		WriteVarint(typeSymbol.fields.size());
+		uint32_t previousFieldId = typeSymbol.id;
+		uint64_t previousOffset = 0;
+		for (const auto& field : typeSymbol.fields)
+		{
+			WriteVarint(EncodeDelta(field.id, previousFieldId));
+			previousFieldId = field.id;
+
+			WriteCompactName(field.name);
+			WriteVarint(field.underlyingTypeId);
+
+			WriteVarint(EncodeDelta(field.offset, previousOffset));
+			previousOffset = field.offset;
+
+			WriteVarint((static_cast<uint64_t>(field.unionId) << 1) | (field.isAnonymousUnion ? 1 : 0));
+		}
+
+		WriteVarint(typeSymbol.typedefSource);
+	}
+
+	return true;
+}
+
+bool BinarySerializer::SerializeCompactFunctionSymbols()
+{
+	using CompactEncoding::EncodeDelta;
+
+	WriteVarint(pUsym->functionSymbols.size());
+
+	uint32_t previousId = 0;
+	uint64_t previousAddress = 0;
+	for (const auto& [id, functionSymbol] : pUsym->functionSymbols)
+	{
+		WriteVarint(EncodeDelta(functionSymbol.id, previousId));
+		previousId = functionSymbol.id;
+
+		WriteCompactName(functionSymbol.name);
+		WriteVarint(functionSymbol.returnTypeId);
+		WriteVarint(functionSymbol.argumentCount);
+
+		WriteVarint(functionSymbol.argumentTypeIds.size());
+		for (const auto argumentTypeId : functionSymbol.argumentTypeIds)
+			WriteVarint(argumentTypeId);
+
+		Write(functionSymbol.callingConvention);
+
+		WriteVarint(EncodeDelta(functionSymbol.virtualAddress, previousAddress));
+		previousAddress = functionSymbol.virtualAddress;
 
-		writer.Write(functionSymbol.callingConvention);
-		writer.Write(functionSymbol.virtualAddress);
+		WriteVarint(functionSymbol.length);
 	}
 
 	return true;
@@ -1,12 +1,35 @@
 #pragma once
 
 #include "ISerializer.h"
+#include "BlockCompressedWriter.h"
 
-#include <Writer.h>
+#include <StreamWriter.h>
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 
 class BinarySerializer final : public ISerializer
 {
 public:
+	enum class Encoding
+	{
+		// Every value at its full width, the original .usym layout.
+		kFixed,
+		// Varints, deltas and shared names, see CompactEncoding.h. Read by the same deserializer.
+		kCompact,
+	};
+
+	enum class Compression
+	{
+		kNone,
+		// The whole file in Lz compressed blocks, see BlockCompressedFormat.h.
+		kBlocks,
+	};
+
+	BinarySerializer(Encoding aEncoding = Encoding::kFixed, Compression aCompression = Compression::kNone);
+
 	void Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym) override;
 
 protected:
@@ -15,6 +38,31 @@ protected:
 	bool SerializeFunctionSymbols() override;
 	bool WriteToFile() override;
 
-	// 1MB should cover most symbols.
-	Writer writer{ 1000000000 };
+private:
+	bool SerializeCompactTypeSymbols();
+	bool SerializeCompactFunctionSymbols();
+	uint32_t GetMagic() const;
+
+	template <class T>
+	void Write(const T& aValue)
+	{
+		static_assert(std::is_trivial<T>::value);
+		WriteImpl(&aValue, sizeof(T));
+	}
+	void WriteImpl(const void* apSource, size_t aLength);
+	void WriteString(std::string_view aSource);
+	void WriteVarint(uint64_t aValue);
+	void WriteCompactName(std::string_view aName);
+
+	Encoding encoding{};
+	Compression compression{};
+
+	// Symbols are written to the file as they are serialized, so memory use
+	// does not grow with the output. Only one of the writers is used, depending on the compression.
+	StreamWriter writer{};
+	BlockCompressedWriter compressedWriter{};
+
+	// Index of every name written so far in the compact encoding, by the address of its characters.
+	// Names are interned, so equal names share that address.
+	std::unordered_map<const char*, uint32_t> nameIndices{};
 };
\ No newline at end of file
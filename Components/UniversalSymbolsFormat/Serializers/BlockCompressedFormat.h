@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of a block compressed .usym file, a container around the bytes of a binary .usym.
+//
+// The file starts with a FileHeader. The payload is split into blocks of blockSize bytes,
+// only the last one can be shorter, and every block is compressed on its own with Lz, so
+// blocks can be decompressed in any order and in parallel. The blocks follow the header
+// back to back, and the index, a BlockEntry per block, follows the last block.
+// A block that does not get smaller is stored as is, which its entry tells by having the
+// same compressed and uncompressed size.
+namespace BlockCompressedFormat
+{
+	// Reads "USYZ" in the file, like the fixed width magic reads "USYM".
+	constexpr uint32_t kMagic = 'ZYSU';
+	constexpr uint32_t kVersion = 1;
+	constexpr size_t kDefaultBlockSize = 256 * 1024;
+
+	struct FileHeader
+	{
+		uint32_t magic{ kMagic };
+		uint32_t version{ kVersion };
+		uint32_t blockSize{};
+		uint32_t blockCount{};
+		// Size of the payload once decompressed.
+		uint64_t size{};
+		uint64_t indexOffset{};
+	};
+
+	struct BlockEntry
+	{
+		uint64_t offset{};
+		uint32_t compressedSize{};
+		uint32_t size{};
+	};
+}
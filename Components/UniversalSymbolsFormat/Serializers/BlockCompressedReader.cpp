@@ -0,0 +1,98 @@
+#include "BlockCompressedReader.h"
+
+#include <Lz.h>
+#include <ParallelFor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+bool BlockCompressedReader::IsBlockCompressed(const uint8_t* apData, size_t aSize)
+{
+	uint32_t magic = 0;
+	if (aSize < sizeof(magic))
+		return false;
+
+	std::memcpy(&magic, apData, sizeof(magic));
+	return magic == BlockCompressedFormat::kMagic;
+}
+
+bool BlockCompressedReader::Open(const uint8_t* apData, size_t aSize)
+{
+	using namespace BlockCompressedFormat;
+
+	pData = apData;
+	index.clear();
+
+	if (aSize < sizeof(FileHeader))
+		return false;
+
+	std::memcpy(&header, apData, sizeof(header));
+	if (header.magic != kMagic || header.version != kVersion)
+	{
+		spdlog::error("Unsupported block compressed file, version {}.", header.version);
+		return false;
+	}
+
+	const uint64_t expectedBlockCount = header.blockSize == 0 ? 0 : (header.size + header.blockSize - 1) / header.blockSize;
+	if ((header.blockSize == 0 && header.size != 0)
+		|| header.blockCount != expectedBlockCount
+		|| header.indexOffset < sizeof(FileHeader)
+		|| header.indexOffset > aSize
+		|| header.blockCount > (aSize - header.indexOffset) / sizeof(BlockEntry))
+	{
+		spdlog::error("Block compressed file has a corrupt header.");
+		return false;
+	}
+
+	index.resize(header.blockCount);
+	std::memcpy(index.data(), apData + header.indexOffset, index.size() * sizeof(BlockEntry));
+
+	for (size_t i = 0; i < index.size(); i++)
+	{
+		const BlockEntry& entry = index[i];
+		const uint64_t expectedSize = std::min<uint64_t>(header.blockSize, header.size - i * header.blockSize);
+		if (entry.size != expectedSize
+			|| entry.compressedSize > entry.size
+			|| entry.offset < sizeof(FileHeader)
+			|| entry.offset > header.indexOffset
+			|| entry.compressedSize > header.indexOffset - entry.offset)
+		{
+			spdlog::error("Block compressed file has a corrupt index entry for block {}.", i);
+			index.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool BlockCompressedReader::ReadBlock(size_t aBlockIndex, uint8_t* apDestination) const
+{
+	const BlockCompressedFormat::BlockEntry& entry = index[aBlockIndex];
+	const uint8_t* pSource = pData + entry.offset;
+
+	if (entry.compressedSize == entry.size)
+	{
+		std::memcpy(apDestination, pSource, entry.size);
+		return true;
+	}
+
+	return Lz::Decompress(pSource, entry.compressedSize, apDestination, entry.size);
+}
+
+bool BlockCompressedReader::ReadAll(uint8_t* apDestination, size_t aThreadCount) const
+{
+	std::atomic<bool> isOk = true;
+	ParallelFor(index.size(), [&](size_t aBlockIndex, size_t)
+	{
+		if (!ReadBlock(aBlockIndex, apDestination + aBlockIndex * header.blockSize))
+			isOk = false;
+	}, aThreadCount);
+
+	if (!isOk)
+		spdlog::error("Block compressed file has a corrupt block.");
+
+	return isOk;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "BlockCompressedFormat.h"
+
+#include <cstdint>
+#include <vector>
+
+// Reads a block compressed file, see BlockCompressedFormat.h, from memory, usually a mapping.
+// Blocks can be decompressed one at a time, to only pay for the ones needed, or all at once
+// on several threads.
+class BlockCompressedReader final
+{
+public:
+	// Checks the magic only.
+	static bool IsBlockCompressed(const uint8_t* apData, size_t aSize);
+
+	// Checks the header and the index. The data must outlive the reader.
+	bool Open(const uint8_t* apData, size_t aSize);
+
+	// Size of the whole payload once decompressed.
+	size_t GetSize() const { return header.size; }
+	size_t GetBlockCount() const { return index.size(); }
+	// Blocks start every GetBlockSize() bytes in the payload.
+	size_t GetBlockSize() const { return header.blockSize; }
+	size_t GetBlockSize(size_t aBlockIndex) const { return index[aBlockIndex].size; }
+
+	// Writes GetBlockSize(aBlockIndex) bytes to apDestination.
+	bool ReadBlock(size_t aBlockIndex, uint8_t* apDestination) const;
+	// Writes GetSize() bytes to apDestination. A thread count of 0 uses every core.
+	bool ReadAll(uint8_t* apDestination, size_t aThreadCount = 0) const;
+
+private:
+	const uint8_t* pData = nullptr;
+	BlockCompressedFormat::FileHeader header{};
+	std::vector<BlockCompressedFormat::BlockEntry> index{};
+};
@@ -0,0 +1,99 @@
+#include "BlockCompressedWriter.h"
+
+#include <Lz.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+BlockCompressedWriter::BlockCompressedWriter(size_t acBlockSize)
+	: blockSize(std::clamp<size_t>(acBlockSize, 1, std::numeric_limits<uint32_t>::max()))
+{
+}
+
+bool BlockCompressedWriter::Open(const std::string& acFilename)
+{
+	if (!output.Open(acFilename))
+		return false;
+
+	used = 0;
+	blockOffset = 0;
+	index.clear();
+
+	if (!pBlock)
+	{
+		pBlock = std::make_unique_for_overwrite<uint8_t[]>(blockSize);
+		pCompressed = std::make_unique_for_overwrite<uint8_t[]>(Lz::GetMaxCompressedSize(blockSize));
+	}
+
+	// The header is filled in last, so a file that is cut off has no valid magic.
+	BlockCompressedFormat::FileHeader header{};
+	header.magic = 0;
+	return output.WriteImpl(&header, sizeof(header));
+}
+
+bool BlockCompressedWriter::Close()
+{
+	if (!output.IsOpen())
+		return false;
+
+	bool isOk = used == 0 || CompressBlock();
+
+	BlockCompressedFormat::FileHeader header{};
+	header.blockSize = static_cast<uint32_t>(blockSize);
+	header.blockCount = static_cast<uint32_t>(index.size());
+	header.size = blockOffset;
+	header.indexOffset = output.GetPosition();
+
+	isOk = output.WriteImpl(index.data(), index.size() * sizeof(BlockCompressedFormat::BlockEntry)) && isOk;
+	isOk = output.Patch(0, &header, sizeof(header)) && isOk;
+
+	return output.Close() && isOk;
+}
+
+bool BlockCompressedWriter::WriteImpl(const void* apSource, const size_t acLength)
+{
+	const uint8_t* pSource = static_cast<const uint8_t*>(apSource);
+	size_t remaining = acLength;
+
+	while (remaining != 0)
+	{
+		if (used == blockSize && !CompressBlock())
+			return false;
+
+		const size_t count = std::min(remaining, blockSize - used);
+		std::memcpy(pBlock.get() + used, pSource, count);
+
+		used += count;
+		pSource += count;
+		remaining -= count;
+	}
+
+	return true;
+}
+
+bool BlockCompressedWriter::WriteString(std::string_view aSource)
+{
+	if (!aSource.empty() && !WriteImpl(aSource.data(), aSource.size()))
+		return false;
+
+	const char terminator = '\0';
+	return WriteImpl(&terminator, sizeof(terminator));
+}
+
+bool BlockCompressedWriter::CompressBlock()
+{
+	BlockCompressedFormat::BlockEntry entry{};
+	entry.offset = output.GetPosition();
+	entry.size = static_cast<uint32_t>(used);
+
+	const size_t compressedSize = Lz::Compress(pBlock.get(), used, pCompressed.get());
+	const bool isStored = compressedSize >= used;
+	entry.compressedSize = isStored ? entry.size : static_cast<uint32_t>(compressedSize);
+	index.push_back(entry);
+
+	blockOffset += used;
+	used = 0;
+
+	return output.WriteImpl(isStored ? pBlock.get() : pCompressed.get(), entry.compressedSize);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "BlockCompressedFormat.h"
+
+#include <StreamWriter.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Writes a block compressed file, see BlockCompressedFormat.h, with the same interface
+// as StreamWriter. Every full block is compressed and handed to a StreamWriter, which
+// writes it in the background while the next one is filled.
+class BlockCompressedWriter final
+{
+public:
+	BlockCompressedWriter(size_t acBlockSize = BlockCompressedFormat::kDefaultBlockSize);
+
+	bool Open(const std::string& acFilename);
+	// Compresses what is left, writes the index and closes the file.
+	bool Close();
+	bool IsOpen() const { return output.IsOpen(); }
+
+	// This only works on simple types with no pointers
+	template <class T>
+	bool Write(T& apSource)
+	{
+		static_assert(std::is_trivial<T>::value);
+		return WriteImpl(&apSource, sizeof(T));
+	}
+	bool WriteImpl(const void* apSource, const size_t acLength);
+
+	// Writes the characters followed by a NUL terminator.
+	bool WriteString(std::string_view aSource);
+
+	// Number of uncompressed bytes written so far.
+	size_t GetPosition() const { return blockOffset + used; }
+
+private:
+	bool CompressBlock();
+
+	size_t blockSize = BlockCompressedFormat::kDefaultBlockSize;
+
+	// The block being filled, and room for it once compressed.
+	std::unique_ptr<uint8_t[]> pBlock{};
+	std::unique_ptr<uint8_t[]> pCompressed{};
+	size_t used = 0;
+	size_t blockOffset = 0;
+
+	std::vector<BlockCompressedFormat::BlockEntry> index{};
+	StreamWriter output{};
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Building blocks of the compact encoding of the binary format, BinarySerializer::Encoding::kCompact.
+//
+// The layout follows the fixed width encoding, but every integer is a LEB128 varint:
+// counts, lengths and type references as is, ids, addresses and field offsets as the
+// zigzag encoded difference to the previous one in the same table or type, which is
+// small because they mostly go up in small steps. Names are stored once; repeats refer
+// back to the first occurrence. Function lengths are stored with the functions.
+namespace CompactEncoding
+{
+	// Reads "USYC" in the file, like the fixed width magic reads "USYM".
+	constexpr uint32_t kMagic = 'CYSU';
+	constexpr size_t kMaxVarintSize = 10;
+
+	// 7 bits per byte, low bits first, with the high bit set on every byte but the last.
+	inline size_t EncodeVarint(uint64_t aValue, uint8_t* apOutput)
+	{
+		size_t size = 0;
+		while (aValue >= 0x80)
+		{
+			apOutput[size++] = static_cast<uint8_t>(aValue) | 0x80;
+			aValue >>= 7;
+		}
+		apOutput[size++] = static_cast<uint8_t>(aValue);
+		return size;
+	}
+
+	// Returns the number of bytes read, or 0 if the varint is cut off or too long for 64 bits.
+	inline size_t DecodeVarint(const uint8_t* apData, size_t aSize, uint64_t& aValue)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < aSize && i < kMaxVarintSize; i++)
+		{
+			const uint64_t bits = apData[i] & 0x7F;
+			// The tenth byte only has room for the top bit.
+			if (i == kMaxVarintSize - 1 && bits > 1)
+				return 0;
+
+			value |= bits << (7 * i);
+			if ((apData[i] & 0x80) == 0)
+			{
+				aValue = value;
+				return i + 1;
+			}
+		}
+		return 0;
+	}
+
+	// Maps small negative and positive numbers to small unsigned ones: 0, -1, 1, -2, 2, ...
+	inline uint64_t EncodeDelta(uint64_t aValue, uint64_t aPrevious)
+	{
+		const int64_t delta = static_cast<int64_t>(aValue - aPrevious);
+		return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+	}
+
+	inline uint64_t DecodeDelta(uint64_t aEncoded, uint64_t aPrevious)
+	{
+		const uint64_t delta = (aEncoded >> 1) ^ (0 - (aEncoded & 1));
+		return aPrevious + delta;
+	}
+
+	// A name is either new, followed by its characters, or a reference to an earlier one.
+	inline uint64_t EncodeNewName(size_t aLength) { return static_cast<uint64_t>(aLength) << 1; }
+	inline uint64_t EncodeNameReference(uint32_t aIndex) { return (static_cast<uint64_t>(aIndex) << 1) | 1; }
+}
@@ -0,0 +1,26 @@
+#include "IDeserializer.h"
+
+using DR = IDeserializer::DeserializeResult;
+
+IDeserializer::DeserializeResult IDeserializer::DeserializeFromFile()
+{
+	if (sourceFileName == "")
+		return DR::kNoSourceFile;
+
+	if (!pUsym)
+		return DR::kNoData;
+
+	if (!ReadFromFile())
+		return DR::kFileReadFailed;
+
+	if (!DeserializeHeader())
+		return DR::kHeaderFailed;
+
+	if (!DeserializeTypeSymbols())
+		return DR::kTypeSymbolsFailed;
+
+	if (!DeserializeFunctionSymbols())
+		return DR::kFunctionSymbolsFailed;
+
+	return DR::kOk;
+}
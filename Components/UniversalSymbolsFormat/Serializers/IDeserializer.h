@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+struct USYM;
+
+class IDeserializer
+{
+public:
+	enum class DeserializeResult
+	{
+		kOk = 0,
+		kUnknown,
+		kNoSourceFile,
+		kNoData,
+		kFileReadFailed,
+
+		kHeaderFailed,
+		kTypeSymbolsFailed,
+		kFunctionSymbolsFailed,
+	};
+
+	DeserializeResult DeserializeFromFile();
+
+	virtual ~IDeserializer() = default;
+	virtual void Setup(const std::string& aSourceFileName, USYM* apUsym) = 0;
+
+protected:
+	virtual bool ReadFromFile() = 0;
+	virtual bool DeserializeHeader() = 0;
+	virtual bool DeserializeTypeSymbols() = 0;
+	virtual bool DeserializeFunctionSymbols() = 0;
+
+	std::string sourceFileName{};
+	USYM* pUsym{};
+};
@@ -12,6 +12,14 @@ public:
 	{
 		kBinary = 0,
 		kJson,
+		kIndexedBinary,
+		// Same schema as kJson, streamed to the file instead of built in memory.
+		kStreamingJson,
+		kStreamingJsonCompact,
+		// Same records as kBinary, with varints, deltas and shared names.
+		kCompactBinary,
+		// kCompactBinary in Lz compressed blocks, the smallest files.
+		kCompressedBinary,
 	};
 
 	enum class SerializeResult
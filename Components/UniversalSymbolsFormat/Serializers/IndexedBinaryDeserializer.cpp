@@ -0,0 +1,68 @@
+#include "IndexedBinaryDeserializer.h"
+
+#include "../USYM.h"
+
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+void IndexedBinaryDeserializer::Setup(const std::string& aSourceFileName, USYM* apUsym)
+{
+	sourceFileName = aSourceFileName;
+	pUsym = apUsym;
+}
+
+bool IndexedBinaryDeserializer::IsIndexedBinaryFile(const std::string& aFileName)
+{
+	std::ifstream file(aFileName, std::ios::binary);
+
+	uint32_t magic = 0;
+	if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)))
+		return false;
+
+	return magic == IndexedBinaryFormat::kMagic;
+}
+
+bool IndexedBinaryDeserializer::ReadFromFile()
+{
+	return view.Open(sourceFileName);
+}
+
+bool IndexedBinaryDeserializer::DeserializeHeader()
+{
+	pUsym->header.originalFormat = view.GetOriginalFormat();
+	pUsym->header.architecture = view.GetArchitecture();
+
+	return true;
+}
+
+bool IndexedBinaryDeserializer::DeserializeTypeSymbols()
+{
+	const auto types = view.GetTypes();
+	pUsym->typeSymbols.reserve(pUsym->typeSymbols.size() + types.size());
+	pUsym->strings.Reserve(pUsym->strings.GetCount() + types.size());
+
+	for (const auto& record : types)
+	{
+		USYM::TypeSymbol typeSymbol = view.ToTypeSymbol(record, *pUsym);
+		if (!pUsym->typeSymbols.emplace(record.id, std::move(typeSymbol)).second)
+			spdlog::warn("Duplicate type symbol {} in {}, keeping the first one.", record.id, sourceFileName);
+	}
+
+	return true;
+}
+
+bool IndexedBinaryDeserializer::DeserializeFunctionSymbols()
+{
+	const auto functions = view.GetFunctions();
+	pUsym->functionSymbols.reserve(pUsym->functionSymbols.size() + functions.size());
+
+	for (const auto& record : functions)
+	{
+		USYM::FunctionSymbol functionSymbol = view.ToFunctionSymbol(record, *pUsym);
+
+		if (!pUsym->functionSymbols.emplace(record.id, std::move(functionSymbol)).second)
+			spdlog::warn("Duplicate function symbol {} in {}, keeping the first one.", record.id, sourceFileName);
+	}
+
+	return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "IDeserializer.h"
+#include "../UsymView.h"
+
+#include <string>
+
+// Loads a whole file in the indexed binary format into a USYM.
+// To look up a few symbols, use UsymView directly instead.
+class IndexedBinaryDeserializer final : public IDeserializer
+{
+public:
+	void Setup(const std::string& aSourceFileName, USYM* apUsym) override;
+
+	// Checks the magic, without mapping the file.
+	static bool IsIndexedBinaryFile(const std::string& aFileName);
+
+protected:
+	bool ReadFromFile() override;
+	bool DeserializeHeader() override;
+	bool DeserializeTypeSymbols() override;
+	bool DeserializeFunctionSymbols() override;
+
+private:
+	UsymView view{};
+};
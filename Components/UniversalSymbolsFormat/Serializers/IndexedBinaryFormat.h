@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Layout of the indexed binary format, version 2 of .usym.
+//
+// The file starts with a FileHeader, directly followed by sectionCount SectionEntries.
+// Every section starts at a kAlignment aligned offset, so when the file is mapped the
+// record tables can be used in place. Records are sorted by id, names are StringRefs
+// into the string section, and the index sections are open addressing hash tables
+// that map ids and name hashes to record indices.
+// Sections added after the first release of the format are optional, readers treat
+// a missing one as if all of its values were 0.
+// Values are stored in the byte order of the machine that wrote the file, which is
+// little endian for every architecture we support; a mismatch shows up as a bad magic.
+namespace IndexedBinaryFormat
+{
+	// Reads "USY2" in the file, like the version 1 magic reads "USYM".
+	constexpr uint32_t kMagic = '2YSU';
+	constexpr uint16_t kVersion = 2;
+	constexpr size_t kAlignment = 8;
+
+	enum class SectionKind : uint32_t
+	{
+		// NUL terminated strings, offset 0 is the empty string.
+		kStrings = 1,
+		kTypes,
+		kFields,
+		kFunctions,
+		kArgumentTypeIds,
+		kTypeIdIndex,
+		kTypeNameIndex,
+		kFunctionIdIndex,
+		kFunctionNameIndex,
+		// Optional. A uint64_t code length per function record, in record order.
+		kFunctionLengths,
+	};
+
+	struct FileHeader
+	{
+		uint32_t magic{ kMagic };
+		uint16_t version{ kVersion };
+		uint8_t originalFormat{};
+		uint8_t architecture{};
+		uint32_t sectionCount{};
+		uint32_t reserved{};
+	};
+
+	struct SectionEntry
+	{
+		SectionKind kind{};
+		uint32_t reserved{};
+		uint64_t offset{};
+		uint64_t size{};
+	};
+
+	struct StringRef
+	{
+		uint32_t offset{};
+		uint32_t length{};
+	};
+
+	struct TypeRecord
+	{
+		uint32_t id{};
+		StringRef name{};
+		uint8_t type{};
+		uint8_t reserved[3]{};
+		uint64_t length{};
+		uint64_t fieldCount{};
+		// Range in the field section.
+		uint32_t firstField{};
+		uint32_t fieldRecordCount{};
+		uint32_t typedefSource{};
+		uint32_t reserved2{};
+	};
+
+	struct FieldRecord
+	{
+		uint32_t id{};
+		StringRef name{};
+		uint32_t underlyingTypeId{};
+		uint64_t offset{};
+		uint32_t unionId{};
+		uint8_t isAnonymousUnion{};
+		uint8_t reserved[3]{};
+	};
+
+	struct FunctionRecord
+	{
+		uint32_t id{};
+		StringRef name{};
+		uint32_t returnTypeId{};
+		uint32_t argumentCount{};
+		// Range in the argument type id section.
+		uint32_t firstArgument{};
+		uint32_t argumentRecordCount{};
+		uint8_t callingConvention{};
+		uint8_t reserved[3]{};
+		uint64_t virtualAddress{};
+	};
+
+	// Index sections are arrays of slots, with a power of two slot count.
+	// Keys are ids or name hashes, probing is linear from GetHomeSlot().
+	struct HashSlot
+	{
+		uint32_t key{};
+		// Record index + 1, 0 for empty slots.
+		uint32_t index{};
+	};
+
+	static_assert(sizeof(FileHeader) == 16);
+	static_assert(sizeof(SectionEntry) == 24);
+	static_assert(sizeof(TypeRecord) == 48);
+	static_assert(sizeof(FieldRecord) == 32);
+	static_assert(sizeof(FunctionRecord) == 40);
+	static_assert(sizeof(HashSlot) == 8);
+
+	// Both hashes are part of the format, so they cannot be replaced by std::hash.
+	inline uint32_t HashName(std::string_view aName)
+	{
+		// 64 bit FNV-1a, folded to 32 bits.
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (const char c : aName)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return static_cast<uint32_t>(hash ^ (hash >> 32));
+	}
+
+	inline size_t GetHomeSlot(uint32_t aKey, size_t aSlotCount)
+	{
+		return static_cast<size_t>((aKey * 0x9E3779B97F4A7C15ull) >> 32) & (aSlotCount - 1);
+	}
+
+	// Keeps the load factor at or below one half.
+	inline size_t GetSlotCount(size_t aRecordCount)
+	{
+		size_t slotCount = 2;
+		while (slotCount < aRecordCount * 2)
+			slotCount *= 2;
+		return slotCount;
+	}
+
+	inline size_t AlignUp(size_t aOffset)
+	{
+		return (aOffset + kAlignment - 1) & ~(kAlignment - 1);
+	}
+}
@@ -0,0 +1,244 @@
+#include "IndexedBinarySerializer.h"
+
+#include "../USYM.h"
+
+#include <Writer.h>
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+using namespace IndexedBinaryFormat;
+
+namespace
+{
+	template <class TRecord, class TGetKey>
+	std::vector<HashSlot> BuildIndex(const std::vector<TRecord>& aRecords, const TGetKey& aGetKey)
+	{
+		std::vector<HashSlot> slots(GetSlotCount(aRecords.size()));
+
+		for (size_t i = 0; i < aRecords.size(); i++)
+		{
+			uint32_t key = 0;
+			if (!aGetKey(aRecords[i], key))
+				continue;
+
+			size_t slot = GetHomeSlot(key, slots.size());
+			while (slots[slot].index != 0)
+				slot = (slot + 1) & (slots.size() - 1);
+
+			slots[slot].key = key;
+			slots[slot].index = static_cast<uint32_t>(i + 1);
+		}
+
+		return slots;
+	}
+
+	// Sorts the symbols of a table by id, so records can be scanned in id order.
+	template <class T>
+	std::vector<std::pair<uint32_t, const T*>> SortById(const SymbolTable<T>& aTable)
+	{
+		std::vector<std::pair<uint32_t, const T*>> symbols{};
+		symbols.reserve(aTable.size());
+		for (const auto& [id, symbol] : aTable)
+			symbols.emplace_back(id, &symbol);
+
+		std::sort(symbols.begin(), symbols.end(), [](const auto& aLeft, const auto& aRight) {
+			return aLeft.first < aRight.first;
+		});
+
+		return symbols;
+	}
+}
+
+void IndexedBinarySerializer::Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym)
+{
+	targetFileName = aTargetFileNameNoExtension + ".usym";
+	pUsym = apUsym;
+
+	header = FileHeader{};
+	strings.assign(1, '\0');
+	stringOffsets.clear();
+	types.clear();
+	fields.clear();
+	functions.clear();
+	functionLengths.clear();
+	argumentTypeIds.clear();
+}
+
+bool IndexedBinarySerializer::AddString(std::string_view aString, StringRef& aReference)
+{
+	aReference = StringRef{};
+	if (aString.empty())
+		return true;
+
+	const auto [it, isNew] = stringOffsets.try_emplace(aString, static_cast<uint32_t>(strings.size()));
+	if (isNew)
+	{
+		if (strings.size() + aString.size() + 1 > UINT32_MAX)
+		{
+			spdlog::error("String section of {} exceeds 4 GB.", targetFileName);
+			return false;
+		}
+
+		strings.append(aString);
+		strings.push_back('\0');
+	}
+
+	aReference.offset = it->second;
+	aReference.length = static_cast<uint32_t>(aString.size());
+
+	return true;
+}
+
+bool IndexedBinarySerializer::SerializeHeader()
+{
+	header.originalFormat = static_cast<uint8_t>(pUsym->header.originalFormat);
+	header.architecture = static_cast<uint8_t>(pUsym->header.architecture);
+
+	return true;
+}
+
+bool IndexedBinarySerializer::SerializeTypeSymbols()
+{
+	types.reserve(pUsym->typeSymbols.size());
+
+	for (const auto& [id, pSymbol] : SortById(pUsym->typeSymbols))
+	{
+		TypeRecord& record = types.emplace_back();
+		record.id = id;
+		record.type = static_cast<uint8_t>(pSymbol->type);
+		record.length = pSymbol->length;
+		record.fieldCount = pSymbol->fieldCount;
+		record.typedefSource = pSymbol->typedefSource;
+		if (!AddString(pSymbol->name, record.name))
+			return false;
+
+		if (fields.size() + pSymbol->fields.size() > UINT32_MAX)
+		{
+			spdlog::error("Too many fields to serialize to {}.", targetFileName);
+			return false;
+		}
+
+		record.firstField = static_cast<uint32_t>(fields.size());
+		record.fieldRecordCount = static_cast<uint32_t>(pSymbol->fields.size());
+
+		for (const auto& field : pSymbol->fields)
+		{
+			FieldRecord& fieldRecord = fields.emplace_back();
+			fieldRecord.id = field.id;
+			fieldRecord.underlyingTypeId = field.underlyingTypeId;
+			fieldRecord.offset = field.offset;
+			fieldRecord.unionId = field.unionId;
+			fieldRecord.isAnonymousUnion = field.isAnonymousUnion;
+			if (!AddString(field.name, fieldRecord.name))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool IndexedBinarySerializer::SerializeFunctionSymbols()
+{
+	functions.reserve(pUsym->functionSymbols.size());
+	functionLengths.reserve(pUsym->functionSymbols.size());
+
+	for (const auto& [id, pSymbol] : SortById(pUsym->functionSymbols))
+	{
+		FunctionRecord& record = functions.emplace_back();
+		record.id = id;
+		record.returnTypeId = pSymbol->returnTypeId;
+		record.argumentCount = pSymbol->argumentCount;
+		record.callingConvention = static_cast<uint8_t>(pSymbol->callingConvention);
+		record.virtualAddress = pSymbol->virtualAddress;
+		functionLengths.push_back(pSymbol->length);
+		if (!AddString(pSymbol->name, record.name))
+			return false;
+
+		if (argumentTypeIds.size() + pSymbol->argumentTypeIds.size() > UINT32_MAX)
+		{
+			spdlog::error("Too many argument types to serialize to {}.", targetFileName);
+			return false;
+		}
+
+		record.firstArgument = static_cast<uint32_t>(argumentTypeIds.size());
+		record.argumentRecordCount = static_cast<uint32_t>(pSymbol->argumentTypeIds.size());
+		argumentTypeIds.insert(argumentTypeIds.end(), pSymbol->argumentTypeIds.begin(), pSymbol->argumentTypeIds.end());
+	}
+
+	return true;
+}
+
+bool IndexedBinarySerializer::WriteToFile()
+{
+	auto getId = [](const auto& aRecord, uint32_t& aKey) {
+		aKey = aRecord.id;
+		return true;
+	};
+
+	// Unnamed symbols cannot be looked up by name, so they are left out of the name indexes.
+	auto getNameHash = [this](const auto& aRecord, uint32_t& aKey) {
+		if (aRecord.name.length == 0)
+			return false;
+
+		aKey = HashName(std::string_view(strings.data() + aRecord.name.offset, aRecord.name.length));
+		return true;
+	};
+
+	const std::vector<HashSlot> typeIdIndex = BuildIndex(types, getId);
+	const std::vector<HashSlot> typeNameIndex = BuildIndex(types, getNameHash);
+	const std::vector<HashSlot> functionIdIndex = BuildIndex(functions, getId);
+	const std::vector<HashSlot> functionNameIndex = BuildIndex(functions, getNameHash);
+
+	struct Section
+	{
+		SectionKind kind;
+		const void* pData;
+		size_t size;
+	};
+
+	const Section sections[] =
+	{
+		{ SectionKind::kStrings, strings.data(), strings.size() },
+		{ SectionKind::kTypes, types.data(), types.size() * sizeof(TypeRecord) },
+		{ SectionKind::kFields, fields.data(), fields.size() * sizeof(FieldRecord) },
+		{ SectionKind::kFunctions, functions.data(), functions.size() * sizeof(FunctionRecord) },
+		{ SectionKind::kArgumentTypeIds, argumentTypeIds.data(), argumentTypeIds.size() * sizeof(uint32_t) },
+		{ SectionKind::kTypeIdIndex, typeIdIndex.data(), typeIdIndex.size() * sizeof(HashSlot) },
+		{ SectionKind::kTypeNameIndex, typeNameIndex.data(), typeNameIndex.size() * sizeof(HashSlot) },
+		{ SectionKind::kFunctionIdIndex, functionIdIndex.data(), functionIdIndex.size() * sizeof(HashSlot) },
+		{ SectionKind::kFunctionNameIndex, functionNameIndex.data(), functionNameIndex.size() * sizeof(HashSlot) },
+		{ SectionKind::kFunctionLengths, functionLengths.data(), functionLengths.size() * sizeof(uint64_t) },
+	};
+
+	header.sectionCount = static_cast<uint32_t>(std::size(sections));
+
+	std::vector<SectionEntry> directory{};
+	size_t offset = sizeof(FileHeader) + std::size(sections) * sizeof(SectionEntry);
+	for (const auto& section : sections)
+	{
+		offset = AlignUp(offset);
+
+		SectionEntry& entry = directory.emplace_back();
+		entry.kind = section.kind;
+		entry.offset = offset;
+		entry.size = section.size;
+
+		offset += section.size;
+	}
+
+	// The layout is known up front, so the writer never has to grow.
+	Writer writer{ offset };
+	writer.WriteImpl(&header, sizeof(header));
+	writer.WriteImpl(directory.data(), directory.size() * sizeof(SectionEntry));
+
+	constexpr uint8_t padding[kAlignment]{};
+	for (size_t i = 0; i < std::size(sections); i++)
+	{
+		writer.WriteImpl(padding, directory[i].offset - writer.GetPosition());
+		if (sections[i].size != 0)
+			writer.WriteImpl(sections[i].pData, sections[i].size);
+	}
+
+	return writer.WriteToFile(targetFileName);
+}
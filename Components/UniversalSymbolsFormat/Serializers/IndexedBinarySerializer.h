@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ISerializer.h"
+#include "IndexedBinaryFormat.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Writes the indexed binary format, see IndexedBinaryFormat.h.
+// The file can be opened with UsymView to look up single symbols without loading the rest.
+class IndexedBinarySerializer final : public ISerializer
+{
+public:
+	void Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym) override;
+
+protected:
+	bool SerializeHeader() override;
+	bool SerializeTypeSymbols() override;
+	bool SerializeFunctionSymbols() override;
+	bool WriteToFile() override;
+
+private:
+	bool AddString(std::string_view aString, IndexedBinaryFormat::StringRef& aReference);
+
+	IndexedBinaryFormat::FileHeader header{};
+
+	std::string strings{};
+	std::unordered_map<std::string_view, uint32_t> stringOffsets{};
+
+	std::vector<IndexedBinaryFormat::TypeRecord> types{};
+	std::vector<IndexedBinaryFormat::FieldRecord> fields{};
+	std::vector<IndexedBinaryFormat::FunctionRecord> functions{};
+	std::vector<uint64_t> functionLengths{};
+	std::vector<uint32_t> argumentTypeIds{};
+};
@@ -80,6 +80,7 @@ bool JsonSerializer::SerializeFunctionSymbols()
 		symbol["argumentTypeIds"] = functionSymbol.argumentTypeIds;
 		symbol["callingConvention"] = functionSymbol.callingConvention;
 		symbol["virtualAddress"] = functionSymbol.virtualAddress;
+		symbol["length"] = functionSymbol.length;
 	}
 
 	j["functionSymbols"] = idJsonMap;
@@ -0,0 +1,194 @@
+#include "JsonWriter.h"
+
+#include <algorithm>
+#include <charconv>
+
+bool JsonWriter::Open(const std::string& aFileName, Style aStyle)
+{
+	file.open(aFileName, std::ios::binary | std::ios::trunc);
+	if (file.fail())
+		return false;
+
+	style = aStyle;
+	buffer.clear();
+	buffer.reserve(s_bufferSize);
+	scopes.clear();
+	isAfterKey = false;
+
+	return true;
+}
+
+bool JsonWriter::Close()
+{
+	if (style == Style::kPretty)
+		Append("\n");
+
+	Flush();
+	file.close();
+
+	return !file.fail();
+}
+
+void JsonWriter::BeginObject()
+{
+	BeginValue();
+	Append("{");
+	scopes.push_back(false);
+}
+
+void JsonWriter::EndObject()
+{
+	EndScope('}');
+}
+
+void JsonWriter::BeginArray()
+{
+	BeginValue();
+	Append("[");
+	scopes.push_back(false);
+}
+
+void JsonWriter::EndArray()
+{
+	EndScope(']');
+}
+
+void JsonWriter::Key(std::string_view aKey)
+{
+	BeginValue();
+	WriteString(aKey);
+	Append(style == Style::kPretty ? ": " : ":");
+	isAfterKey = true;
+}
+
+void JsonWriter::Value(uint64_t aValue)
+{
+	BeginValue();
+
+	char digits[20];
+	const auto result = std::to_chars(digits, digits + sizeof(digits), aValue);
+	Append(std::string_view(digits, result.ptr - digits));
+}
+
+void JsonWriter::Value(bool aValue)
+{
+	BeginValue();
+	Append(aValue ? "true" : "false");
+}
+
+void JsonWriter::Value(std::string_view aValue)
+{
+	BeginValue();
+	WriteString(aValue);
+}
+
+void JsonWriter::BeginValue()
+{
+	// A value directly after its key needs no separator.
+	if (isAfterKey)
+	{
+		isAfterKey = false;
+		return;
+	}
+
+	if (scopes.empty())
+		return;
+
+	if (scopes.back())
+		Append(",");
+	scopes.back() = true;
+
+	NewLine();
+}
+
+void JsonWriter::EndScope(char aClose)
+{
+	const bool hasElements = scopes.back();
+	scopes.pop_back();
+
+	// Empty objects and arrays stay on one line.
+	if (hasElements)
+		NewLine();
+
+	Append(std::string_view(&aClose, 1));
+}
+
+void JsonWriter::NewLine()
+{
+	if (style != Style::kPretty)
+		return;
+
+	Append("\n");
+
+	size_t indent = scopes.size() * s_indent;
+	static constexpr std::string_view spaces = "                                ";
+	while (indent > 0)
+	{
+		const size_t count = std::min(indent, spaces.size());
+		Append(spaces.substr(0, count));
+		indent -= count;
+	}
+}
+
+void JsonWriter::WriteString(std::string_view aString)
+{
+	static constexpr char hexDigits[] = "0123456789abcdef";
+
+	Append("\"");
+
+	// Characters that need no escaping are appended in runs.
+	size_t runStart = 0;
+	for (size_t i = 0; i < aString.size(); i++)
+	{
+		const uint8_t c = static_cast<uint8_t>(aString[i]);
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		Append(aString.substr(runStart, i - runStart));
+		runStart = i + 1;
+
+		switch (c)
+		{
+		case '"': Append("\\\""); break;
+		case '\\': Append("\\\\"); break;
+		case '\b': Append("\\b"); break;
+		case '\f': Append("\\f"); break;
+		case '\n': Append("\\n"); break;
+		case '\r': Append("\\r"); break;
+		case '\t': Append("\\t"); break;
+		default:
+		{
+			const char escape[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+			Append(std::string_view(escape, sizeof(escape)));
+			break;
+		}
+		}
+	}
+	Append(aString.substr(runStart));
+
+	Append("\"");
+}
+
+void JsonWriter::Append(std::string_view aData)
+{
+	if (buffer.size() + aData.size() > s_bufferSize)
+		Flush();
+
+	// Anything larger than the buffer skips it.
+	if (aData.size() > s_bufferSize)
+	{
+		file.write(aData.data(), aData.size());
+		return;
+	}
+
+	buffer.append(aData);
+}
+
+void JsonWriter::Flush()
+{
+	if (buffer.empty())
+		return;
+
+	file.write(buffer.data(), buffer.size());
+	buffer.clear();
+}
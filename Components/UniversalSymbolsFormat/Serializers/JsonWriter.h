@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes JSON straight to a file, through a fixed size buffer.
+//
+// Memory use does not depend on the size of the document. Pretty output matches
+// nlohmann::json's dump with an indent of 4, compact output has no whitespace at all.
+// Strings are written as UTF-8 without validating them.
+class JsonWriter
+{
+public:
+	enum class Style
+	{
+		kPretty,
+		kCompact,
+	};
+
+	bool Open(const std::string& aFileName, Style aStyle);
+	// Flushes the buffer and closes the file. Returns false if any write failed.
+	bool Close();
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	// Inside objects, every value is preceded by a key.
+	void Key(std::string_view aKey);
+
+	void Value(uint64_t aValue);
+	void Value(bool aValue);
+	void Value(std::string_view aValue);
+
+private:
+	void BeginValue();
+	void EndScope(char aClose);
+	void NewLine();
+	void WriteString(std::string_view aString);
+	void Append(std::string_view aData);
+	void Flush();
+
+	static constexpr size_t s_bufferSize = 1 << 20;
+	static constexpr size_t s_indent = 4;
+
+	std::ofstream file{};
+	std::string buffer{};
+	Style style{ Style::kPretty };
+	// Whether each open object or array already has an element.
+	std::vector<bool> scopes{};
+	bool isAfterKey = false;
+};
@@ -0,0 +1,148 @@
+#include "StreamingJsonSerializer.h"
+
+#include "../USYM.h"
+
+#include <charconv>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// Symbol tables are objects keyed by the decimal id.
+	void IdKey(JsonWriter& aWriter, uint32_t aId)
+	{
+		char digits[10];
+		const auto result = std::to_chars(digits, digits + sizeof(digits), aId);
+		aWriter.Key(std::string_view(digits, result.ptr - digits));
+	}
+}
+
+StreamingJsonSerializer::StreamingJsonSerializer(JsonWriter::Style aStyle)
+	: style(aStyle)
+{
+}
+
+void StreamingJsonSerializer::Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym)
+{
+	targetFileName = aTargetFileNameNoExtension + ".json";
+	pUsym = apUsym;
+}
+
+bool StreamingJsonSerializer::SerializeHeader()
+{
+	// Symbols are written as they are serialized, so the file has to exist before the first one.
+	if (!writer.Open(targetFileName, style))
+	{
+		spdlog::error("Failed to create {}.", targetFileName);
+		return false;
+	}
+
+	writer.BeginObject();
+
+	writer.Key("magic");
+	writer.Value(static_cast<uint64_t>(pUsym->header.magic));
+	writer.Key("originalFormat");
+	writer.Value(static_cast<uint64_t>(pUsym->header.originalFormat));
+	writer.Key("architecture");
+	writer.Value(static_cast<uint64_t>(pUsym->header.architecture));
+
+	return true;
+}
+
+bool StreamingJsonSerializer::SerializeTypeSymbols()
+{
+	writer.Key("typeSymbols");
+	writer.BeginObject();
+
+	for (const auto& [id, typeSymbol] : pUsym->typeSymbols)
+	{
+		IdKey(writer, id);
+		writer.BeginObject();
+
+		writer.Key("id");
+		writer.Value(static_cast<uint64_t>(typeSymbol.id));
+		writer.Key("name");
+		writer.Value(typeSymbol.name);
+		writer.Key("type");
+		writer.Value(static_cast<uint64_t>(typeSymbol.type));
+		writer.Key("length");
+		writer.Value(typeSymbol.length);
+		writer.Key("fieldCount");
+		writer.Value(typeSymbol.fieldCount);
+		writer.Key("typedefSource");
+		writer.Value(static_cast<uint64_t>(typeSymbol.typedefSource));
+
+		writer.Key("fields");
+		writer.BeginArray();
+		for (const auto& fieldSymbol : typeSymbol.fields)
+		{
+			writer.BeginObject();
+			writer.Key("id");
+			writer.Value(static_cast<uint64_t>(fieldSymbol.id));
+			writer.Key("name");
+			writer.Value(fieldSymbol.name);
+			writer.Key("underlyingTypeId");
+			writer.Value(static_cast<uint64_t>(fieldSymbol.underlyingTypeId));
+			writer.Key("offset");
+			writer.Value(static_cast<uint64_t>(fieldSymbol.offset));
+			writer.Key("isAnonymousUnion");
+			writer.Value(fieldSymbol.isAnonymousUnion);
+			writer.Key("unionId");
+			writer.Value(static_cast<uint64_t>(fieldSymbol.unionId));
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.EndObject();
+	}
+
+	writer.EndObject();
+
+	return true;
+}
+
+bool StreamingJsonSerializer::SerializeFunctionSymbols()
+{
+	writer.Key("functionSymbols");
+	writer.BeginObject();
+
+	for (const auto& [id, functionSymbol] : pUsym->functionSymbols)
+	{
+		IdKey(writer, id);
+		writer.BeginObject();
+
+		writer.Key("id");
+		writer.Value(static_cast<uint64_t>(functionSymbol.id));
+		writer.Key("name");
+		writer.Value(functionSymbol.name);
+		writer.Key("returnTypeId");
+		writer.Value(static_cast<uint64_t>(functionSymbol.returnTypeId));
+		writer.Key("argumentCount");
+		writer.Value(static_cast<uint64_t>(functionSymbol.argumentCount));
+
+		writer.Key("argumentTypeIds");
+		writer.BeginArray();
+		for (const auto argumentTypeId : functionSymbol.argumentTypeIds)
+			writer.Value(static_cast<uint64_t>(argumentTypeId));
+		writer.EndArray();
+
+		writer.Key("callingConvention");
+		writer.Value(static_cast<uint64_t>(functionSymbol.callingConvention));
+		writer.Key("virtualAddress");
+		writer.Value(static_cast<uint64_t>(functionSymbol.virtualAddress));
+		writer.Key("length");
+		writer.Value(functionSymbol.length);
+
+		writer.EndObject();
+	}
+
+	writer.EndObject();
+
+	return true;
+}
+
+bool StreamingJsonSerializer::WriteToFile()
+{
+	writer.EndObject();
+
+	return writer.Close();
+}
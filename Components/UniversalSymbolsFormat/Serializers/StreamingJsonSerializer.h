@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ISerializer.h"
+#include "JsonWriter.h"
+
+// Writes the same schema as JsonSerializer, but streams it to the file instead of building
+// a document first, so memory use stays bounded for any number of symbols.
+class StreamingJsonSerializer final : public ISerializer
+{
+public:
+	StreamingJsonSerializer(JsonWriter::Style aStyle = JsonWriter::Style::kPretty);
+
+	void Setup(const std::string& aTargetFileNameNoExtension, USYM* apUsym) override;
+
+protected:
+	bool SerializeHeader() override;
+	bool SerializeTypeSymbols() override;
+	bool SerializeFunctionSymbols() override;
+	bool WriteToFile() override;
+
+private:
+	JsonWriter::Style style{};
+	JsonWriter writer{};
+};
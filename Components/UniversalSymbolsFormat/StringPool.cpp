@@ -0,0 +1,97 @@
+#include "StringPool.h"
+
+#include <cstring>
+#include <utility>
+
+StringPool::StringPool(StringPool&& aOther) noexcept
+{
+  *this = std::move(aOther);
+}
+
+StringPool& StringPool::operator=(StringPool&& aOther) noexcept
+{
+  if (this == &aOther)
+    return *this;
+
+  blocks = std::move(aOther.blocks);
+  strings = std::move(aOther.strings);
+  pCurrent = std::exchange(aOther.pCurrent, nullptr);
+  remaining = std::exchange(aOther.remaining, 0);
+  allocatedBytes = std::exchange(aOther.allocatedBytes, 0);
+
+  aOther.Clear();
+
+  return *this;
+}
+
+InternedName StringPool::Intern(std::string_view aString)
+{
+  if (aString.empty())
+    return {};
+
+  const auto it = strings.find(aString);
+  if (it != strings.end())
+    return InternedName(*it);
+
+  char* pData = Allocate(aString.size() + 1);
+  std::memcpy(pData, aString.data(), aString.size());
+  pData[aString.size()] = '\0';
+
+  const std::string_view interned(pData, aString.size());
+  strings.insert(interned);
+
+  return InternedName(interned);
+}
+
+InternedName StringPool::Find(std::string_view aString) const
+{
+  const auto it = strings.find(aString);
+  if (it == strings.end())
+    return {};
+
+  return InternedName(*it);
+}
+
+bool StringPool::Contains(std::string_view aString) const
+{
+  return aString.empty() || strings.contains(aString);
+}
+
+void StringPool::Reserve(size_t aCount)
+{
+  strings.reserve(aCount);
+}
+
+void StringPool::Clear()
+{
+  strings.clear();
+  blocks.clear();
+  pCurrent = nullptr;
+  remaining = 0;
+  allocatedBytes = 0;
+}
+
+char* StringPool::Allocate(size_t aSize)
+{
+  // Strings that would waste most of a block get a block of their own, the current block stays in use.
+  if (aSize > s_blockSize / 4)
+  {
+    blocks.push_back(std::make_unique<char[]>(aSize));
+    allocatedBytes += aSize;
+    return blocks.back().get();
+  }
+
+  if (aSize > remaining)
+  {
+    blocks.push_back(std::make_unique<char[]>(s_blockSize));
+    allocatedBytes += s_blockSize;
+    pCurrent = blocks.back().get();
+    remaining = s_blockSize;
+  }
+
+  char* pData = pCurrent;
+  pCurrent += aSize;
+  remaining -= aSize;
+
+  return pData;
+}
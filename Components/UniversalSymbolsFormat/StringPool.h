@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// A string handed out by StringPool::Intern(). Only the pool creates them, so a literal or a
+// temporary can't be stored where an interned name is expected. Reads like a std::string_view.
+class InternedName
+{
+public:
+  InternedName() = default;
+
+  operator std::string_view() const { return view; }
+  std::string_view View() const { return view; }
+  const char* data() const { return view.data(); }
+  size_t size() const { return view.size(); }
+  bool empty() const { return view.empty(); }
+
+  // Compares the characters, so names of different pools can be compared too.
+  bool operator==(const InternedName& aOther) const { return view == aOther.view; }
+  bool operator==(std::string_view aOther) const { return view == aOther; }
+
+private:
+  friend class StringPool;
+
+  explicit InternedName(std::string_view aView) : view(aView) {}
+
+  std::string_view view{};
+};
+
+// Lets {fmt} and spdlog print names like strings.
+inline std::string_view format_as(InternedName aName)
+{
+  return aName.View();
+}
+
+// Deduplicated, arena backed string storage.
+//
+// Every distinct string is stored once, NUL terminated, in large blocks that are never
+// reallocated, so the names returned by Intern() stay valid until the pool is cleared or
+// destroyed, also when the pool itself is moved. Two names of the same pool are equal if and
+// only if they point to the same characters, so they can be compared by pointer.
+class StringPool
+{
+public:
+  StringPool() = default;
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+  StringPool(StringPool&& aOther) noexcept;
+  StringPool& operator=(StringPool&& aOther) noexcept;
+
+  // Returns the pooled copy of aString, adding it if it is not in the pool yet.
+  // The empty string is always interned as an empty view with no data.
+  InternedName Intern(std::string_view aString);
+  // Returns the pooled copy of aString, or an empty name if it was never interned.
+  InternedName Find(std::string_view aString) const;
+  bool Contains(std::string_view aString) const;
+
+  void Reserve(size_t aCount);
+  void Clear();
+
+  size_t GetCount() const { return strings.size(); }
+  // Bytes allocated for string data, including unused space in the current block.
+  size_t GetAllocatedBytes() const { return allocatedBytes; }
+
+  static bool IsSame(std::string_view aLeft, std::string_view aRight)
+  {
+    return aLeft.data() == aRight.data() && aLeft.size() == aRight.size();
+  }
+
+private:
+  char* Allocate(size_t aSize);
+
+  static constexpr size_t s_blockSize = 64 * 1024;
+
+  std::vector<std::unique_ptr<char[]>> blocks{};
+  char* pCurrent = nullptr;
+  size_t remaining = 0;
+  size_t allocatedBytes = 0;
+
+  std::unordered_set<std::string_view> strings{};
+};
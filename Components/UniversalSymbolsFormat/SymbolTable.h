@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Symbols keyed by their original id, stored contiguously in insertion order.
+//
+// Iterating is a sequential scan over the symbols. Ids are mapped to the index of their
+// symbol through an open addressing table that only holds indices, so sparse ids like
+// DIA symIndexIds or DWARF DIE offsets do not cost any memory beyond the table itself.
+// Like std::vector, inserting or erasing invalidates references to the symbols.
+// The ids in the entries are the keys and must not be changed through an iterator.
+// GetVersion() changes whenever symbols are added or removed, so indexes built on top of
+// the table can tell that they are out of date.
+template <class T>
+class SymbolTable
+{
+public:
+  using key_type = uint32_t;
+  using mapped_type = T;
+  using value_type = std::pair<uint32_t, T>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  static constexpr size_t npos = SIZE_MAX;
+
+  SymbolTable() = default;
+  SymbolTable(const SymbolTable&) = default;
+  SymbolTable(SymbolTable&&) noexcept = default;
+
+  // The contents are replaced, so the version has to move past both tables' versions.
+  SymbolTable& operator=(const SymbolTable& aOther)
+  {
+    entries = aOther.entries;
+    slots = aOther.slots;
+    mask = aOther.mask;
+    version = std::max(version, aOther.version) + 1;
+    return *this;
+  }
+
+  SymbolTable& operator=(SymbolTable&& aOther) noexcept
+  {
+    if (this == &aOther)
+      return *this;
+
+    entries = std::move(aOther.entries);
+    slots = std::move(aOther.slots);
+    mask = aOther.mask;
+    version = std::max(version, aOther.version) + 1;
+    aOther.clear();
+    return *this;
+  }
+
+  iterator begin() { return entries.begin(); }
+  iterator end() { return entries.end(); }
+  const_iterator begin() const { return entries.begin(); }
+  const_iterator end() const { return entries.end(); }
+
+  size_t size() const { return entries.size(); }
+  bool empty() const { return entries.empty(); }
+  uint64_t GetVersion() const { return version; }
+
+  void reserve(size_t aCount)
+  {
+    entries.reserve(aCount);
+    if (GetSlotCount(aCount) > slots.size())
+      Rehash(GetSlotCount(aCount));
+  }
+
+  void clear()
+  {
+    entries.clear();
+    slots.clear();
+    mask = 0;
+    version++;
+  }
+
+  // Returns the position of the symbol in iteration order, or npos.
+  size_t IndexOf(uint32_t aId) const
+  {
+    const size_t slot = FindSlot(aId);
+    if (slot == npos || slots[slot] == 0)
+      return npos;
+    return slots[slot] - 1;
+  }
+
+  iterator find(uint32_t aId)
+  {
+    const size_t index = IndexOf(aId);
+    return index == npos ? entries.end() : entries.begin() + index;
+  }
+
+  const_iterator find(uint32_t aId) const
+  {
+    const size_t index = IndexOf(aId);
+    return index == npos ? entries.end() : entries.begin() + index;
+  }
+
+  bool contains(uint32_t aId) const { return IndexOf(aId) != npos; }
+
+  T& at(uint32_t aId)
+  {
+    const size_t index = IndexOf(aId);
+    if (index == npos)
+      throw std::out_of_range("No symbol with this id.");
+    return entries[index].second;
+  }
+
+  const T& at(uint32_t aId) const
+  {
+    const size_t index = IndexOf(aId);
+    if (index == npos)
+      throw std::out_of_range("No symbol with this id.");
+    return entries[index].second;
+  }
+
+  T& operator[](uint32_t aId)
+  {
+    return emplace(aId).first->second;
+  }
+
+  // Adds a symbol constructed from aArgs, unless the id is already present.
+  template <class... TArgs>
+  std::pair<iterator, bool> emplace(uint32_t aId, TArgs&&... aArgs)
+  {
+    if (GetSlotCount(entries.size() + 1) > slots.size())
+      Rehash(GetSlotCount(entries.size() + 1));
+
+    const size_t slot = FindSlot(aId);
+    if (slots[slot] != 0)
+      return { entries.begin() + (slots[slot] - 1), false };
+
+    entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(aId), std::forward_as_tuple(std::forward<TArgs>(aArgs)...));
+    slots[slot] = static_cast<uint32_t>(entries.size());
+    version++;
+
+    return { entries.end() - 1, true };
+  }
+
+  // Removes every entry for which aPredicate(entry) is true, keeping the order of the others.
+  template <class TPredicate>
+  size_t erase_if(TPredicate aPredicate)
+  {
+    size_t kept = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      if (aPredicate(std::as_const(entries[i])))
+        continue;
+
+      if (kept != i)
+        entries[kept] = std::move(entries[i]);
+      kept++;
+    }
+
+    const size_t erased = entries.size() - kept;
+    if (erased == 0)
+      return 0;
+
+    entries.erase(entries.begin() + kept, entries.end());
+    Rehash(slots.size());
+    version++;
+
+    return erased;
+  }
+
+private:
+  // Keeps the load factor at or below one half.
+  static size_t GetSlotCount(size_t aCount)
+  {
+    size_t slotCount = 16;
+    while (slotCount < aCount * 2)
+      slotCount *= 2;
+    return slotCount;
+  }
+
+  size_t GetHomeSlot(uint32_t aId) const
+  {
+    // Multiplicative hashing, so ids that are multiples of a stride still spread over the slots.
+    return static_cast<size_t>((aId * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+  }
+
+  // Returns the slot holding aId, or the empty slot it would go into.
+  size_t FindSlot(uint32_t aId) const
+  {
+    if (slots.empty())
+      return npos;
+
+    size_t slot = GetHomeSlot(aId);
+    while (slots[slot] != 0 && entries[slots[slot] - 1].first != aId)
+      slot = (slot + 1) & mask;
+
+    return slot;
+  }
+
+  void Rehash(size_t aSlotCount)
+  {
+    slots.assign(aSlotCount, 0);
+    mask = aSlotCount - 1;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      size_t slot = GetHomeSlot(entries[i].first);
+      while (slots[slot] != 0)
+        slot = (slot + 1) & mask;
+      slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+  }
+
+  std::vector<value_type> entries{};
+  // Index + 1 of the entry that hashes to each slot, 0 for empty slots.
+  std::vector<uint32_t> slots{};
+  size_t mask = 0;
+  uint64_t version = 0;
+};
@@ -0,0 +1,223 @@
+#include "TypeDeduplicator.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+  constexpr uint64_t kExternalReference = 1ull << 32;
+}
+
+TypeDeduplicator::TypeDeduplicator(const USYM& aUsym)
+{
+  const auto& table = aUsym.typeSymbols;
+
+  // Sorting makes class numbering, and thereby the kept ids, independent of the table's insertion order.
+  std::vector<uint32_t> order(table.size());
+  for (uint32_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&table](uint32_t aLeft, uint32_t aRight) {
+    return (table.begin() + aLeft)->first < (table.begin() + aRight)->first;
+  });
+
+  // Maps the index of a type in the table to its index in types.
+  std::vector<uint32_t> tableToIndex(table.size());
+  ids.reserve(table.size());
+  types.reserve(table.size());
+  for (uint32_t i = 0; i < order.size(); i++)
+  {
+    const auto& [id, symbol] = *(table.begin() + order[i]);
+    ids.push_back(id);
+    types.push_back(&symbol);
+    tableToIndex[order[i]] = i;
+  }
+
+  auto toReference = [&table, &tableToIndex](uint32_t aId) -> uint64_t {
+    const size_t tableIndex = table.IndexOf(aId);
+    if (tableIndex == SymbolTable<USYM::TypeSymbol>::npos)
+      return kExternalReference | aId;
+    return tableToIndex[tableIndex];
+  };
+
+  referencesBegin.reserve(types.size() + 1);
+  for (const auto* pType : types)
+  {
+    referencesBegin.push_back(static_cast<uint32_t>(references.size()));
+
+    references.push_back(toReference(pType->typedefSource));
+    for (const auto& field : pType->fields)
+      references.push_back(toReference(field.underlyingTypeId));
+  }
+  referencesBegin.push_back(static_cast<uint32_t>(references.size()));
+}
+
+template <class THash, class TEquals>
+uint32_t TypeDeduplicator::Partition(const THash& aHash, const TEquals& aEquals, std::vector<uint32_t>& aClasses)
+{
+  const uint32_t count = static_cast<uint32_t>(types.size());
+
+  // Hash to the first representative with that hash, representatives that share a hash are chained.
+  std::unordered_map<uint64_t, uint32_t> heads{};
+  heads.reserve(count);
+  std::vector<uint32_t> nextRepresentative{};
+  std::vector<uint32_t> representatives{};
+
+  aClasses.assign(count, 0);
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const uint64_t hash = aHash(i);
+    const auto [head, isNew] = heads.try_emplace(hash, static_cast<uint32_t>(representatives.size()));
+
+    if (!isNew)
+    {
+      // Hash hits are only candidates, collisions are ruled out by comparing against each representative.
+      bool found = false;
+      uint32_t classId = head->second;
+      while (true)
+      {
+        if (aEquals(i, representatives[classId]))
+        {
+          aClasses[i] = classId;
+          found = true;
+          break;
+        }
+
+        if (nextRepresentative[classId] == UINT32_MAX)
+          break;
+        classId = nextRepresentative[classId];
+      }
+
+      if (found)
+        continue;
+
+      nextRepresentative[classId] = static_cast<uint32_t>(representatives.size());
+    }
+
+    aClasses[i] = static_cast<uint32_t>(representatives.size());
+    representatives.push_back(i);
+    nextRepresentative.push_back(UINT32_MAX);
+  }
+
+  return static_cast<uint32_t>(representatives.size());
+}
+
+bool TypeDeduplicator::HasSameShape(uint32_t aLeft, uint32_t aRight) const
+{
+  const USYM::TypeSymbol& left = *types[aLeft];
+  const USYM::TypeSymbol& right = *types[aRight];
+
+  if (left.type != right.type
+    || left.length != right.length
+    || left.fieldCount != right.fieldCount
+    || left.fields.size() != right.fields.size()
+    || !StringPool::IsSame(left.name, right.name))
+    return false;
+
+  for (size_t i = 0; i < left.fields.size(); i++)
+  {
+    const USYM::FieldSymbol& leftField = left.fields[i];
+    const USYM::FieldSymbol& rightField = right.fields[i];
+
+    if (leftField.offset != rightField.offset
+      || leftField.isAnonymousUnion != rightField.isAnonymousUnion
+      || leftField.unionId != rightField.unionId
+      || !StringPool::IsSame(leftField.name, rightField.name))
+      return false;
+  }
+
+  return true;
+}
+
+uint64_t TypeDeduplicator::GetReferenceAtom(uint64_t aReference) const
+{
+  // Referenced types are compared by class, unknown ids only match themselves.
+  if (aReference & kExternalReference)
+    return aReference;
+
+  return classes[aReference];
+}
+
+std::unordered_map<uint32_t, uint32_t> TypeDeduplicator::Run()
+{
+  iterationCount = 0;
+
+  auto shapeHash = [this](uint32_t aIndex) -> uint64_t {
+    const USYM::TypeSymbol& type = *types[aIndex];
+
+    // Names are interned, so their address identifies them.
+    size_t hash = USYM::HashCombine(0, reinterpret_cast<uintptr_t>(type.name.data()));
+    hash = USYM::HashCombine(hash, static_cast<uint64_t>(type.type));
+    hash = USYM::HashCombine(hash, type.length);
+    hash = USYM::HashCombine(hash, type.fieldCount);
+    for (const auto& field : type.fields)
+    {
+      hash = USYM::HashCombine(hash, reinterpret_cast<uintptr_t>(field.name.data()));
+      hash = USYM::HashCombine(hash, field.offset);
+      hash = USYM::HashCombine(hash, (static_cast<uint64_t>(field.unionId) << 1) | field.isAnonymousUnion);
+    }
+    return hash;
+  };
+
+  auto shapeEquals = [this](uint32_t aLeft, uint32_t aRight) {
+    return HasSameShape(aLeft, aRight);
+  };
+
+  uint32_t classCount = Partition(shapeHash, shapeEquals, classes);
+
+  // A type's signature is its own class plus the classes of everything it references.
+  // Refining only ever splits classes, so an unchanged class count means the partition is stable.
+  std::vector<uint32_t> nextClasses{};
+  while (true)
+  {
+    iterationCount++;
+
+    auto signatureHash = [this](uint32_t aIndex) -> uint64_t {
+      size_t hash = USYM::HashCombine(0, classes[aIndex]);
+      for (uint32_t i = referencesBegin[aIndex]; i < referencesBegin[aIndex + 1]; i++)
+        hash = USYM::HashCombine(hash, GetReferenceAtom(references[i]));
+      return hash;
+    };
+
+    auto signatureEquals = [this](uint32_t aLeft, uint32_t aRight) {
+      if (classes[aLeft] != classes[aRight])
+        return false;
+
+      // Same class implies the same number of fields, and thereby references.
+      const uint32_t leftBegin = referencesBegin[aLeft];
+      const uint32_t rightBegin = referencesBegin[aRight];
+      const uint32_t count = referencesBegin[aLeft + 1] - leftBegin;
+
+      for (uint32_t i = 0; i < count; i++)
+      {
+        if (GetReferenceAtom(references[leftBegin + i]) != GetReferenceAtom(references[rightBegin + i]))
+          return false;
+      }
+
+      return true;
+    };
+
+    const uint32_t nextClassCount = Partition(signatureHash, signatureEquals, nextClasses);
+    classes.swap(nextClasses);
+
+    if (nextClassCount == classCount)
+      break;
+
+    classCount = nextClassCount;
+  }
+
+  // Types are sorted by id, so the first type of every class has the smallest id.
+  std::vector<uint32_t> representatives(classCount, UINT32_MAX);
+  std::unordered_map<uint32_t, uint32_t> oldToNew{};
+
+  for (uint32_t i = 0; i < types.size(); i++)
+  {
+    uint32_t& representative = representatives[classes[i]];
+    if (representative == UINT32_MAX)
+      representative = i;
+    else
+      oldToNew[ids[i]] = ids[representative];
+  }
+
+  return oldToNew;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "USYM.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Finds structurally identical types, including recursive ones.
+//
+// Types start out grouped by their own shape (kind, name, length and fields,
+// ignoring the ids they reference). Groups are then repeatedly split by the
+// groups of the types they reference, until no group splits anymore. What is
+// left are types that cannot be told apart, even when they reference each other,
+// like the node types of a linked list that was defined in several compile units.
+class TypeDeduplicator
+{
+public:
+  TypeDeduplicator(const USYM& aUsym);
+
+  // Returns a map of duplicate type ids to the id of the type that replaces them.
+  // The smallest id of every group of identical types is kept.
+  std::unordered_map<uint32_t, uint32_t> Run();
+
+  size_t GetIterationCount() const { return iterationCount; }
+
+private:
+  // Groups the types so that types i and j share a class if and only if aEquals(i, j).
+  // aHash must be consistent with aEquals. Returns the number of classes.
+  template <class THash, class TEquals>
+  uint32_t Partition(const THash& aHash, const TEquals& aEquals, std::vector<uint32_t>& aClasses);
+
+  bool HasSameShape(uint32_t aLeft, uint32_t aRight) const;
+  uint64_t GetReferenceAtom(uint64_t aReference) const;
+
+  // Types sorted by id, and their ids.
+  std::vector<uint32_t> ids{};
+  std::vector<const USYM::TypeSymbol*> types{};
+  // Flattened list of referenced types per type, see referencesBegin.
+  // Values below 2^32 are indices into types, other values are ids that are not in the table.
+  std::vector<uint64_t> references{};
+  std::vector<uint32_t> referencesBegin{};
+
+  std::vector<uint32_t> classes{};
+  size_t iterationCount = 0;
+};
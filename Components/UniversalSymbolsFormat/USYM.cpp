@@ -1,12 +1,63 @@
 #include "USYM.h"
 
+#include "TypeDeduplicator.h"
+#include "Serializers/BinaryDeserializer.h"
 #include "Serializers/BinarySerializer.h"
+#include "Serializers/IndexedBinaryDeserializer.h"
+#include "Serializers/IndexedBinarySerializer.h"
 #include "Serializers/JsonSerializer.h"
+#include "Serializers/StreamingJsonSerializer.h"
 
+#include <ParallelFor.h>
+
+#include <algorithm>
+#include <future>
 #include <stdexcept>
+#include <unordered_map>
 
 #include <spdlog/spdlog.h>
 
+namespace
+{
+  using Reference = USYM::TypeIdReport::Reference;
+
+  // Symbols per unit of work when verifying type ids, enough to make scheduling them cheap.
+  constexpr size_t kVerifyChunkSize = 4096;
+
+  const char* GetReferenceDescription(Reference aReference)
+  {
+    switch (aReference)
+    {
+    case Reference::kReturnType:
+      return "Return type id of function";
+    case Reference::kArgumentType:
+      return "Argument type id of function";
+    case Reference::kTypedefSource:
+      return "Typedef source of type";
+    case Reference::kFieldType:
+      return "Field type id of type";
+    default:
+      return "Type id of symbol";
+    }
+  }
+
+  // One line per sampled reference and one for the rest, rather than a line for every dangling id.
+  void LogTypeIdReport(const USYM::TypeIdReport& aReport)
+  {
+    for (const auto& sample : aReport.samples)
+      spdlog::warn("{} {} not found: {}", GetReferenceDescription(sample.reference), sample.symbolId, sample.typeId);
+
+    const uint64_t totalCount = aReport.GetTotalCount();
+    if (totalCount > aReport.samples.size())
+    {
+      spdlog::warn("{} more type ids not found. In total: {} return types, {} argument types, {} typedef sources, {} field types.",
+        totalCount - aReport.samples.size(),
+        aReport.GetCount(Reference::kReturnType), aReport.GetCount(Reference::kArgumentType),
+        aReport.GetCount(Reference::kTypedefSource), aReport.GetCount(Reference::kFieldType));
+    }
+  }
+}
+
 void USYM::SetSerializer(ISerializer::Type aType)
 {
   switch (aType)
@@ -17,14 +68,35 @@ void USYM::SetSerializer(ISerializer::Type aType)
   case ISerializer::Type::kJson:
     pSerializer = std::make_unique<JsonSerializer>();
     break;
+  case ISerializer::Type::kIndexedBinary:
+    pSerializer = std::make_unique<IndexedBinarySerializer>();
+    break;
+  case ISerializer::Type::kStreamingJson:
+    pSerializer = std::make_unique<StreamingJsonSerializer>(JsonWriter::Style::kPretty);
+    break;
+  case ISerializer::Type::kStreamingJsonCompact:
+    pSerializer = std::make_unique<StreamingJsonSerializer>(JsonWriter::Style::kCompact);
+    break;
+  case ISerializer::Type::kCompactBinary:
+    pSerializer = std::make_unique<BinarySerializer>(BinarySerializer::Encoding::kCompact);
+    break;
+  case ISerializer::Type::kCompressedBinary:
+    pSerializer = std::make_unique<BinarySerializer>(BinarySerializer::Encoding::kCompact, BinarySerializer::Compression::kBlocks);
+    break;
   default:
     throw std::runtime_error("No serializer for type found.");
   }
 }
 
 ISerializer::SerializeResult USYM::Serialize(const char* apOutputFileNoExtension)
+{
+  return Serialize(apOutputFileNoExtension, SerializeOptions{});
+}
+
+ISerializer::SerializeResult USYM::Serialize(const char* apOutputFileNoExtension, const SerializeOptions& aOptions)
 {
   using SR = ISerializer::SerializeResult;
+  using Verification = SerializeOptions::Verification;
 
   if (!pSerializer)
     return SR::kSerializerUninitialized;
@@ -33,30 +105,62 @@ ISerializer::SerializeResult USYM::Serialize(const char* apOutputFileNoExtension
 
   PurgeDuplicateTypes();
 
-  if (!VerifyTypeIds())
-    spdlog::critical("Some type ids are missing, check the logs above.");
+  auto logReport = [](const TypeIdReport& aReport)
+  {
+    LogTypeIdReport(aReport);
+    if (!aReport.IsValid())
+      spdlog::critical("Some type ids are missing, check the logs above.");
+  };
+
+  if (aOptions.verification == Verification::kBefore)
+    logReport(VerifyTypeIds(aOptions.verifyOptions));
+
+  // The serializers only read the symbols, so verifying them at the same time is safe.
+  std::future<TypeIdReport> report{};
+  if (aOptions.verification == Verification::kConcurrent)
+    report = std::async(std::launch::async, [this, &aOptions]() { return VerifyTypeIds(aOptions.verifyOptions); });
 
-  return pSerializer->SerializeToFile();
+  const SR result = pSerializer->SerializeToFile();
+
+  if (report.valid())
+    logReport(report.get());
+
+  return result;
 }
 
-void USYM::PurgeDuplicateTypes()
+IDeserializer::DeserializeResult USYM::Deserialize(const char* apInputFile)
 {
-  std::unordered_map<uint32_t, uint32_t> oldToNew{};
-  std::unordered_map<size_t, uint32_t> hashesToIds{};
+  Clear();
 
-  for (const auto& [id, symbol] : typeSymbols)
-  {
-    size_t hash = std::hash<USYM::TypeSymbol>()(symbol);
-    const auto fetchedId = hashesToIds.find(hash);
-    if (fetchedId != hashesToIds.end())
-    {
-      oldToNew[id] = fetchedId->second;
-    }
-    else
-    {
-      hashesToIds[hash] = id;
-    }
-  }
+  // Both binary formats use the .usym extension, the magic tells them apart.
+  std::unique_ptr<IDeserializer> pDeserializer{};
+  if (IndexedBinaryDeserializer::IsIndexedBinaryFile(apInputFile))
+    pDeserializer = std::make_unique<IndexedBinaryDeserializer>();
+  else
+    pDeserializer = std::make_unique<BinaryDeserializer>();
+
+  pDeserializer->Setup(apInputFile, this);
+
+  const auto result = pDeserializer->DeserializeFromFile();
+  if (result != IDeserializer::DeserializeResult::kOk)
+    Clear();
+
+  return result;
+}
+
+void USYM::Clear()
+{
+  header = Header{};
+  typeSymbols.clear();
+  functionSymbols.clear();
+  strings.Clear();
+}
+
+void USYM::PurgeDuplicateTypes()
+{
+  const std::unordered_map<uint32_t, uint32_t> oldToNew = TypeDeduplicator(*this).Run();
+  if (oldToNew.empty())
+    return;
 
   for (auto& [id, symbol] : typeSymbols)
   {
@@ -86,76 +190,171 @@ void USYM::PurgeDuplicateTypes()
     }
   }
 
-  std::erase_if(typeSymbols, [&oldToNew](const auto& item) {
+  typeSymbols.erase_if([&oldToNew](const auto& item) {
     auto const& [id, symbol] = item;
     return oldToNew.contains(id);
   });
 }
 
-template <class T, class U>
-const T& GetSymbolByName(const char* apName, const U& aSymbols)
+template <class T>
+std::span<const uint32_t> FindSymbolsByName(const StringPool& aStrings, NameIndex& aIndex, std::string_view aName, const SymbolTable<T>& aSymbols)
+{
+  // A name that was never interned cannot belong to any symbol.
+  const InternedName name = aStrings.Find(aName);
+  if (name.empty())
+    return {};
+
+  return aIndex.Find(aSymbols, name);
+}
+
+template <class T>
+const T& GetSymbolByName(const StringPool& aStrings, NameIndex& aIndex, std::string_view aName, const SymbolTable<T>& aSymbols)
 {
   static const T _{};
 
-  for (const auto& [id, symbol] : aSymbols)
+  const auto positions = FindSymbolsByName(aStrings, aIndex, aName, aSymbols);
+  if (positions.empty())
+    return _;
+
+  return (aSymbols.begin() + positions[0])->second;
+}
+
+template <class T>
+std::vector<const T*> GetSymbolsByName(const StringPool& aStrings, NameIndex& aIndex, std::string_view aName, const SymbolTable<T>& aSymbols)
+{
+  std::vector<const T*> symbols{};
+  for (const uint32_t position : FindSymbolsByName(aStrings, aIndex, aName, aSymbols))
+    symbols.push_back(&(aSymbols.begin() + position)->second);
+
+  return symbols;
+}
+
+const USYM::TypeSymbol& USYM::GetTypeSymbolByName(std::string_view aName) const
+{
+  return GetSymbolByName(strings, typeNameIndex, aName, typeSymbols);
+}
+
+const USYM::FunctionSymbol& USYM::GetFunctionSymbolByName(std::string_view aName) const
+{
+  return GetSymbolByName(strings, functionNameIndex, aName, functionSymbols);
+}
+
+std::vector<const USYM::TypeSymbol*> USYM::GetTypeSymbolsByName(std::string_view aName) const
+{
+  return GetSymbolsByName(strings, typeNameIndex, aName, typeSymbols);
+}
+
+std::vector<const USYM::FunctionSymbol*> USYM::GetFunctionSymbolsByName(std::string_view aName) const
+{
+  return GetSymbolsByName(strings, functionNameIndex, aName, functionSymbols);
+}
+
+const USYM::FunctionSymbol* USYM::Symbolize(uint64_t aAddress) const
+{
+  uint32_t position = AddressIndex::npos;
+  functionAddressIndex.Find(functionSymbols, std::span<const uint64_t>(&aAddress, 1), std::span<uint32_t>(&position, 1));
+
+  return position == AddressIndex::npos ? nullptr : &(functionSymbols.begin() + position)->second;
+}
+
+std::vector<const USYM::FunctionSymbol*> USYM::Symbolize(std::span<const uint64_t> aAddresses) const
+{
+  std::vector<uint32_t> positions(aAddresses.size());
+  functionAddressIndex.Find(functionSymbols, aAddresses, positions);
+
+  std::vector<const FunctionSymbol*> functions(aAddresses.size());
+  for (size_t i = 0; i < positions.size(); i++)
   {
-    if (symbol.name == apName)
-      return symbol;
+    if (positions[i] != AddressIndex::npos)
+      functions[i] = &(functionSymbols.begin() + positions[i])->second;
   }
 
-  return _;
+  return functions;
 }
 
-const USYM::TypeSymbol& USYM::GetTypeSymbolByName(const char* apName) const
+void USYM::InvalidateIndexes()
 {
-  return GetSymbolByName<TypeSymbol>(apName, typeSymbols);
+  typeNameIndex.Invalidate();
+  functionNameIndex.Invalidate();
+  functionAddressIndex.Invalidate();
 }
 
-const USYM::FunctionSymbol& USYM::GetFunctionSymbolByName(const char* apName) const
+uint64_t USYM::TypeIdReport::GetTotalCount() const
 {
-  return GetSymbolByName<FunctionSymbol>(apName, functionSymbols);
+  uint64_t totalCount = 0;
+  for (const uint64_t count : counts)
+    totalCount += count;
+  return totalCount;
 }
 
 // TODO: why are some return types null?
 bool USYM::VerifyTypeIds()
 {
-  bool purity = true;
+  const TypeIdReport report = VerifyTypeIds(VerifyOptions{});
+  LogTypeIdReport(report);
+  return report.IsValid();
+}
+
+USYM::TypeIdReport USYM::VerifyTypeIds(const VerifyOptions& aOptions) const
+{
+  // Every chunk of functions or types gets its own report, so the threads share nothing
+  // but the tables they read, and merging the reports in chunk order keeps the samples in table order.
+  const size_t functionChunkCount = (functionSymbols.size() + kVerifyChunkSize - 1) / kVerifyChunkSize;
+  const size_t typeChunkCount = (typeSymbols.size() + kVerifyChunkSize - 1) / kVerifyChunkSize;
+  std::vector<TypeIdReport> chunkReports(functionChunkCount + typeChunkCount);
 
-  for (const auto& [id, symbol] : functionSymbols)
+  ParallelFor(chunkReports.size(), [&](size_t aChunk, size_t)
   {
-    if (symbol.returnTypeId != 0 && typeSymbols.find(symbol.returnTypeId) == typeSymbols.end())
+    TypeIdReport& chunkReport = chunkReports[aChunk];
+
+    auto check = [&](Reference aReference, uint32_t aSymbolId, uint32_t aTypeId)
     {
-      purity = false;
-      spdlog::warn("Return type id of function {} not found: {}", symbol.id, symbol.returnTypeId);
-    }
+      if (aTypeId == 0 || typeSymbols.IndexOf(aTypeId) != SymbolTable<TypeSymbol>::npos)
+        return;
+
+      chunkReport.counts[static_cast<size_t>(aReference)]++;
+      if (chunkReport.samples.size() < aOptions.maxSamples)
+        chunkReport.samples.push_back({ aReference, aSymbolId, aTypeId });
+    };
 
-    for (const auto argumentTypeId : symbol.argumentTypeIds)
+    if (aChunk < functionChunkCount)
     {
-      if (argumentTypeId != 0 && typeSymbols.find(argumentTypeId) == typeSymbols.end())
+      const size_t first = aChunk * kVerifyChunkSize;
+      const size_t last = std::min(first + kVerifyChunkSize, functionSymbols.size());
+      for (auto it = functionSymbols.begin() + first; it != functionSymbols.begin() + last; ++it)
       {
-        purity = false;
-        spdlog::warn("Argument type id of function {} not found: {}", symbol.id, argumentTypeId);
+        const FunctionSymbol& symbol = it->second;
+        check(Reference::kReturnType, symbol.id, symbol.returnTypeId);
+        for (const auto argumentTypeId : symbol.argumentTypeIds)
+          check(Reference::kArgumentType, symbol.id, argumentTypeId);
       }
     }
-  }
-
-  for (const auto& [id, symbol] : typeSymbols)
-  {
-    if (symbol.typedefSource != 0 && typeSymbols.find(symbol.typedefSource) == typeSymbols.end())
-    {
-      purity = false;
-      spdlog::warn("Typedef source of type {} not found: {}", id, symbol.typedefSource);
-    }
-    
-    for (const auto& fieldSymbol : symbol.fields)
+    else
     {
-      if (fieldSymbol.underlyingTypeId != 0 && typeSymbols.find(fieldSymbol.underlyingTypeId) == typeSymbols.end())
+      const size_t first = (aChunk - functionChunkCount) * kVerifyChunkSize;
+      const size_t last = std::min(first + kVerifyChunkSize, typeSymbols.size());
+      for (auto it = typeSymbols.begin() + first; it != typeSymbols.begin() + last; ++it)
       {
-        purity = false;
-        spdlog::warn("Field type id of type {} not found: {}", id, fieldSymbol.underlyingTypeId);
+        const auto& [id, symbol] = *it;
+        check(Reference::kTypedefSource, id, symbol.typedefSource);
+        for (const auto& fieldSymbol : symbol.fields)
+          check(Reference::kFieldType, id, fieldSymbol.underlyingTypeId);
       }
     }
+  }, aOptions.threadCount);
+
+  TypeIdReport report{};
+  for (const auto& chunkReport : chunkReports)
+  {
+    for (size_t i = 0; i < report.counts.size(); i++)
+      report.counts[i] += chunkReport.counts[i];
+
+    for (const auto& sample : chunkReport.samples)
+    {
+      if (report.samples.size() < aOptions.maxSamples)
+        report.samples.push_back(sample);
+    }
   }
 
-  return purity;
+  return report;
 }
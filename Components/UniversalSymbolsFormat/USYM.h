@@ -1,8 +1,18 @@
 #pragma once
 
+#include "AddressIndex.h"
+#include "Serializers/IDeserializer.h"
 #include "Serializers/ISerializer.h"
+#include "NameIndex.h"
+#include "StringPool.h"
+#include "SymbolTable.h"
 
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 struct USYM
 {
@@ -31,10 +41,11 @@ struct USYM
     Architecture architecture{ Architecture::kUnknown };
   };
 
+  // Names are interned in the USYM's string pool, see Intern().
   struct Symbol
   {
     uint32_t id{};
-    std::string name{};
+    InternedName name{};
   };
 
   struct FieldSymbol : public Symbol
@@ -61,7 +72,8 @@ struct USYM
     bool operator==(const TypeSymbol& aOther) const
     {
       return
-        length == aOther.length
+        type == aOther.type
+        && length == aOther.length
         && fieldCount == aOther.fieldCount
         && name == aOther.name
         && fields == aOther.fields
@@ -111,24 +123,119 @@ struct USYM
     std::vector<uint32_t> argumentTypeIds{};
     CallingConvention callingConvention{ CallingConvention::kUnknown };
     size_t virtualAddress{};
+    // Size of the function's code in bytes, 0 if unknown.
+    uint64_t length{};
   };
 
+  // Mixes aValue into aSeed; used by the std::hash specializations of the symbols.
+  static size_t HashCombine(size_t aSeed, uint64_t aValue)
+  {
+    // splitmix64 finalizer, so that small, similar values still spread over all bits.
+    aValue += 0x9e3779b97f4a7c15ull;
+    aValue = (aValue ^ (aValue >> 30)) * 0xbf58476d1ce4e5b9ull;
+    aValue = (aValue ^ (aValue >> 27)) * 0x94d049bb133111ebull;
+    aValue ^= aValue >> 31;
+    return aSeed ^ (static_cast<size_t>(aValue) + 0x9e3779b9 + (aSeed << 6) + (aSeed >> 2));
+  }
+
+  // Dangling type ids found by VerifyTypeIds(), by the kind of reference that holds them.
+  struct TypeIdReport
+  {
+    enum class Reference : uint8_t
+    {
+      kReturnType = 0,
+      kArgumentType,
+      kTypedefSource,
+      kFieldType,
+
+      kCount
+    };
+
+    struct DanglingReference
+    {
+      Reference reference{};
+      // The function or type that holds the reference.
+      uint32_t symbolId{};
+      uint32_t typeId{};
+    };
+
+    uint64_t GetCount(Reference aReference) const { return counts[static_cast<size_t>(aReference)]; }
+    uint64_t GetTotalCount() const;
+    bool IsValid() const { return GetTotalCount() == 0; }
+
+    std::array<uint64_t, static_cast<size_t>(Reference::kCount)> counts{};
+    // The first dangling references in table order, functions first, at most VerifyOptions::maxSamples.
+    std::vector<DanglingReference> samples{};
+  };
+
+  struct VerifyOptions
+  {
+    // 0 uses every hardware thread.
+    size_t threadCount = 0;
+    size_t maxSamples = 16;
+  };
+
+  struct SerializeOptions
+  {
+    enum class Verification : uint8_t
+    {
+      // Verify the type ids, and log the result, before writing the file.
+      kBefore = 0,
+      // Verify the type ids on another thread while the file is written.
+      kConcurrent,
+      // Leave verification to the caller.
+      kSkip
+    };
+
+    Verification verification = Verification::kBefore;
+    VerifyOptions verifyOptions{};
+  };
+
+  // Returns the pooled copy of aName. All symbol names must be interned in the USYM
+  // that owns the symbol, so that equal names share their storage.
+  InternedName Intern(std::string_view aName) { return strings.Intern(aName); }
+
   void SetSerializer(ISerializer::Type aType);
   ISerializer::SerializeResult Serialize(const char* apOutputFileNoExtension);
+  ISerializer::SerializeResult Serialize(const char* apOutputFileNoExtension, const SerializeOptions& aOptions);
+  // Replaces the contents of this USYM with a file written by one of the binary serializers.
+  // On failure, the USYM is left empty.
+  IDeserializer::DeserializeResult Deserialize(const char* apInputFile);
+  void Clear();
+
+  // Return the first symbol named aName, or an empty symbol with id 0.
+  const TypeSymbol& GetTypeSymbolByName(std::string_view aName) const;
+  const FunctionSymbol& GetFunctionSymbolByName(std::string_view aName) const;
+  // Return all symbols named aName, e.g. every overload of a function, in table order.
+  std::vector<const TypeSymbol*> GetTypeSymbolsByName(std::string_view aName) const;
+  std::vector<const FunctionSymbol*> GetFunctionSymbolsByName(std::string_view aName) const;
+  // Return the function whose code contains aAddress, or nullptr.
+  // A function with an unknown length only contains its first address.
+  const FunctionSymbol* Symbolize(uint64_t aAddress) const;
+  // Resolves all of aAddresses at once, with nullptr for addresses outside of every function.
+  std::vector<const FunctionSymbol*> Symbolize(std::span<const uint64_t> aAddresses) const;
 
-  const TypeSymbol& GetTypeSymbolByName(const char* apName) const;
-  const FunctionSymbol& GetFunctionSymbolByName(const char* apName) const;
+  // The lookups by name and address use indexes that are rebuilt when symbols are added or removed.
+  // Call this after renaming symbols, or changing function addresses, in place.
+  void InvalidateIndexes();
 
   void PurgeDuplicateTypes();
+  // Checks that every referenced type id exists, and logs a summary of the ones that do not.
   bool VerifyTypeIds();
+  // Checks the functions and types in parallel, without logging.
+  TypeIdReport VerifyTypeIds(const VerifyOptions& aOptions) const;
 
 private:
   std::unique_ptr<ISerializer> pSerializer = nullptr;
+  mutable NameIndex typeNameIndex{};
+  mutable NameIndex functionNameIndex{};
+  mutable AddressIndex functionAddressIndex{};
 
 public:
   Header header{};
-  std::unordered_map<uint32_t, TypeSymbol> typeSymbols{};
-  std::unordered_map<uint32_t, FunctionSymbol> functionSymbols{};
+  StringPool strings{};
+  SymbolTable<TypeSymbol> typeSymbols{};
+  SymbolTable<FunctionSymbol> functionSymbols{};
 };
 
 namespace std
@@ -138,20 +245,28 @@ namespace std
   public:
     size_t operator()(const USYM::FieldSymbol& aSymbol) const
     {
-      // TODO: verify whether this works.
-      return hash<uint32_t>()(aSymbol.underlyingTypeId);
+      size_t fieldHash = hash<std::string_view>()(aSymbol.name);
+      fieldHash = USYM::HashCombine(fieldHash, aSymbol.underlyingTypeId);
+      fieldHash = USYM::HashCombine(fieldHash, aSymbol.offset);
+      fieldHash = USYM::HashCombine(fieldHash, aSymbol.isAnonymousUnion);
+      return USYM::HashCombine(fieldHash, aSymbol.unionId);
     }
   };
 
+  // Hashes the full shape of the type, but not its id.
   template <> class hash<USYM::TypeSymbol>
   {
   public:
     size_t operator()(const USYM::TypeSymbol& aSymbol) const
     {
-      size_t symbolHash = hash<uint64_t>()(aSymbol.length) ^ hash<uint64_t>()(aSymbol.fieldCount);
+      size_t symbolHash = hash<std::string_view>()(aSymbol.name);
+      symbolHash = USYM::HashCombine(symbolHash, static_cast<uint64_t>(aSymbol.type));
+      symbolHash = USYM::HashCombine(symbolHash, aSymbol.length);
+      symbolHash = USYM::HashCombine(symbolHash, aSymbol.fieldCount);
+      symbolHash = USYM::HashCombine(symbolHash, aSymbol.typedefSource);
       for (const auto& field : aSymbol.fields)
-        symbolHash ^= hash<USYM::FieldSymbol>()(field);
-      return symbolHash ^ hash<std::string>()(aSymbol.name);
+        symbolHash = USYM::HashCombine(symbolHash, hash<USYM::FieldSymbol>()(field));
+      return symbolHash;
     }
   };
 } // namespace std
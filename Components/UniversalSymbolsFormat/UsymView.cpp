@@ -0,0 +1,226 @@
+#include "UsymView.h"
+
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+using namespace IndexedBinaryFormat;
+
+namespace
+{
+  bool IsValidIndex(std::span<const HashSlot> aIndex)
+  {
+    return !aIndex.empty() && (aIndex.size() & (aIndex.size() - 1)) == 0;
+  }
+}
+
+bool UsymView::Open(const std::string& aFileName)
+{
+  Close();
+
+  auto pMapping = MappedFile::Open(aFileName);
+  if (!pMapping)
+    return false;
+
+  if (pMapping->GetSize() < sizeof(FileHeader))
+  {
+    spdlog::error("{} is too small to be a USYM file.", aFileName);
+    return false;
+  }
+
+  std::memcpy(&header, pMapping->GetData(), sizeof(FileHeader));
+  if (header.magic != kMagic || header.version != kVersion)
+  {
+    spdlog::error("{} is not an indexed USYM file.", aFileName);
+    return false;
+  }
+
+  if (header.sectionCount > (pMapping->GetSize() - sizeof(FileHeader)) / sizeof(SectionEntry))
+  {
+    spdlog::error("Section directory of {} is out of bounds.", aFileName);
+    return false;
+  }
+
+  pFile = std::move(pMapping);
+  directory = { reinterpret_cast<const SectionEntry*>(pFile->GetData() + sizeof(FileHeader)), header.sectionCount };
+
+  // Only the bounds of the sections are checked here, references inside records are checked on access.
+  if (!ReadSection(SectionKind::kStrings, strings)
+    || !ReadSection(SectionKind::kTypes, types)
+    || !ReadSection(SectionKind::kFields, fields)
+    || !ReadSection(SectionKind::kFunctions, functions)
+    || !ReadSection(SectionKind::kArgumentTypeIds, argumentTypeIds)
+    || !ReadSection(SectionKind::kTypeIdIndex, typeIdIndex)
+    || !ReadSection(SectionKind::kTypeNameIndex, typeNameIndex)
+    || !ReadSection(SectionKind::kFunctionIdIndex, functionIdIndex)
+    || !ReadSection(SectionKind::kFunctionNameIndex, functionNameIndex)
+    || !ReadSection(SectionKind::kFunctionLengths, functionLengths, true)
+    || (!functionLengths.empty() && functionLengths.size() != functions.size())
+    || strings.empty() || strings.back() != '\0'
+    || !IsValidIndex(typeIdIndex) || !IsValidIndex(typeNameIndex)
+    || !IsValidIndex(functionIdIndex) || !IsValidIndex(functionNameIndex))
+  {
+    spdlog::error("{} is damaged.", aFileName);
+    Close();
+    return false;
+  }
+
+  pFile->Advise(MappedFile::AccessHint::kRandom);
+
+  return true;
+}
+
+void UsymView::Close()
+{
+  *this = UsymView{};
+}
+
+template <class T>
+bool UsymView::ReadSection(SectionKind aKind, std::span<const T>& aSection, bool aIsOptional) const
+{
+  for (const auto& entry : directory)
+  {
+    if (entry.kind != aKind)
+      continue;
+
+    if (entry.offset % kAlignment != 0
+      || entry.offset > pFile->GetSize()
+      || entry.size > pFile->GetSize() - entry.offset
+      || entry.size % sizeof(T) != 0)
+      return false;
+
+    aSection = { reinterpret_cast<const T*>(pFile->GetData() + entry.offset), static_cast<size_t>(entry.size / sizeof(T)) };
+    return true;
+  }
+
+  return aIsOptional;
+}
+
+template <class TRecord, class TMatches>
+const TRecord* UsymView::Find(std::span<const HashSlot> aIndex, std::span<const TRecord> aRecords, uint32_t aKey, const TMatches& aMatches) const
+{
+  if (aIndex.empty())
+    return nullptr;
+
+  const size_t mask = aIndex.size() - 1;
+  size_t slot = GetHomeSlot(aKey, aIndex.size());
+
+  // A damaged index might not have an empty slot, so probe every slot at most once.
+  for (size_t i = 0; i < aIndex.size() && aIndex[slot].index != 0; i++)
+  {
+    const HashSlot& hashSlot = aIndex[slot];
+    if (hashSlot.key == aKey && hashSlot.index <= aRecords.size())
+    {
+      const TRecord& record = aRecords[hashSlot.index - 1];
+      if (aMatches(record))
+        return &record;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return nullptr;
+}
+
+const UsymView::TypeRecord* UsymView::FindType(uint32_t aId) const
+{
+  return Find(typeIdIndex, types, aId, [aId](const TypeRecord& aRecord) {
+    return aRecord.id == aId;
+  });
+}
+
+const UsymView::TypeRecord* UsymView::FindTypeByName(std::string_view aName) const
+{
+  return Find(typeNameIndex, types, HashName(aName), [this, aName](const TypeRecord& aRecord) {
+    return GetString(aRecord.name) == aName;
+  });
+}
+
+const UsymView::FunctionRecord* UsymView::FindFunction(uint32_t aId) const
+{
+  return Find(functionIdIndex, functions, aId, [aId](const FunctionRecord& aRecord) {
+    return aRecord.id == aId;
+  });
+}
+
+const UsymView::FunctionRecord* UsymView::FindFunctionByName(std::string_view aName) const
+{
+  return Find(functionNameIndex, functions, HashName(aName), [this, aName](const FunctionRecord& aRecord) {
+    return GetString(aRecord.name) == aName;
+  });
+}
+
+std::string_view UsymView::GetString(const StringRef& aReference) const
+{
+  if (aReference.length == 0 || aReference.offset >= strings.size() || aReference.length > strings.size() - aReference.offset)
+    return {};
+
+  return std::string_view(strings.data() + aReference.offset, aReference.length);
+}
+
+std::span<const UsymView::FieldRecord> UsymView::GetFields(const TypeRecord& aType) const
+{
+  if (aType.firstField > fields.size() || aType.fieldRecordCount > fields.size() - aType.firstField)
+    return {};
+
+  return fields.subspan(aType.firstField, aType.fieldRecordCount);
+}
+
+std::span<const uint32_t> UsymView::GetArgumentTypeIds(const FunctionRecord& aFunction) const
+{
+  if (aFunction.firstArgument > argumentTypeIds.size() || aFunction.argumentRecordCount > argumentTypeIds.size() - aFunction.firstArgument)
+    return {};
+
+  return argumentTypeIds.subspan(aFunction.firstArgument, aFunction.argumentRecordCount);
+}
+
+uint64_t UsymView::GetLength(const FunctionRecord& aFunction) const
+{
+  if (functionLengths.empty() || &aFunction < functions.data() || &aFunction >= functions.data() + functions.size())
+    return 0;
+
+  return functionLengths[&aFunction - functions.data()];
+}
+
+USYM::TypeSymbol UsymView::ToTypeSymbol(const TypeRecord& aType, USYM& aUsym) const
+{
+  USYM::TypeSymbol symbol{};
+  symbol.id = aType.id;
+  symbol.name = aUsym.Intern(GetString(aType.name));
+  symbol.type = static_cast<USYM::TypeSymbol::Type>(aType.type);
+  symbol.length = aType.length;
+  symbol.fieldCount = aType.fieldCount;
+  symbol.typedefSource = aType.typedefSource;
+
+  const auto fieldRecords = GetFields(aType);
+  symbol.fields.reserve(fieldRecords.size());
+  for (const auto& fieldRecord : fieldRecords)
+  {
+    USYM::FieldSymbol& field = symbol.fields.emplace_back();
+    field.id = fieldRecord.id;
+    field.name = aUsym.Intern(GetString(fieldRecord.name));
+    field.underlyingTypeId = fieldRecord.underlyingTypeId;
+    field.offset = fieldRecord.offset;
+    field.isAnonymousUnion = fieldRecord.isAnonymousUnion != 0;
+    field.unionId = fieldRecord.unionId;
+  }
+
+  return symbol;
+}
+
+USYM::FunctionSymbol UsymView::ToFunctionSymbol(const FunctionRecord& aFunction, USYM& aUsym) const
+{
+  USYM::FunctionSymbol symbol{};
+  symbol.id = aFunction.id;
+  symbol.name = aUsym.Intern(GetString(aFunction.name));
+  symbol.returnTypeId = aFunction.returnTypeId;
+  symbol.argumentCount = aFunction.argumentCount;
+  symbol.callingConvention = static_cast<USYM::CallingConvention>(aFunction.callingConvention);
+  symbol.virtualAddress = aFunction.virtualAddress;
+  symbol.length = GetLength(aFunction);
+
+  const auto argumentTypeIdRecords = GetArgumentTypeIds(aFunction);
+  symbol.argumentTypeIds.assign(argumentTypeIdRecords.begin(), argumentTypeIdRecords.end());
+
+  return symbol;
+}
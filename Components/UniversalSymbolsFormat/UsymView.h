@@ -0,0 +1,76 @@
+#pragma once
+
+#include "USYM.h"
+#include "Serializers/IndexedBinaryFormat.h"
+
+#include <MappedFile.h>
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Read-only access to a file in the indexed binary format, without loading it into a USYM.
+//
+// The file is mapped, so opening it only reads the header and section directory,
+// and a lookup only touches the index slots and records it needs.
+// Records, strings and the symbols made from them point into the mapping,
+// so they are only valid while the view is open.
+class UsymView
+{
+public:
+  using TypeRecord = IndexedBinaryFormat::TypeRecord;
+  using FieldRecord = IndexedBinaryFormat::FieldRecord;
+  using FunctionRecord = IndexedBinaryFormat::FunctionRecord;
+
+  bool Open(const std::string& aFileName);
+  void Close();
+  bool IsOpen() const { return pFile != nullptr; }
+
+  USYM::OriginalFormat GetOriginalFormat() const { return static_cast<USYM::OriginalFormat>(header.originalFormat); }
+  USYM::Architecture GetArchitecture() const { return static_cast<USYM::Architecture>(header.architecture); }
+
+  // All records, sorted by id.
+  std::span<const TypeRecord> GetTypes() const { return types; }
+  std::span<const FunctionRecord> GetFunctions() const { return functions; }
+
+  // Return nullptr if there is no such symbol. Lookups by name return the first symbol with that name.
+  const TypeRecord* FindType(uint32_t aId) const;
+  const TypeRecord* FindTypeByName(std::string_view aName) const;
+  const FunctionRecord* FindFunction(uint32_t aId) const;
+  const FunctionRecord* FindFunctionByName(std::string_view aName) const;
+
+  // Out of range references in a damaged file resolve to empty strings and spans.
+  std::string_view GetString(const IndexedBinaryFormat::StringRef& aReference) const;
+  std::span<const FieldRecord> GetFields(const TypeRecord& aType) const;
+  std::span<const uint32_t> GetArgumentTypeIds(const FunctionRecord& aFunction) const;
+  // 0 if unknown, also for files written before lengths were stored.
+  uint64_t GetLength(const FunctionRecord& aFunction) const;
+
+  // Copies a record into a symbol for aUsym, with its names interned in aUsym's pool.
+  USYM::TypeSymbol ToTypeSymbol(const TypeRecord& aType, USYM& aUsym) const;
+  USYM::FunctionSymbol ToFunctionSymbol(const FunctionRecord& aFunction, USYM& aUsym) const;
+
+private:
+  // Optional sections are left empty if they are missing, but still have to be valid if they are not.
+  template <class T>
+  bool ReadSection(IndexedBinaryFormat::SectionKind aKind, std::span<const T>& aSection, bool aIsOptional = false) const;
+
+  template <class TRecord, class TMatches>
+  const TRecord* Find(std::span<const IndexedBinaryFormat::HashSlot> aIndex, std::span<const TRecord> aRecords, uint32_t aKey, const TMatches& aMatches) const;
+
+  std::shared_ptr<const MappedFile> pFile{};
+  IndexedBinaryFormat::FileHeader header{};
+  std::span<const IndexedBinaryFormat::SectionEntry> directory{};
+
+  std::span<const char> strings{};
+  std::span<const TypeRecord> types{};
+  std::span<const FieldRecord> fields{};
+  std::span<const FunctionRecord> functions{};
+  std::span<const uint64_t> functionLengths{};
+  std::span<const uint32_t> argumentTypeIds{};
+  std::span<const IndexedBinaryFormat::HashSlot> typeIdIndex{};
+  std::span<const IndexedBinaryFormat::HashSlot> typeNameIndex{};
+  std::span<const IndexedBinaryFormat::HashSlot> functionIdIndex{};
+  std::span<const IndexedBinaryFormat::HashSlot> functionNameIndex{};
+};
@@ -6,6 +6,14 @@
 #include <UniversalSymbolsFormat/USYM.h>
 #include <ElfProcessor/ElfInterface.h>
 
+#include <BatchScheduler.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
 void InitializeLogger()
 {
   auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -15,11 +23,97 @@ void InitializeLogger()
   set_default_logger(logger);
 }
 
+bool IsElfFile(const std::string& aFileName)
+{
+  char magic[4]{};
+  std::ifstream file(aFileName, std::ios::binary);
+  return file.read(magic, sizeof(magic)) && magic[0] == 0x7f && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F';
+}
+
+// Converts every ELF file under a directory, or every file of a manifest, next to where it is.
+int ConvertBatch(const std::string& aSource, const BatchOptions& aOptions, const std::string& aTimingsFile, const std::vector<std::string>& aDebugDirectories)
+{
+  std::vector<std::string> inputs{};
+  const bool isListed = std::filesystem::is_directory(aSource) ? ListFiles(aSource, IsElfFile, inputs) : ReadFileList(aSource, inputs);
+  if (!isListed)
+  {
+    spdlog::error("Failed to read {}.", aSource);
+    return 1;
+  }
+
+  spdlog::info("Converting {} files.", inputs.size());
+
+  const std::vector<uint64_t> sizes = GetFileSizes(inputs);
+  const auto timings = ElfInterface::CreateUsymsFromFiles(inputs, [&](size_t aIndex, std::optional<USYM>& aUsym) {
+    if (!aUsym)
+    {
+      spdlog::error("Failed to load USYM format from {}.", inputs[aIndex]);
+      return false;
+    }
+
+    // Every file already has a thread of its own, verifying on more would oversubscribe the cores.
+    aUsym->SetSerializer(ISerializer::Type::kJson);
+    if (aUsym->Serialize(inputs[aIndex].c_str(), USYM::SerializeOptions{ .verifyOptions = { .threadCount = 1 } }) != ISerializer::SerializeResult::kOk)
+    {
+      spdlog::error("Failed to write the USYM of {}.", inputs[aIndex]);
+      return false;
+    }
+
+    // Freed here, on the worker, rather than kept until the batch is done.
+    aUsym.reset();
+    return true;
+  }, aOptions, aDebugDirectories);
+
+  if (!aTimingsFile.empty())
+    WriteBatchTimings(aTimingsFile, inputs, sizes, timings);
+
+  return LogBatchSummary(inputs, sizes, timings) == 0 ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
   InitializeLogger();
 
-  auto pUsymResult = ElfInterface::CreateUsymFromFile(R"(C:\Users\Someone\Desktop\linux_rust_sample\target\debug\rust_linux_sample)");
+  std::string batchSource{};
+  std::string timingsFile{};
+  BatchOptions batchOptions{};
+  std::vector<std::string> arguments{};
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--batch" && i + 1 < argc)
+      batchSource = argv[++i];
+    else if (argument == "--threads" && i + 1 < argc)
+      batchOptions.threadCount = std::strtoull(argv[++i], nullptr, 10);
+    else if (argument == "--max-memory" && i + 1 < argc)
+      batchOptions.maxBytesInFlight = std::strtoull(argv[++i], nullptr, 10) << 20;
+    else if (argument == "--timings" && i + 1 < argc)
+      timingsFile = argv[++i];
+    else
+      arguments.push_back(argument);
+  }
+
+  if (batchSource.empty() && arguments.empty())
+  {
+    spdlog::info("Usage: {} [path_to_elf] [debug_directory...]", argv[0]);
+    spdlog::info("       {} --batch [directory_or_manifest] [--threads count] [--max-memory megabytes] [--timings path_to_csv] [debug_directory...]", argv[0]);
+    spdlog::info("A batch converts every ELF file under the directory, or every file listed in the manifest, largest first.");
+    spdlog::info("--max-memory bounds the summed size of the files being converted at once.");
+    exit(1);
+  }
+
+  // Where the separate debug files of stripped binaries are looked for, besides next to them.
+  std::vector<std::string> debugDirectories(arguments.begin() + (batchSource.empty() ? 1 : 0), arguments.end());
+  if (debugDirectories.empty())
+    debugDirectories.push_back("/usr/lib/debug");
+
+  if (!batchSource.empty())
+    return ConvertBatch(batchSource, batchOptions, timingsFile, debugDirectories);
+
+  std::string target = arguments[0];
+
+  auto pUsymResult = ElfInterface::CreateUsymFromFile(target.c_str(), batchOptions.threadCount, debugDirectories);
+
   if (!pUsymResult)
   {
     spdlog::error("Failed to load USYM format from ELF binary.");
@@ -29,5 +123,12 @@ int main(int argc, char* argv[])
   USYM& usym = pUsymResult.value();
 
   usym.SetSerializer(ISerializer::Type::kJson);
-  //auto result = usym.Serialize();
+
+  if (usym.Serialize(target.c_str()) != ISerializer::SerializeResult::kOk)
+  {
+    spdlog::error("Failed to write the USYM of {}.", target);
+    return 1;
+  }
+
+  return 0;
 }
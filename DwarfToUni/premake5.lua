@@ -8,6 +8,7 @@ project "DwarfToUni"
    includedirs 
    {
       "../Components",
+      "../Libraries/RECore",
       "../Vendor/spdlog/include",
    }
 
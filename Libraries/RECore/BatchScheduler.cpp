@@ -0,0 +1,168 @@
+#include "BatchScheduler.h"
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+std::vector<BatchTiming> RunBatch(std::span<const uint64_t> aSizes, const std::function<bool(size_t, size_t)>& aFunction, const BatchOptions& aOptions)
+{
+  std::vector<size_t> order(aSizes.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::stable_sort(order.begin(), order.end(), [&](size_t aLeft, size_t aRight) {
+    return aSizes[aLeft] > aSizes[aRight];
+  });
+
+  std::vector<BatchTiming> timings(aSizes.size());
+
+  std::mutex mutex{};
+  std::condition_variable bytesReleased{};
+  uint64_t bytesInFlight = 0;
+
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point batchStart = Clock::now();
+
+  // ParallelFor hands out the positions in order, which makes it take the largest input left.
+  ParallelFor(order.size(), [&](size_t aPosition, size_t aThreadIndex)
+  {
+    const size_t index = order[aPosition];
+    const uint64_t size = aSizes[index];
+
+    if (aOptions.maxBytesInFlight != 0)
+    {
+      std::unique_lock lock(mutex);
+      bytesReleased.wait(lock, [&] {
+        return bytesInFlight == 0 || bytesInFlight + size <= aOptions.maxBytesInFlight;
+      });
+      bytesInFlight += size;
+    }
+
+    BatchTiming& timing = timings[index];
+    timing.threadIndex = aThreadIndex;
+
+    const Clock::time_point start = Clock::now();
+    timing.succeeded = aFunction(index, aThreadIndex);
+    const Clock::time_point end = Clock::now();
+
+    timing.startSeconds = std::chrono::duration<double>(start - batchStart).count();
+    timing.seconds = std::chrono::duration<double>(end - start).count();
+
+    if (aOptions.maxBytesInFlight != 0)
+    {
+      {
+        std::lock_guard lock(mutex);
+        bytesInFlight -= size;
+      }
+      bytesReleased.notify_all();
+    }
+  }, aOptions.threadCount);
+
+  return timings;
+}
+
+std::vector<uint64_t> GetFileSizes(std::span<const std::string> aFileNames)
+{
+  std::vector<uint64_t> sizes(aFileNames.size());
+  for (size_t i = 0; i < aFileNames.size(); i++)
+  {
+    std::error_code error{};
+    const uintmax_t size = std::filesystem::file_size(aFileNames[i], error);
+    sizes[i] = error ? 0 : size;
+  }
+
+  return sizes;
+}
+
+bool ListFiles(const std::string& aDirectory, const std::function<bool(const std::string&)>& aFilter, std::vector<std::string>& aFileNames)
+{
+  std::error_code error{};
+  std::filesystem::recursive_directory_iterator it(aDirectory, std::filesystem::directory_options::skip_permission_denied, error);
+  if (error)
+    return false;
+
+  // A failed step ends the walk, entries that can't be looked at are skipped.
+  for (; it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+  {
+    std::error_code entryError{};
+    if (it->is_symlink(entryError) || !it->is_regular_file(entryError))
+      continue;
+
+    std::string fileName = it->path().string();
+    if (aFilter(fileName))
+      aFileNames.push_back(std::move(fileName));
+  }
+
+  return !error;
+}
+
+bool ReadFileList(const std::string& aManifest, std::vector<std::string>& aFileNames)
+{
+  std::ifstream file(aManifest);
+  if (!file)
+    return false;
+
+  std::string line{};
+  while (std::getline(file, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+
+    if (line.empty() || line.front() == '#')
+      continue;
+
+    aFileNames.push_back(std::move(line));
+  }
+
+  return true;
+}
+
+bool WriteBatchTimings(const std::string& aFileName, std::span<const std::string> aInputs, std::span<const uint64_t> aSizes, std::span<const BatchTiming> aTimings)
+{
+  std::ofstream file(aFileName);
+  if (!file)
+  {
+    spdlog::error("Failed to create {}.", aFileName);
+    return false;
+  }
+
+  file << "file,bytes,start_seconds,seconds,thread,succeeded\n";
+  for (size_t i = 0; i < aInputs.size(); i++)
+  {
+    const BatchTiming& timing = aTimings[i];
+    file << aInputs[i] << ',' << aSizes[i] << ',' << timing.startSeconds << ',' << timing.seconds << ',' << timing.threadIndex << ',' << timing.succeeded << '\n';
+  }
+
+  return true;
+}
+
+size_t LogBatchSummary(std::span<const std::string> aInputs, std::span<const uint64_t> aSizes, std::span<const BatchTiming> aTimings, size_t aSlowestCount)
+{
+  double wallSeconds = 0.0;
+  double totalSeconds = 0.0;
+  size_t failedCount = 0;
+  for (const BatchTiming& timing : aTimings)
+  {
+    wallSeconds = std::max(wallSeconds, timing.startSeconds + timing.seconds);
+    totalSeconds += timing.seconds;
+    failedCount += !timing.succeeded;
+  }
+
+  std::vector<size_t> slowest(aInputs.size());
+  std::iota(slowest.begin(), slowest.end(), size_t(0));
+  const size_t slowestCount = std::min(aSlowestCount, slowest.size());
+  std::partial_sort(slowest.begin(), slowest.begin() + slowestCount, slowest.end(), [&](size_t aLeft, size_t aRight) {
+    return aTimings[aLeft].seconds > aTimings[aRight].seconds;
+  });
+
+  for (size_t i = 0; i < slowestCount; i++)
+    spdlog::info("{:.3f} s, {} KiB: {}", aTimings[slowest[i]].seconds, aSizes[slowest[i]] / 1024, aInputs[slowest[i]]);
+
+  spdlog::info("Converted {} of {} files in {:.3f} s, {:.3f} s of work.", aInputs.size() - failedCount, aInputs.size(), wallSeconds, totalSeconds);
+  return failedCount;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+struct BatchOptions
+{
+  // 0 uses one thread per core.
+  size_t threadCount = 0;
+  // Upper bound for the summed size of the inputs being worked on at once, 0 for none. An
+  // input larger than the bound still runs, but alone.
+  uint64_t maxBytesInFlight = 0;
+};
+
+struct BatchTiming
+{
+  // Seconds from the start of the batch until the input started, and how long it took.
+  double startSeconds{};
+  double seconds{};
+  size_t threadIndex{};
+  bool succeeded{};
+};
+
+// Calls aFunction(index, threadIndex) once for every input of a batch, aSizes holding the size of
+// each, and returns the timing of each input by its index. The inputs are started largest first,
+// so no large one is left to run alone at the end while the other threads are idle, and any
+// thread that is done takes the next one. An input only starts once the inputs in flight leave
+// room for it under aOptions.maxBytesInFlight. aFunction returns whether the input succeeded.
+std::vector<BatchTiming> RunBatch(std::span<const uint64_t> aSizes, const std::function<bool(size_t, size_t)>& aFunction, const BatchOptions& aOptions = {});
+
+// Size of each file, 0 for those that can't be read.
+std::vector<uint64_t> GetFileSizes(std::span<const std::string> aFileNames);
+
+// Appends the regular files under aDirectory, subdirectories included, that aFilter accepts.
+// Symbolic links are skipped, so nothing is listed twice. Returns false if the directory can't be read.
+bool ListFiles(const std::string& aDirectory, const std::function<bool(const std::string&)>& aFilter, std::vector<std::string>& aFileNames);
+
+// Appends the file names of a manifest, one per line. Empty lines and lines starting with # are
+// skipped. Returns false if the manifest can't be read.
+bool ReadFileList(const std::string& aManifest, std::vector<std::string>& aFileNames);
+
+// Writes the timing of each input of a batch as CSV, one line per input with its file name and
+// size. Returns false if the file can't be created.
+bool WriteBatchTimings(const std::string& aFileName, std::span<const std::string> aInputs, std::span<const uint64_t> aSizes, std::span<const BatchTiming> aTimings);
+
+// Logs the aSlowestCount slowest inputs of a batch, then how many succeeded, the wall time and
+// the summed time of all inputs. Returns the number of inputs that failed.
+size_t LogBatchSummary(std::span<const std::string> aInputs, std::span<const uint64_t> aSizes, std::span<const BatchTiming> aTimings, size_t aSlowestCount = 10);
@@ -1,22 +1,35 @@
 #include "Buffer.h"
 
+#include <algorithm>
+#include <cstring>
+
 Buffer::Buffer(Buffer&& aBuffer) noexcept
 {
   pData = std::move(aBuffer.pData);
+  pMapping = std::move(aBuffer.pMapping);
   size = aBuffer.size;
 }
 
 Buffer& Buffer::operator=(Buffer&& aBuffer) noexcept
 {
   pData = std::move(aBuffer.pData);
+  pMapping = std::move(aBuffer.pMapping);
   size = aBuffer.size;
   return *this;
 }
 
+uint8_t* Buffer::GetData() const
+{
+  if (pMapping)
+    return pMapping->GetData();
+
+  return pData.get();
+}
+
 // don't abuse this, cause unique_ptr and all
 uint8_t* Buffer::GetDataAtPosition()
 {
-  return pData.get() + position;
+  return GetData() + position;
 }
 
 bool Buffer::IsOverflow(const size_t acLength) const
@@ -28,7 +41,9 @@ void Buffer::Resize(const size_t acNewSize)
 {
   std::unique_ptr<uint8_t[]> pNewData = std::make_unique<uint8_t[]>(acNewSize);
 
-  std::memcpy(pNewData.get(), pData.get(), size);
+  // Mapped buffers are read-only, so resizing turns them into an owned copy.
+  std::memcpy(pNewData.get(), GetData(), std::min(size, acNewSize));
   pData = std::move(pNewData);
+  pMapping = nullptr;
   size = acNewSize;
 }
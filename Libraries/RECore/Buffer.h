@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MappedFile.h"
+
 #include <cstdint>
 #include <memory>
 
@@ -12,8 +14,10 @@ public:
   Buffer& operator=(const Buffer& aBuffer) = default;
   Buffer& operator=(Buffer&& aBuffer) noexcept;
 
+  uint8_t* GetData() const;
   uint8_t* GetDataAtPosition();
 
+  bool IsMapped() const { return pMapping != nullptr; }
   bool IsOverflow(const size_t acLength) const;
 
   void Resize(const size_t acNewSize);
@@ -23,4 +27,6 @@ public:
   size_t size = 0;
   size_t position = 0;
   std::unique_ptr<uint8_t[]> pData{};
+  // When set, the contents are backed by a (read-only) file mapping instead of pData.
+  std::shared_ptr<const MappedFile> pMapping{};
 };
@@ -0,0 +1,55 @@
+#include "Crc32.h"
+
+#include <array>
+#include <cstring>
+
+namespace
+{
+  // Slicing by 8: table k gives the CRC of a byte followed by k zero bytes, so eight
+  // bytes are folded in per step instead of one.
+  using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+  constexpr Tables CreateTables()
+  {
+    Tables tables{};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+      tables[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      for (size_t k = 1; k < tables.size(); k++)
+        tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+    }
+
+    return tables;
+  }
+
+  constexpr Tables kTables = CreateTables();
+}
+
+uint32_t Crc32(const uint8_t* apData, size_t acSize, uint32_t aCrc)
+{
+  uint32_t crc = ~aCrc;
+
+  for (; acSize >= 8; acSize -= 8, apData += 8)
+  {
+    uint32_t low = 0;
+    uint32_t high = 0;
+    std::memcpy(&low, apData, sizeof(low));
+    std::memcpy(&high, apData + 4, sizeof(high));
+    low ^= crc;
+
+    crc = kTables[7][low & 0xFF] ^ kTables[6][(low >> 8) & 0xFF] ^ kTables[5][(low >> 16) & 0xFF] ^ kTables[4][low >> 24] ^
+      kTables[3][high & 0xFF] ^ kTables[2][(high >> 8) & 0xFF] ^ kTables[1][(high >> 16) & 0xFF] ^ kTables[0][high >> 24];
+  }
+
+  for (; acSize != 0; acSize--)
+    crc = (crc >> 8) ^ kTables[0][(crc ^ *apData++) & 0xFF];
+
+  return ~crc;
+}
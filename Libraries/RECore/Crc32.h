@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 as used by zlib, gzip and .gnu_debuglink (IEEE 802.3 polynomial, reflected).
+// aCrc continues a previous result, so large inputs can be checksummed piece by piece.
+uint32_t Crc32(const uint8_t* apData, size_t acSize, uint32_t aCrc = 0);
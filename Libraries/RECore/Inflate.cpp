@@ -0,0 +1,478 @@
+#include "Inflate.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+  constexpr unsigned kMaxBits = 15;
+  constexpr unsigned kLiteralLengthCodes = 288;
+  constexpr unsigned kDistanceCodes = 30;
+  constexpr unsigned kEndOfBlock = 256;
+
+  // Codes up to kFastBits long are decoded with a single table lookup, the rare longer ones
+  // code length by code length.
+  constexpr unsigned kFastBits = 10;
+  constexpr unsigned kFastLengthShift = 9;
+
+  constexpr uint16_t kLengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+  constexpr uint8_t kLengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+  constexpr uint16_t kDistanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+  constexpr uint8_t kDistanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+  constexpr uint8_t kCodeLengthOrder[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+  class BitReader
+  {
+  public:
+    BitReader(const uint8_t* apData, size_t acSize)
+      : m_pData(apData)
+      , m_pEnd(apData + acSize)
+    {}
+
+    // Tops the buffer up with as many whole bytes as fit. Never reads past the end, so near
+    // the end of the input the buffer can hold fewer bits than asked for later.
+    void Refill()
+    {
+      if (m_pEnd - m_pData >= 8)
+      {
+        uint64_t value = 0;
+        std::memcpy(&value, m_pData, sizeof(value));
+        m_bits |= value << m_count;
+        m_pData += (63 - m_count) >> 3;
+        m_count |= 56;
+        return;
+      }
+
+      while (m_count <= 56 && m_pData != m_pEnd)
+      {
+        m_bits |= static_cast<uint64_t>(*m_pData++) << m_count;
+        m_count += 8;
+      }
+    }
+
+    bool Get(unsigned aCount, uint32_t& aValue)
+    {
+      if (m_count < aCount)
+      {
+        Refill();
+        if (m_count < aCount)
+          return false;
+      }
+
+      aValue = static_cast<uint32_t>(m_bits & ((uint64_t(1) << aCount) - 1));
+      Consume(aCount);
+      return true;
+    }
+
+    uint64_t Peek() const { return m_bits; }
+    unsigned GetCount() const { return m_count; }
+
+    void Consume(unsigned aCount)
+    {
+      m_bits >>= aCount;
+      m_count -= aCount;
+    }
+
+    // Drops the bits up to the next byte boundary and gives the whole bytes still buffered
+    // back to the input, for reading a stored block directly.
+    void AlignToByte()
+    {
+      Consume(m_count & 7);
+      m_pData -= m_count >> 3;
+      m_bits = 0;
+      m_count = 0;
+    }
+
+    const uint8_t* GetData() const { return m_pData; }
+    size_t GetRemaining() const { return m_pEnd - m_pData; }
+    void Skip(size_t aCount) { m_pData += aCount; }
+
+  private:
+    const uint8_t* m_pData;
+    const uint8_t* m_pEnd;
+    uint64_t m_bits{};
+    unsigned m_count{};
+  };
+
+  struct Huffman
+  {
+    // Builds the canonical code from the code length of every symbol. Incomplete codes are
+    // allowed, as deflate uses them for a single distance code; over subscribed ones are not.
+    bool Build(const uint8_t* apLengths, unsigned aCount)
+    {
+      std::memset(counts, 0, sizeof(counts));
+      for (unsigned symbol = 0; symbol < aCount; symbol++)
+        counts[apLengths[symbol]]++;
+
+      int left = 1;
+      for (unsigned length = 1; length <= kMaxBits; length++)
+      {
+        left = (left << 1) - counts[length];
+        if (left < 0)
+          return false;
+      }
+
+      uint16_t offsets[kMaxBits + 1]{};
+      for (unsigned length = 1; length < kMaxBits; length++)
+        offsets[length + 1] = offsets[length] + counts[length];
+
+      for (unsigned symbol = 0; symbol < aCount; symbol++)
+      {
+        if (apLengths[symbol] != 0)
+          symbols[offsets[apLengths[symbol]]++] = static_cast<uint16_t>(symbol);
+      }
+
+      // Deflate sends codes starting with their most significant bit, so the table is indexed
+      // by the bit reversed code, with every combination of the bits that follow it.
+      std::memset(fast, 0, sizeof(fast));
+      unsigned code = 0;
+      unsigned index = 0;
+      for (unsigned length = 1; length <= kFastBits; length++, code <<= 1)
+      {
+        for (unsigned i = 0; i < counts[length]; i++, code++, index++)
+        {
+          unsigned reversed = 0;
+          for (unsigned bit = 0; bit < length; bit++)
+            reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+
+          const uint16_t entry = static_cast<uint16_t>(length << kFastLengthShift | symbols[index]);
+          for (unsigned slot = reversed; slot < (1u << kFastBits); slot += 1u << length)
+            fast[slot] = entry;
+        }
+      }
+
+      return true;
+    }
+
+    uint16_t counts[kMaxBits + 1];
+    uint16_t symbols[kLiteralLengthCodes];
+    // Code length << kFastLengthShift | symbol, 0 where the code is longer than kFastBits.
+    uint16_t fast[1 << kFastBits];
+  };
+
+  bool Decode(BitReader& aReader, const Huffman& aHuffman, unsigned& aSymbol)
+  {
+    if (aReader.GetCount() < kMaxBits)
+      aReader.Refill();
+
+    const uint16_t entry = aHuffman.fast[aReader.Peek() & ((1u << kFastBits) - 1)];
+    const unsigned length = entry >> kFastLengthShift;
+    if (length != 0 && length <= aReader.GetCount())
+    {
+      aReader.Consume(length);
+      aSymbol = entry & ((1u << kFastLengthShift) - 1);
+      return true;
+    }
+
+    // Walks the canonical code one bit at a time: the codes of every length are consecutive
+    // numbers, starting where the previous length left off.
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned bits = 1; bits <= kMaxBits; bits++)
+    {
+      uint32_t bit = 0;
+      if (!aReader.Get(1, bit))
+        return false;
+
+      code |= bit;
+      const int count = aHuffman.counts[bits];
+      if (code - count < first)
+      {
+        aSymbol = aHuffman.symbols[index + (code - first)];
+        return true;
+      }
+
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+
+    return false;
+  }
+
+  class Inflater
+  {
+  public:
+    Inflater(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize)
+      : m_reader(apSource, acSize)
+      , m_pStart(apDestination)
+      , m_pOutput(apDestination)
+      , m_pEnd(apDestination + acDestinationSize)
+    {}
+
+    bool Run()
+    {
+      uint32_t last = 0;
+      do
+      {
+        uint32_t type = 0;
+        if (!m_reader.Get(1, last) || !m_reader.Get(2, type))
+          return false;
+
+        bool result = false;
+        if (type == 0)
+          result = Stored();
+        else if (type == 1)
+          result = Fixed();
+        else if (type == 2)
+          result = Dynamic();
+
+        if (!result)
+          return false;
+      } while (!last);
+
+      return m_pOutput == m_pEnd;
+    }
+
+    // Whatever follows the deflate stream, the zlib checksum, starts at the next byte.
+    const uint8_t* GetTrailer()
+    {
+      m_reader.AlignToByte();
+      return m_reader.GetData();
+    }
+
+    size_t GetTrailerSize()
+    {
+      m_reader.AlignToByte();
+      return m_reader.GetRemaining();
+    }
+
+  private:
+    bool Stored()
+    {
+      m_reader.AlignToByte();
+
+      uint32_t length = 0;
+      uint32_t complement = 0;
+      if (!m_reader.Get(16, length) || !m_reader.Get(16, complement) || length != (~complement & 0xFFFF))
+        return false;
+
+      m_reader.AlignToByte();
+      if (length > m_reader.GetRemaining() || length > static_cast<size_t>(m_pEnd - m_pOutput))
+        return false;
+
+      std::memcpy(m_pOutput, m_reader.GetData(), length);
+      m_reader.Skip(length);
+      m_pOutput += length;
+      return true;
+    }
+
+    bool Fixed()
+    {
+      struct FixedCodes
+      {
+        FixedCodes()
+        {
+          uint8_t lengths[kLiteralLengthCodes];
+          std::memset(lengths, 8, 144);
+          std::memset(lengths + 144, 9, 256 - 144);
+          std::memset(lengths + 256, 7, 280 - 256);
+          std::memset(lengths + 280, 8, kLiteralLengthCodes - 280);
+          literalLength.Build(lengths, kLiteralLengthCodes);
+
+          std::memset(lengths, 5, kDistanceCodes);
+          distance.Build(lengths, kDistanceCodes);
+        }
+
+        Huffman literalLength;
+        Huffman distance;
+      };
+
+      static const FixedCodes s_codes{};
+      return Codes(s_codes.literalLength, s_codes.distance);
+    }
+
+    bool Dynamic()
+    {
+      uint32_t literalLengthCount = 0;
+      uint32_t distanceCount = 0;
+      uint32_t codeLengthCount = 0;
+      if (!m_reader.Get(5, literalLengthCount) || !m_reader.Get(5, distanceCount) || !m_reader.Get(4, codeLengthCount))
+        return false;
+
+      literalLengthCount += 257;
+      distanceCount += 1;
+      codeLengthCount += 4;
+      if (literalLengthCount > 286 || distanceCount > kDistanceCodes)
+        return false;
+
+      uint8_t lengths[kLiteralLengthCodes + kDistanceCodes]{};
+      for (unsigned i = 0; i < codeLengthCount; i++)
+      {
+        uint32_t length = 0;
+        if (!m_reader.Get(3, length))
+          return false;
+        lengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(length);
+      }
+
+      Huffman codeLength;
+      if (!codeLength.Build(lengths, 19))
+        return false;
+
+      // The code lengths of both codes are sent as one run length encoded list.
+      const unsigned total = literalLengthCount + distanceCount;
+      for (unsigned index = 0; index < total;)
+      {
+        unsigned symbol = 0;
+        if (!Decode(m_reader, codeLength, symbol))
+          return false;
+
+        if (symbol < 16)
+        {
+          lengths[index++] = static_cast<uint8_t>(symbol);
+          continue;
+        }
+
+        uint8_t length = 0;
+        uint32_t repeat = 0;
+        if (symbol == 16)
+        {
+          if (index == 0 || !m_reader.Get(2, repeat))
+            return false;
+          length = lengths[index - 1];
+          repeat += 3;
+        }
+        else if (symbol == 17)
+        {
+          if (!m_reader.Get(3, repeat))
+            return false;
+          repeat += 3;
+        }
+        else
+        {
+          if (!m_reader.Get(7, repeat))
+            return false;
+          repeat += 11;
+        }
+
+        if (index + repeat > total)
+          return false;
+        std::memset(lengths + index, length, repeat);
+        index += repeat;
+      }
+
+      // Without an end of block code the block could never end.
+      if (lengths[kEndOfBlock] == 0)
+        return false;
+
+      Huffman literalLength;
+      Huffman distance;
+      if (!literalLength.Build(lengths, literalLengthCount) || !distance.Build(lengths + literalLengthCount, distanceCount))
+        return false;
+
+      return Codes(literalLength, distance);
+    }
+
+    bool Codes(const Huffman& aLiteralLength, const Huffman& aDistance)
+    {
+      for (;;)
+      {
+        unsigned symbol = 0;
+        if (!Decode(m_reader, aLiteralLength, symbol))
+          return false;
+
+        if (symbol < kEndOfBlock)
+        {
+          if (m_pOutput == m_pEnd)
+            return false;
+          *m_pOutput++ = static_cast<uint8_t>(symbol);
+          continue;
+        }
+
+        if (symbol == kEndOfBlock)
+          return true;
+
+        symbol -= kEndOfBlock + 1;
+        if (symbol >= std::size(kLengthBase))
+          return false;
+
+        uint32_t extra = 0;
+        if (!m_reader.Get(kLengthExtra[symbol], extra))
+          return false;
+        const size_t length = kLengthBase[symbol] + extra;
+
+        if (!Decode(m_reader, aDistance, symbol) || symbol >= kDistanceCodes || !m_reader.Get(kDistanceExtra[symbol], extra))
+          return false;
+        const size_t distance = kDistanceBase[symbol] + extra;
+
+        if (distance > static_cast<size_t>(m_pOutput - m_pStart) || length > static_cast<size_t>(m_pEnd - m_pOutput))
+          return false;
+
+        const uint8_t* pMatch = m_pOutput - distance;
+        if (distance >= length)
+        {
+          std::memcpy(m_pOutput, pMatch, length);
+          m_pOutput += length;
+        }
+        else
+        {
+          // The match overlaps the bytes it produces, e.g. a run of one repeated byte.
+          for (size_t i = 0; i < length; i++)
+            *m_pOutput++ = *pMatch++;
+        }
+      }
+    }
+
+    BitReader m_reader;
+    uint8_t* const m_pStart;
+    uint8_t* m_pOutput;
+    uint8_t* const m_pEnd;
+  };
+}
+
+namespace Inflate
+{
+  bool Decompress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize)
+  {
+    Inflater inflater(apSource, acSize, apDestination, acDestinationSize);
+    return inflater.Run();
+  }
+
+  bool DecompressZlib(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize)
+  {
+    // Header: deflate with a window of at most 32 KiB, no preset dictionary, and a check
+    // value making the two bytes a multiple of 31.
+    if (acSize < 2)
+      return false;
+
+    const uint8_t method = apSource[0];
+    const uint8_t flags = apSource[1];
+    if ((method & 0x0F) != 8 || (method >> 4) > 7 || (flags & 0x20) != 0 || (method << 8 | flags) % 31 != 0)
+      return false;
+
+    Inflater inflater(apSource + 2, acSize - 2, apDestination, acDestinationSize);
+    if (!inflater.Run() || inflater.GetTrailerSize() < 4)
+      return false;
+
+    const uint8_t* pTrailer = inflater.GetTrailer();
+    const uint32_t expected = static_cast<uint32_t>(pTrailer[0]) << 24 | pTrailer[1] << 16 | pTrailer[2] << 8 | pTrailer[3];
+    return Adler32(apDestination, acDestinationSize) == expected;
+  }
+
+  uint32_t Adler32(const uint8_t* apData, size_t acSize, uint32_t aAdler)
+  {
+    constexpr uint32_t kModulo = 65521;
+    // The most bytes that can be summed before the second sum could overflow 32 bits.
+    constexpr size_t kMaxRun = 5552;
+
+    uint32_t a = aAdler & 0xFFFF;
+    uint32_t b = aAdler >> 16;
+    while (acSize != 0)
+    {
+      const size_t run = acSize < kMaxRun ? acSize : kMaxRun;
+      for (size_t i = 0; i < run; i++)
+      {
+        a += apData[i];
+        b += a;
+      }
+
+      apData += run;
+      acSize -= run;
+      a %= kModulo;
+      b %= kModulo;
+    }
+
+    return b << 16 | a;
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decompression of deflate (RFC 1951) and zlib (RFC 1950) streams, the formats of
+// compressed ELF sections, with no external dependency.
+//
+// The output size has to be known up front, which it always is for the formats this is
+// used for. Malformed input is rejected without reading or writing out of bounds.
+namespace Inflate
+{
+  // Decompresses a raw deflate stream into exactly acDestinationSize bytes.
+  bool Decompress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize);
+
+  // Decompresses a zlib stream, a deflate stream with a header and an Adler-32 checksum,
+  // into exactly acDestinationSize bytes.
+  bool DecompressZlib(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize);
+
+  uint32_t Adler32(const uint8_t* apData, size_t acSize, uint32_t aAdler = 1);
+}
@@ -0,0 +1,176 @@
+#include "Lz.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+  constexpr size_t kHashBits = 14;
+  constexpr uint8_t kNibbleMax = 15;
+
+  uint32_t Load32(const uint8_t* apData)
+  {
+    uint32_t value = 0;
+    std::memcpy(&value, apData, sizeof(value));
+    return value;
+  }
+
+  uint32_t Hash(uint32_t aValue)
+  {
+    return (aValue * 2654435761u) >> (32 - kHashBits);
+  }
+
+  uint8_t* WriteLengthContinuation(uint8_t* apOutput, size_t aLength)
+  {
+    for (aLength -= kNibbleMax; aLength >= 255; aLength -= 255)
+      *apOutput++ = 255;
+    *apOutput++ = static_cast<uint8_t>(aLength);
+    return apOutput;
+  }
+
+  uint8_t* WriteSequence(uint8_t* apOutput, const uint8_t* apLiterals, size_t aLiteralCount, size_t aOffset, size_t aMatchLength)
+  {
+    const size_t matchCode = aMatchLength == 0 ? 0 : aMatchLength - Lz::kMinMatch;
+
+    uint8_t* pToken = apOutput++;
+    *pToken = static_cast<uint8_t>(std::min<size_t>(aLiteralCount, kNibbleMax) << 4 | std::min<size_t>(matchCode, kNibbleMax));
+
+    if (aLiteralCount >= kNibbleMax)
+      apOutput = WriteLengthContinuation(apOutput, aLiteralCount);
+
+    std::memcpy(apOutput, apLiterals, aLiteralCount);
+    apOutput += aLiteralCount;
+
+    if (aMatchLength != 0)
+    {
+      *apOutput++ = static_cast<uint8_t>(aOffset);
+      *apOutput++ = static_cast<uint8_t>(aOffset >> 8);
+
+      if (matchCode >= kNibbleMax)
+        apOutput = WriteLengthContinuation(apOutput, matchCode);
+    }
+
+    return apOutput;
+  }
+
+  bool ReadLengthContinuation(const uint8_t*& apInput, const uint8_t* apEnd, size_t& aLength)
+  {
+    uint8_t value = 0;
+    do
+    {
+      if (apInput == apEnd)
+        return false;
+
+      value = *apInput++;
+      aLength += value;
+    } while (value == 255);
+
+    return true;
+  }
+}
+
+namespace Lz
+{
+  size_t Compress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination)
+  {
+    // Position of the last 4 byte sequence seen, by hash. Colliding entries are caught by
+    // comparing the bytes.
+    const auto pTable = std::make_unique<uint32_t[]>(size_t(1) << kHashBits);
+
+    const uint8_t* pInput = apSource;
+    const uint8_t* pAnchor = apSource;
+    const uint8_t* const pEnd = apSource + acSize;
+    uint8_t* pOutput = apDestination;
+
+    if (acSize >= kMinMatch)
+    {
+      const uint8_t* const pMatchLimit = pEnd - kMinMatch;
+
+      while (pInput <= pMatchLimit)
+      {
+        const uint32_t sequence = Load32(pInput);
+        uint32_t& entry = pTable[Hash(sequence)];
+        const uint8_t* pCandidate = apSource + entry;
+        entry = static_cast<uint32_t>(pInput - apSource);
+
+        if (pCandidate >= pInput || static_cast<size_t>(pInput - pCandidate) > kMaxOffset || Load32(pCandidate) != sequence)
+        {
+          // Skip ahead faster the longer nothing matched, so incompressible data goes quickly.
+          pInput += 1 + (static_cast<size_t>(pInput - pAnchor) >> 6);
+          continue;
+        }
+
+        size_t matchLength = kMinMatch;
+        while (pInput + matchLength < pEnd && pInput[matchLength] == pCandidate[matchLength])
+          matchLength++;
+
+        pOutput = WriteSequence(pOutput, pAnchor, pInput - pAnchor, pInput - pCandidate, matchLength);
+        pInput += matchLength;
+        pAnchor = pInput;
+      }
+    }
+
+    if (pAnchor != pEnd)
+      pOutput = WriteSequence(pOutput, pAnchor, pEnd - pAnchor, 0, 0);
+
+    return pOutput - apDestination;
+  }
+
+  bool Decompress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize)
+  {
+    const uint8_t* pInput = apSource;
+    const uint8_t* const pInputEnd = apSource + acSize;
+    uint8_t* pOutput = apDestination;
+    uint8_t* const pOutputEnd = apDestination + acDestinationSize;
+
+    while (pInput != pInputEnd)
+    {
+      const uint8_t token = *pInput++;
+
+      size_t literalCount = token >> 4;
+      if (literalCount == kNibbleMax && !ReadLengthContinuation(pInput, pInputEnd, literalCount))
+        return false;
+
+      if (literalCount > static_cast<size_t>(pInputEnd - pInput) || literalCount > static_cast<size_t>(pOutputEnd - pOutput))
+        return false;
+
+      std::memcpy(pOutput, pInput, literalCount);
+      pInput += literalCount;
+      pOutput += literalCount;
+
+      // Only the last sequence has no match.
+      if (pInput == pInputEnd)
+        break;
+
+      if (pInputEnd - pInput < 2)
+        return false;
+
+      const size_t offset = pInput[0] | static_cast<size_t>(pInput[1]) << 8;
+      pInput += 2;
+
+      size_t matchLength = token & kNibbleMax;
+      if (matchLength == kNibbleMax && !ReadLengthContinuation(pInput, pInputEnd, matchLength))
+        return false;
+      matchLength += kMinMatch;
+
+      if (offset == 0 || offset > static_cast<size_t>(pOutput - apDestination) || matchLength > static_cast<size_t>(pOutputEnd - pOutput))
+        return false;
+
+      const uint8_t* pMatch = pOutput - offset;
+      if (offset >= matchLength)
+      {
+        std::memcpy(pOutput, pMatch, matchLength);
+        pOutput += matchLength;
+      }
+      else
+      {
+        // The match overlaps the bytes it produces, e.g. a run of one repeated byte.
+        for (size_t i = 0; i < matchLength; i++)
+          *pOutput++ = *pMatch++;
+      }
+    }
+
+    return pOutput == pOutputEnd;
+  }
+}
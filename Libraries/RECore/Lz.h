@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A small LZ77 codec in the style of LZ4, fast to decode and with no external dependency.
+//
+// The compressed data is a list of sequences. Each starts with a token byte, whose high
+// nibble is the number of literals and whose low nibble is the match length minus
+// kMinMatch; a nibble of 15 is continued by bytes that are added to it, up to the first one
+// below 255. The literals follow the token, then the match as a 2 byte little endian
+// offset back into the output and the length continuation, if any. The last sequence
+// may end after its literals, without a match.
+namespace Lz
+{
+  constexpr size_t kMinMatch = 4;
+  constexpr size_t kMaxOffset = 0xFFFF;
+
+  // Upper bound of the compressed size of acSize bytes, for sizing the output buffer.
+  constexpr size_t GetMaxCompressedSize(size_t acSize) { return acSize + acSize / 255 + 16; }
+
+  // Compresses acSize bytes into apDestination, which must hold GetMaxCompressedSize(acSize)
+  // bytes. Returns the compressed size.
+  size_t Compress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination);
+
+  // Decompresses into exactly acDestinationSize bytes. Returns false if the data is
+  // malformed or does not decompress to that size; never reads or writes out of bounds.
+  bool Decompress(const uint8_t* apSource, size_t acSize, uint8_t* apDestination, size_t acDestinationSize);
+}
@@ -0,0 +1,169 @@
+#include "MappedFile.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& acFilename)
+{
+  HANDLE file = CreateFileA(acFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    spdlog::error("Failed to open file {} for mapping", acFilename);
+    return nullptr;
+  }
+
+  auto pFile = std::make_shared<MappedFile>();
+  pFile->pFileHandle = file;
+
+  LARGE_INTEGER fileSize{};
+  if (!GetFileSizeEx(file, &fileSize))
+  {
+    spdlog::error("Failed to get size of file {}", acFilename);
+    return nullptr;
+  }
+
+  pFile->size = static_cast<size_t>(fileSize.QuadPart);
+
+  // Zero sized files cannot be mapped, but are still valid (empty) files.
+  if (pFile->size == 0)
+    return pFile;
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping)
+  {
+    spdlog::error("Failed to create file mapping for {}", acFilename);
+    return nullptr;
+  }
+
+  pFile->pMappingHandle = mapping;
+
+  pFile->pData = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!pFile->pData)
+  {
+    spdlog::error("Failed to map view of file {}", acFilename);
+    return nullptr;
+  }
+
+  return pFile;
+}
+
+MappedFile::~MappedFile()
+{
+  if (pData)
+    UnmapViewOfFile(pData);
+  if (pMappingHandle)
+    CloseHandle(pMappingHandle);
+  if (pFileHandle)
+    CloseHandle(pFileHandle);
+}
+
+void MappedFile::Advise(AccessHint aHint, size_t aOffset, size_t aLength) const
+{
+  // The Windows memory manager does its own read-ahead; only prefetching is worth forwarding.
+  if (aHint != AccessHint::kWillNeed || !pData || aOffset >= size)
+    return;
+
+  if (aLength == 0 || aOffset + aLength > size)
+    aLength = size - aOffset;
+
+  WIN32_MEMORY_RANGE_ENTRY range{ pData + aOffset, aLength };
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& acFilename)
+{
+  const int fd = open(acFilename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    spdlog::error("Failed to open file {} for mapping", acFilename);
+    return nullptr;
+  }
+
+  struct stat fileStats{};
+  if (fstat(fd, &fileStats) != 0)
+  {
+    spdlog::error("Failed to get size of file {}", acFilename);
+    close(fd);
+    return nullptr;
+  }
+
+  auto pFile = std::make_shared<MappedFile>();
+  pFile->size = static_cast<size_t>(fileStats.st_size);
+
+  // Zero sized files cannot be mapped, but are still valid (empty) files.
+  if (pFile->size == 0)
+  {
+    close(fd);
+    return pFile;
+  }
+
+  void* pMapping = mmap(nullptr, pFile->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // The mapping keeps its own reference to the file.
+  close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    spdlog::error("Failed to map file {}", acFilename);
+    return nullptr;
+  }
+
+  pFile->pData = static_cast<uint8_t*>(pMapping);
+
+  return pFile;
+}
+
+MappedFile::~MappedFile()
+{
+  if (pData)
+    munmap(pData, size);
+}
+
+void MappedFile::Advise(AccessHint aHint, size_t aOffset, size_t aLength) const
+{
+  if (!pData || aOffset >= size)
+    return;
+
+  if (aLength == 0 || aOffset + aLength > size)
+    aLength = size - aOffset;
+
+  // madvise() requires a page aligned start address.
+  static const size_t s_pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t alignedOffset = aOffset & ~(s_pageSize - 1);
+  aLength += aOffset - alignedOffset;
+
+  int advice = MADV_NORMAL;
+  switch (aHint)
+  {
+  case AccessHint::kSequential:
+    advice = MADV_SEQUENTIAL;
+    break;
+  case AccessHint::kRandom:
+    advice = MADV_RANDOM;
+    break;
+  case AccessHint::kWillNeed:
+    advice = MADV_WILLNEED;
+    break;
+  case AccessHint::kDontNeed:
+    advice = MADV_DONTNEED;
+    break;
+  default:
+    advice = MADV_NORMAL;
+  }
+
+  madvise(pData + alignedOffset, aLength, advice);
+}
+
+#endif
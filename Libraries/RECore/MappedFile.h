@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Read-only view of a file mapped into the address space.
+// Pages are only faulted in when they are touched, and every mapping of the
+// same file shares the OS page cache.
+class MappedFile
+{
+public:
+  enum class AccessHint : uint8_t
+  {
+    kNormal = 0,
+    kSequential,
+    kRandom,
+    kWillNeed,
+    kDontNeed,
+  };
+
+  static std::shared_ptr<MappedFile> Open(const std::string& acFilename);
+
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  // Passing a length of 0 applies the hint to everything after aOffset.
+  void Advise(AccessHint aHint, size_t aOffset = 0, size_t aLength = 0) const;
+
+  uint8_t* GetData() const { return pData; }
+  size_t GetSize() const { return size; }
+
+private:
+  uint8_t* pData = nullptr;
+  size_t size = 0;
+
+#ifdef _WIN32
+  void* pFileHandle = nullptr;
+  void* pMappingHandle = nullptr;
+#endif
+};
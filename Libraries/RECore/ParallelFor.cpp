@@ -0,0 +1,50 @@
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+size_t GetDefaultThreadCount()
+{
+  const size_t hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads == 0 ? 1 : hardwareThreads;
+}
+
+size_t ParallelFor(size_t aCount, const std::function<void(size_t, size_t)>& aFunction, size_t aThreadCount)
+{
+  if (aCount == 0)
+    return 0;
+
+  if (aThreadCount == 0)
+    aThreadCount = GetDefaultThreadCount();
+
+  aThreadCount = std::min(aThreadCount, aCount);
+
+  if (aThreadCount == 1)
+  {
+    for (size_t i = 0; i < aCount; i++)
+      aFunction(i, 0);
+    return 1;
+  }
+
+  std::atomic<size_t> nextIndex{ 0 };
+
+  auto work = [&](size_t aThreadIndex)
+  {
+    for (size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed); i < aCount; i = nextIndex.fetch_add(1, std::memory_order_relaxed))
+      aFunction(i, aThreadIndex);
+  };
+
+  std::vector<std::thread> threads{};
+  threads.reserve(aThreadCount - 1);
+  for (size_t i = 1; i < aThreadCount; i++)
+    threads.emplace_back(work, i);
+
+  work(0);
+
+  for (auto& thread : threads)
+    thread.join();
+
+  return aThreadCount;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Number of threads to use when the caller passes 0.
+size_t GetDefaultThreadCount();
+
+// Calls aFunction(index, threadIndex) for every index in [0, aCount), distributing the indices
+// dynamically over aThreadCount threads (the calling thread included). threadIndex is
+// in [0, thread count) and can be used to index per-thread state.
+// Returns the number of threads that were used.
+size_t ParallelFor(size_t aCount, const std::function<void(size_t, size_t)>& aFunction, size_t aThreadCount = 0);
@@ -1,5 +1,6 @@
 #include "Reader.h"
 
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <spdlog/spdlog.h>
@@ -22,12 +23,42 @@ bool Reader::LoadFromFile(const std::string& acFilename)
   }
 
   pData = std::make_unique<uint8_t[]>(size);
+  pMapping = nullptr;
+  position = 0;
 
   file.read(reinterpret_cast<char*>(pData.get()), size);
 
   return true;
 }
 
+bool Reader::MapFromFile(const std::string& acFilename, MappedFile::AccessHint aHint)
+{
+  if (!std::filesystem::exists(acFilename))
+  {
+    spdlog::error("File does not exist: {}, current directory: {}", acFilename, std::filesystem::current_path().string());
+    return false;
+  }
+
+  auto pFile = MappedFile::Open(acFilename);
+  if (!pFile)
+    return false;
+
+  pFile->Advise(aHint);
+
+  pData = nullptr;
+  pMapping = std::move(pFile);
+  size = pMapping->GetSize();
+  position = 0;
+
+  return true;
+}
+
+void Reader::Advise(MappedFile::AccessHint aHint, size_t aOffset, size_t aLength) const
+{
+  if (pMapping)
+    pMapping->Advise(aHint, aOffset, aLength);
+}
+
 bool Reader::ReadImpl(void* apDestination, const size_t acLength, bool aPeak)
 {
   if (IsOverflow(acLength))
@@ -55,3 +86,20 @@ std::string Reader::ReadString(const size_t aLength)
   Advance(string.size());
   return string;
 }
+
+bool Reader::ReadStringView(std::string_view& aDestination)
+{
+  if (position >= size)
+    return false;
+
+  const char* pStart = reinterpret_cast<const char*>(GetDataAtPosition());
+  const void* pTerminator = std::memchr(pStart, '\0', size - position);
+  if (!pTerminator)
+    return false;
+
+  const size_t length = static_cast<const char*>(pTerminator) - pStart;
+  aDestination = std::string_view(pStart, length);
+  Advance(length + 1);
+
+  return true;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include "Buffer.h"
 
@@ -10,6 +11,10 @@ public:
   Reader() = default;
 
   bool LoadFromFile(const std::string& acFilename);
+  // Maps the file instead of copying it, so only the pages that are actually read get loaded.
+  bool MapFromFile(const std::string& acFilename, MappedFile::AccessHint aHint = MappedFile::AccessHint::kNormal);
+  // No-op for buffers that were not mapped.
+  void Advise(MappedFile::AccessHint aHint, size_t aOffset = 0, size_t aLength = 0) const;
 
   // This only works on simple types with no pointers
   template <class T>
@@ -20,4 +25,7 @@ public:
   bool ReadImpl(void* apDestination, const size_t acLength, bool aPeak = false);
   std::string ReadString();
   std::string ReadString(const size_t aLength);
+  // Reads a NUL terminated string without copying it, the view points into the buffer.
+  // Fails without advancing if there is no terminator before the end of the buffer.
+  bool ReadStringView(std::string_view& aDestination);
 };
@@ -0,0 +1,232 @@
+#include "StreamWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+  std::FILE* OpenFile(const std::string& acFilename)
+  {
+#ifdef _WIN32
+    std::FILE* pFile = nullptr;
+    if (fopen_s(&pFile, acFilename.c_str(), "wb") != 0)
+      return nullptr;
+#else
+    std::FILE* pFile = std::fopen(acFilename.c_str(), "wb");
+    if (!pFile)
+      return nullptr;
+#endif
+
+    // The blocks are already large, buffering them again would only add a copy.
+    std::setvbuf(pFile, nullptr, _IONBF, 0);
+    return pFile;
+  }
+
+  bool Seek(std::FILE* apFile, uint64_t aOffset)
+  {
+#ifdef _WIN32
+    return _fseeki64(apFile, static_cast<int64_t>(aOffset), SEEK_SET) == 0;
+#else
+    return fseeko(apFile, static_cast<off_t>(aOffset), SEEK_SET) == 0;
+#endif
+  }
+}
+
+StreamWriter::StreamWriter(size_t acBlockSize)
+  : blockSize(std::max<size_t>(acBlockSize, 1))
+{
+}
+
+StreamWriter::~StreamWriter()
+{
+  Close();
+}
+
+bool StreamWriter::Open(const std::string& acFilename)
+{
+  Close();
+
+  pFile = OpenFile(acFilename);
+  if (!pFile)
+  {
+    spdlog::error("Failed to open file {} for writing", acFilename);
+    return false;
+  }
+
+  used = 0;
+  blockOffset = 0;
+  isClosing = false;
+  isFailed = false;
+
+  if (!pBlock)
+  {
+    pBlock = std::make_unique_for_overwrite<uint8_t[]>(blockSize);
+    blockCount = 1 + freeBlocks.size();
+  }
+
+  thread = std::thread(&StreamWriter::Run, this);
+
+  return true;
+}
+
+bool StreamWriter::Close()
+{
+  if (!pFile)
+    return false;
+
+  if (used != 0)
+    SubmitBlock();
+
+  {
+    std::scoped_lock lock(mutex);
+    isClosing = true;
+  }
+  condition.notify_all();
+  thread.join();
+
+  if (std::fclose(pFile) != 0)
+    isFailed = true;
+
+  pFile = nullptr;
+
+  if (isFailed)
+    spdlog::error("Failed to write to file");
+
+  return !isFailed;
+}
+
+bool StreamWriter::WriteImpl(const void* apSource, const size_t acLength)
+{
+  const uint8_t* pSource = static_cast<const uint8_t*>(apSource);
+  size_t remaining = acLength;
+
+  while (remaining != 0)
+  {
+    if (used == blockSize)
+      SubmitBlock();
+
+    const size_t count = std::min(remaining, blockSize - used);
+    std::memcpy(pBlock.get() + used, pSource, count);
+
+    used += count;
+    pSource += count;
+    remaining -= count;
+  }
+
+  return !isFailed;
+}
+
+bool StreamWriter::WriteString(std::string_view aSource)
+{
+  if (!aSource.empty() && !WriteImpl(aSource.data(), aSource.size()))
+    return false;
+
+  const char terminator = '\0';
+  return WriteImpl(&terminator, sizeof(terminator));
+}
+
+bool StreamWriter::Patch(size_t acOffset, const void* apSource, const size_t acLength)
+{
+  if (!pFile || acOffset > GetPosition() || acLength > GetPosition() - acOffset)
+    return false;
+
+  const uint8_t* pSource = static_cast<const uint8_t*>(apSource);
+
+  // The part that was handed off already is patched in the file, after its block was written.
+  if (acOffset < blockOffset)
+  {
+    Request request{};
+    request.offset = acOffset;
+    request.size = std::min(acLength, blockOffset - acOffset);
+    request.pData = std::make_unique_for_overwrite<uint8_t[]>(request.size);
+    std::memcpy(request.pData.get(), pSource, request.size);
+
+    acOffset += request.size;
+    pSource += request.size;
+    const size_t remaining = acLength - request.size;
+
+    Submit(std::move(request));
+
+    if (remaining != 0)
+      std::memcpy(pBlock.get() + (acOffset - blockOffset), pSource, remaining);
+  }
+  else
+  {
+    std::memcpy(pBlock.get() + (acOffset - blockOffset), pSource, acLength);
+  }
+
+  return !isFailed;
+}
+
+void StreamWriter::Submit(Request&& aRequest)
+{
+  {
+    std::scoped_lock lock(mutex);
+    requests.push_back(std::move(aRequest));
+  }
+  condition.notify_all();
+}
+
+void StreamWriter::SubmitBlock()
+{
+  Request request{};
+  request.offset = blockOffset;
+  request.pData = std::move(pBlock);
+  request.size = used;
+  request.isBlock = true;
+  Submit(std::move(request));
+
+  blockOffset += used;
+  used = 0;
+
+  // Take a block the thread is done with, or wait for one if there are too many already.
+  std::unique_lock lock(mutex);
+  if (freeBlocks.empty() && blockCount < kMaxBlocks)
+  {
+    blockCount++;
+    lock.unlock();
+    pBlock = std::make_unique_for_overwrite<uint8_t[]>(blockSize);
+    return;
+  }
+
+  condition.wait(lock, [this]() { return !freeBlocks.empty(); });
+  pBlock = std::move(freeBlocks.back());
+  freeBlocks.pop_back();
+}
+
+void StreamWriter::Run()
+{
+  // Where the next sequential write goes, to only seek for patches.
+  uint64_t filePosition = 0;
+
+  while (true)
+  {
+    std::unique_lock lock(mutex);
+    condition.wait(lock, [this]() { return !requests.empty() || isClosing; });
+    if (requests.empty())
+      return;
+
+    Request request = std::move(requests.front());
+    requests.pop_front();
+    lock.unlock();
+
+    if (!isFailed)
+    {
+      if (request.offset != filePosition && !Seek(pFile, request.offset))
+        isFailed = true;
+      else if (std::fwrite(request.pData.get(), 1, request.size, pFile) != request.size)
+        isFailed = true;
+
+      filePosition = request.offset + request.size;
+    }
+
+    if (request.isBlock)
+    {
+      lock.lock();
+      freeBlocks.push_back(std::move(request.pData));
+      lock.unlock();
+      condition.notify_all();
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Writes binary output straight to a file, in blocks of a fixed size.
+//
+// Unlike Writer, the output is never held in memory as a whole: a full block is handed to a
+// background thread that writes it while the next one is filled, and at most kMaxBlocks
+// blocks exist at once, so memory use does not depend on the size of the output.
+// Bytes that were already written can still be overwritten with Patch(), e.g. to fill in
+// a header once the rest of the file is known.
+class StreamWriter final
+{
+public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;
+  static constexpr size_t kMaxBlocks = 3;
+
+  StreamWriter(size_t acBlockSize = kDefaultBlockSize);
+  StreamWriter(const StreamWriter&) = delete;
+  StreamWriter& operator=(const StreamWriter&) = delete;
+  ~StreamWriter();
+
+  // Creates or truncates the file. Closes the previous one first, if any.
+  bool Open(const std::string& acFilename);
+  // Writes what is left and closes the file. Returns false if any write failed.
+  bool Close();
+  bool IsOpen() const { return pFile != nullptr; }
+
+  // This only works on simple types with no pointers
+  template <class T>
+  bool Write(T& apSource)
+  {
+    static_assert(std::is_trivial<T>::value);
+    return WriteImpl(&apSource, sizeof(T));
+  }
+  bool WriteImpl(const void* apSource, const size_t acLength);
+
+  // Writes the characters followed by a NUL terminator.
+  bool WriteString(std::string_view aSource);
+
+  // Overwrites acLength bytes at acOffset, which must have been written already.
+  bool Patch(size_t acOffset, const void* apSource, const size_t acLength);
+
+  // Number of bytes written so far.
+  size_t GetPosition() const { return blockOffset + used; }
+
+private:
+  struct Request
+  {
+    uint64_t offset = 0;
+    std::unique_ptr<uint8_t[]> pData{};
+    size_t size = 0;
+    // Blocks go back to the free list once written, patches are dropped.
+    bool isBlock = false;
+  };
+
+  void Submit(Request&& aRequest);
+  void SubmitBlock();
+  void Run();
+
+  size_t blockSize = kDefaultBlockSize;
+
+  // The block being filled, which starts at blockOffset in the file.
+  std::unique_ptr<uint8_t[]> pBlock{};
+  size_t used = 0;
+  size_t blockOffset = 0;
+
+  // Shared with the thread that writes the file.
+  std::mutex mutex{};
+  std::condition_variable condition{};
+  std::deque<Request> requests{};
+  std::vector<std::unique_ptr<uint8_t[]>> freeBlocks{};
+  size_t blockCount = 0;
+  bool isClosing = false;
+  std::atomic<bool> isFailed = false;
+
+  // Only used by the writing thread while the file is open.
+  std::FILE* pFile = nullptr;
+  std::thread thread{};
+};
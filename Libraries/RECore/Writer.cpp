@@ -1,70 +1,197 @@
 #include "Writer.h"
 
-#include <filesystem>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <utility>
 #include <spdlog/spdlog.h>
 
-Writer::Writer()
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace
 {
-  constexpr size_t initialSize = 1024;
-  pData = std::make_unique<uint8_t[]>(initialSize);
-  size = initialSize;
+#ifdef _WIN32
+  // Buffered Windows file handles have no vectored write (WriteFileGather needs unbuffered,
+  // page aligned I/O), but writing the chunks back to back still never copies them.
+  bool WriteChunks(const std::string& acFilename, std::span<const std::pair<const uint8_t*, size_t>> aChunks)
+  {
+    HANDLE file = CreateFileA(acFilename.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      spdlog::error("Failed to open file {} for writing", acFilename);
+      return false;
+    }
+
+    bool isWritten = true;
+    for (auto [pData, size] : aChunks)
+    {
+      // WriteFile takes 32 bit lengths, and chunks with a large initial size can exceed them.
+      while (isWritten && size != 0)
+      {
+        DWORD written = 0;
+        isWritten = WriteFile(file, pData, static_cast<DWORD>(std::min<size_t>(size, 1u << 30)), &written, NULL) && written != 0;
+        pData += written;
+        size -= written;
+      }
+    }
+
+    CloseHandle(file);
+
+    if (!isWritten)
+      spdlog::error("Failed to write to file {}", acFilename);
+
+    return isWritten;
+  }
+#else
+  bool WriteChunks(const std::string& acFilename, std::span<const std::pair<const uint8_t*, size_t>> aChunks)
+  {
+    const int fd = open(acFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+      spdlog::error("Failed to open file {} for writing", acFilename);
+      return false;
+    }
+
+    // writev takes at most IOV_MAX vectors, and may write less than asked for.
+    constexpr size_t kMaxVectors = 1024;
+
+    size_t chunk = 0;
+    size_t offset = 0;
+    bool isWritten = true;
+    while (true)
+    {
+      while (chunk < aChunks.size() && offset == aChunks[chunk].second)
+      {
+        chunk++;
+        offset = 0;
+      }
+
+      if (chunk == aChunks.size())
+        break;
+
+      iovec vectors[kMaxVectors]{};
+      size_t vectorCount = 0;
+      for (size_t i = chunk; i < aChunks.size() && vectorCount < kMaxVectors; i++)
+      {
+        const size_t skipped = i == chunk ? offset : 0;
+        vectors[vectorCount++] = { const_cast<uint8_t*>(aChunks[i].first) + skipped, aChunks[i].second - skipped };
+      }
+
+      const ssize_t result = writev(fd, vectors, static_cast<int>(vectorCount));
+      if (result < 0)
+      {
+        if (errno == EINTR)
+          continue;
+
+        isWritten = false;
+        break;
+      }
+
+      for (size_t written = static_cast<size_t>(result); written != 0;)
+      {
+        const size_t step = std::min(written, aChunks[chunk].second - offset);
+        offset += step;
+        written -= step;
+
+        if (offset == aChunks[chunk].second)
+        {
+          chunk++;
+          offset = 0;
+        }
+      }
+    }
+
+    if (close(fd) != 0)
+      isWritten = false;
+
+    if (!isWritten)
+      spdlog::error("Failed to write to file {}", acFilename);
+
+    return isWritten;
+  }
+#endif
 }
 
 Writer::Writer(size_t acInitialSize)
 {
-  if (acInitialSize < 1)
-    acInitialSize = 1;
-
-  pData = std::make_unique<uint8_t[]>(acInitialSize);
-  size = acInitialSize;
+  initialSize = std::max<size_t>(acInitialSize, 1);
 }
 
 bool Writer::WriteToFile(const std::string& acFilename)
 {
-  if (!pData)
+  std::vector<std::pair<const uint8_t*, size_t>> parts{};
+  parts.reserve(chunks.size());
+  for (const Chunk& chunk : chunks)
   {
-    spdlog::error("Tried to save to file with not content loaded");
-    return false;
+    if (chunk.used != 0)
+      parts.emplace_back(chunk.pData.get(), chunk.used);
   }
 
-  std::ofstream file(acFilename, std::ios::binary);
-  if (file.fail())
+  return WriteChunks(acFilename, parts);
+}
+
+bool Writer::WriteImpl(const void* apSource, const size_t acLength)
+{
+  const uint8_t* pSource = static_cast<const uint8_t*>(apSource);
+  size_t remaining = acLength;
+
+  // Writes that do not fit in the last chunk are split, the rest goes into a new one.
+  while (remaining != 0)
   {
-    spdlog::error("Failed to load file contents of file {}", acFilename);
-    return false;
+    if (chunks.empty() || chunks.back().used == chunks.back().size)
+      AddChunk();
+
+    Chunk& chunk = chunks.back();
+    const size_t count = std::min(remaining, chunk.size - chunk.used);
+    std::memcpy(chunk.pData.get() + chunk.used, pSource, count);
+
+    chunk.used += count;
+    pSource += count;
+    remaining -= count;
   }
 
-  file.write(reinterpret_cast<const char*>(const_cast<const uint8_t*>(pData.get())), position+1);
+  position += acLength;
 
   return true;
 }
 
-bool Writer::WriteImpl(const void* apSource, const size_t acLength)
+bool Writer::WriteString(std::string_view aSource)
 {
-  if (IsOverflow(acLength))
-  {
-    // Resize 10% of the currrent size, or double if 10% is 0.
-    const size_t oldSize = size;
-    
-    size_t newSize = size + size * 0.1;
-    if (newSize == size)
-      newSize = size * 2;
-
-    if (newSize < oldSize + acLength)
-      newSize = oldSize + acLength;
+  if (!aSource.empty() && !WriteImpl(aSource.data(), aSource.size()))
+    return false;
 
-    Resize(newSize);
-  }
+  const char terminator = '\0';
+  return WriteImpl(&terminator, sizeof(terminator));
+}
 
-  std::memcpy(GetDataAtPosition(), apSource, acLength);
+void Writer::Reset()
+{
+  if (chunks.size() > 1)
+    chunks.resize(1);
 
-  Advance(acLength);
+  if (!chunks.empty())
+    chunks.front().used = 0;
 
-  return true;
+  position = 0;
+  capacity = chunks.empty() ? 0 : chunks.front().size;
 }
 
-bool Writer::WriteString(const std::string& acSource)
+void Writer::AddChunk()
 {
-  return WriteImpl(reinterpret_cast<const void*>(acSource.c_str()), acSource.size() + 1);
+  // Doubles the capacity, so the number of chunks stays logarithmic in the output size.
+  const size_t chunkSize = chunks.empty() ? initialSize : std::clamp(capacity, initialSize, std::max(initialSize, kMaxChunkSize));
+
+  Chunk& chunk = chunks.emplace_back();
+  // Every byte is written before it is read, so there is no need to zero the chunk.
+  chunk.pData = std::make_unique_for_overwrite<uint8_t[]>(chunkSize);
+  chunk.size = chunkSize;
+
+  capacity += chunkSize;
 }
\ No newline at end of file
@@ -1,16 +1,28 @@
 #pragma once
 
-#include "Buffer.h"
-
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
-class Writer final : public Buffer
+// Collects binary output in memory, to be written to a file at once.
+//
+// The output is kept in a list of chunks that never move once allocated, so growing
+// never copies what was already written. The first chunk has the initial size, every
+// next one is as large as all chunks before it, up to kMaxChunkSize, so small outputs
+// only take a few kilobytes and large ones a handful of allocations.
+// WriteToFile() hands all chunks to the OS in one vectored write where it can.
+class Writer final
 {
 public:
-  Writer();
+  static constexpr size_t kDefaultInitialSize = 4096;
+  static constexpr size_t kMaxChunkSize = 64 * 1024 * 1024;
+
+  Writer() = default;
+  // Nothing is allocated until the first write. Pass the final size if it is known up front,
+  // so everything goes into a single chunk.
   Writer(size_t acInitialSize);
 
   bool WriteToFile(const std::string& acFilename);
@@ -24,5 +36,29 @@ public:
   }
   bool WriteImpl(const void* apSource, const size_t acLength);
 
-  bool WriteString(const std::string& acSource);
+  // Writes the characters followed by a NUL terminator.
+  bool WriteString(std::string_view aSource);
+
+  // Number of bytes written so far.
+  size_t GetPosition() const { return position; }
+  // Number of bytes allocated for the chunks.
+  size_t GetCapacity() const { return capacity; }
+
+  // Discards the output, but keeps the first chunk for reuse.
+  void Reset();
+
+private:
+  struct Chunk
+  {
+    std::unique_ptr<uint8_t[]> pData{};
+    size_t size = 0;
+    size_t used = 0;
+  };
+
+  void AddChunk();
+
+  std::vector<Chunk> chunks{};
+  size_t initialSize = kDefaultInitialSize;
+  size_t position = 0;
+  size_t capacity = 0;
 };
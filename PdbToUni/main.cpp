@@ -6,6 +6,15 @@
 #include <UniversalSymbolsFormat/USYM.h>
 #include <DiaProcessor/DiaInterface.h>
 
+#include <BatchScheduler.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
 void InitializeLogger()
 {
   auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -15,17 +24,97 @@ void InitializeLogger()
   set_default_logger(logger);
 }
 
+bool IsPdbFile(const std::string& aFileName)
+{
+  std::string extension = std::filesystem::path(aFileName).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char aCharacter) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(aCharacter)));
+  });
+  return extension == ".pdb";
+}
+
+// Output file name without extension, the serializer adds its own.
+std::string GetOutputName(const std::string& aFileName)
+{
+  return aFileName.substr(0, aFileName.find_last_of("."));
+}
+
+// Converts every PDB under a directory, or every file of a manifest, next to where it is.
+int ConvertBatch(const std::string& aSource, const BatchOptions& aOptions, const std::string& aTimingsFile)
+{
+  std::vector<std::string> inputs{};
+  const bool isListed = std::filesystem::is_directory(aSource) ? ListFiles(aSource, IsPdbFile, inputs) : ReadFileList(aSource, inputs);
+  if (!isListed)
+  {
+    spdlog::error("Failed to read {}.", aSource);
+    return 1;
+  }
+
+  spdlog::info("Converting {} files.", inputs.size());
+
+  const std::vector<uint64_t> sizes = GetFileSizes(inputs);
+  const auto timings = DiaInterface::CreateUsymsFromFiles(inputs, [&](size_t aIndex, std::optional<USYM>& aUsym) {
+    if (!aUsym)
+    {
+      spdlog::error("Failed to load symbols from DIA for {}.", inputs[aIndex]);
+      return false;
+    }
+
+    // Every file already has a thread of its own, verifying on more would oversubscribe the cores.
+    aUsym->SetSerializer(ISerializer::Type::kJson);
+    if (aUsym->Serialize(GetOutputName(inputs[aIndex]).c_str(), USYM::SerializeOptions{ .verifyOptions = { .threadCount = 1 } }) != ISerializer::SerializeResult::kOk)
+    {
+      spdlog::error("Failed to write the USYM of {}.", inputs[aIndex]);
+      return false;
+    }
+
+    // Freed here, on the worker, rather than kept until the batch is done.
+    aUsym.reset();
+    return true;
+  }, aOptions);
+
+  if (!aTimingsFile.empty())
+    WriteBatchTimings(aTimingsFile, inputs, sizes, timings);
+
+  return LogBatchSummary(inputs, sizes, timings) == 0 ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
   InitializeLogger();
 
-  if (argc != 2)
+  std::string batchSource{};
+  std::string timingsFile{};
+  BatchOptions batchOptions{};
+  std::vector<std::string> arguments{};
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "--batch" && i + 1 < argc)
+      batchSource = argv[++i];
+    else if (argument == "--threads" && i + 1 < argc)
+      batchOptions.threadCount = std::strtoull(argv[++i], nullptr, 10);
+    else if (argument == "--max-memory" && i + 1 < argc)
+      batchOptions.maxBytesInFlight = std::strtoull(argv[++i], nullptr, 10) << 20;
+    else if (argument == "--timings" && i + 1 < argc)
+      timingsFile = argv[++i];
+    else
+      arguments.push_back(argument);
+  }
+
+  if (batchSource.empty() ? arguments.size() != 1 : !arguments.empty())
   {
     spdlog::info("Usage: {} [path_to_pdb]", argv[0]);
+    spdlog::info("       {} --batch [directory_or_manifest] [--threads count] [--max-memory megabytes] [--timings path_to_csv]", argv[0]);
+    spdlog::info("A batch converts every PDB under the directory, or every file listed in the manifest, largest first.");
+    spdlog::info("--max-memory bounds the summed size of the files being converted at once.");
     exit(1);
   }
 
-  std::string target = argv[1];
+  if (!batchSource.empty())
+    return ConvertBatch(batchSource, batchOptions, timingsFile);
+
+  std::string target = arguments[0];
   auto pUsymResult = DiaInterface::CreateUsymFromFile(target.c_str());
 
   if (!pUsymResult)
@@ -38,6 +127,12 @@ int main(int argc, char* argv[])
 
   usym.SetSerializer(ISerializer::Type::kJson);
 
-  std::string output = target.substr(0, target.find_last_of("."));
-  auto result = usym.Serialize(output.c_str());
+  std::string output = GetOutputName(target);
+  if (usym.Serialize(output.c_str()) != ISerializer::SerializeResult::kOk)
+  {
+    spdlog::error("Failed to write the USYM of {}.", target);
+    return 1;
+  }
+
+  return 0;
 }
@@ -8,6 +8,7 @@ project "PdbToUni"
    includedirs 
    {
       "../Components",
+      "../Libraries/RECore",
       "../Vendor/spdlog/include",
    }
 
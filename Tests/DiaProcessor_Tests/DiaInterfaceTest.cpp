@@ -1,12 +1,9 @@
 #include <gtest/gtest.h>
 #include <DiaProcessor/DiaInterface.h>
-#include <Windows.h>
+#include <DiaProcessor/DiaSession.h>
 
-namespace DiaInterface
-{
-  void InitializeDia(const char* apFileName);
-  void Release();
-}
+#include <string>
+#include <vector>
 
 namespace
 {
@@ -25,9 +22,8 @@ namespace
 
   TEST(DiaInterface, LoadPdbFile)
   {
-    EXPECT_NO_THROW(DiaInterface::InitializeDia("CppApp1.pdb"));
-    
-    DiaInterface::Release();
+    EXPECT_NO_THROW(DiaInterface::DiaSession session("CppApp1.pdb"));
+    EXPECT_THROW(DiaInterface::DiaSession session("DoesNotExist.pdb"), std::runtime_error);
   }
 
   TEST(DiaInterface, CreateUsymFromFile)
@@ -37,6 +33,29 @@ namespace
     ASSERT_TRUE(pUsym.has_value());
   }
 
+  TEST(DiaInterface, CreateUsymsFromFiles)
+  {
+    const std::vector<std::string> fileNames{ "CppApp1.pdb", "DoesNotExist.pdb", "CppApp1.pdb", "CppApp1.pdb" };
+    std::vector<std::optional<USYM>> usyms(fileNames.size());
+
+    const auto timings = DiaInterface::CreateUsymsFromFiles(fileNames, [&](size_t aIndex, std::optional<USYM>& aUsym) {
+      usyms[aIndex] = std::move(aUsym);
+      return usyms[aIndex].has_value();
+    }, { .threadCount = 4 });
+
+    ASSERT_EQ(timings.size(), fileNames.size());
+    EXPECT_FALSE(timings[1].succeeded);
+    EXPECT_FALSE(usyms[1].has_value());
+    for (const size_t index : { 0, 2, 3 })
+    {
+      ASSERT_TRUE(usyms[index].has_value()) << index;
+      EXPECT_EQ(usyms[index]->typeSymbols.size(), usyms[0]->typeSymbols.size());
+      EXPECT_EQ(usyms[index]->functionSymbols.size(), usyms[0]->functionSymbols.size());
+      // Pointer names are counted per file, not across the batch.
+      EXPECT_EQ(usyms[index]->GetTypeSymbolByName("pUnk1").id, usyms[0]->GetTypeSymbolByName("pUnk1").id);
+    }
+  }
+
   TEST_F(DiaInterfaceTest, TestHeader)
   {
     EXPECT_EQ(pUsym->header.magic, 'MYSU');
@@ -8,6 +8,8 @@ project "DiaProcessor_Tests"
    includedirs
    {
       "../../Components",
+      "../../Libraries/RECore",
+      "../../Vendor/DIASDK/include",
       "../../Vendor/googletest/include"
    }
 
@@ -0,0 +1,673 @@
+#include <gtest/gtest.h>
+#include <ElfProcessor/ElfEx.h>
+#include <ElfProcessor/ElfInterface.h>
+#include <Crc32.h>
+#include <Inflate.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+  class ElfInterfaceTest : public ::testing::Test
+  {
+  public:
+    static void SetUpTestSuite()
+    {
+      pUsym = std::make_unique<USYM>(ElfInterface::CreateUsymFromFile("CppApp1").value());
+    }
+
+    static std::unique_ptr<USYM> pUsym;
+  };
+
+  std::unique_ptr<USYM> ElfInterfaceTest::pUsym = nullptr;
+
+  TEST(ElfInterface, CreateUsymFromFile)
+  {
+    auto pUsym = ElfInterface::CreateUsymFromFile("CppApp1");
+
+    ASSERT_TRUE(pUsym.has_value());
+    EXPECT_FALSE(pUsym->typeSymbols.empty());
+    EXPECT_FALSE(pUsym->functionSymbols.empty());
+  }
+
+  TEST(ElfInterface, ThreadCountDoesNotChangeResult)
+  {
+    auto pSingleThreaded = ElfInterface::CreateUsymFromFile("CppApp1", 1);
+    auto pMultiThreaded = ElfInterface::CreateUsymFromFile("CppApp1", 4);
+
+    ASSERT_TRUE(pSingleThreaded.has_value());
+    ASSERT_TRUE(pMultiThreaded.has_value());
+
+    ASSERT_EQ(pSingleThreaded->typeSymbols.size(), pMultiThreaded->typeSymbols.size());
+    for (const auto& [id, symbol] : pSingleThreaded->typeSymbols)
+    {
+      const auto pOther = pMultiThreaded->typeSymbols.find(id);
+      ASSERT_NE(pOther, pMultiThreaded->typeSymbols.end());
+      EXPECT_EQ(symbol, pOther->second);
+    }
+
+    ASSERT_EQ(pSingleThreaded->functionSymbols.size(), pMultiThreaded->functionSymbols.size());
+    for (const auto& [id, symbol] : pSingleThreaded->functionSymbols)
+    {
+      const auto pOther = pMultiThreaded->functionSymbols.find(id);
+      ASSERT_NE(pOther, pMultiThreaded->functionSymbols.end());
+      EXPECT_EQ(symbol.name, pOther->second.name);
+      EXPECT_EQ(symbol.argumentTypeIds, pOther->second.argumentTypeIds);
+    }
+  }
+
+  TEST(ElfInterface, MissingFile)
+  {
+    EXPECT_FALSE(ElfInterface::CreateUsymFromFile("DoesNotExist").has_value());
+  }
+
+  TEST(ElfInterface, CreateUsymsFromFiles)
+  {
+    auto reference = ElfInterface::CreateUsymFromFile("CppApp1");
+    ASSERT_TRUE(reference.has_value());
+
+    const std::vector<std::string> fileNames{ "CppApp1", "DoesNotExist", "CppApp1", "CppApp1", "CppApp1" };
+    std::vector<std::optional<USYM>> usyms(fileNames.size());
+    std::vector<int> callCounts(fileNames.size());
+
+    const auto timings = ElfInterface::CreateUsymsFromFiles(fileNames, [&](size_t aIndex, std::optional<USYM>& aUsym) {
+      callCounts[aIndex]++;
+      usyms[aIndex] = std::move(aUsym);
+      return usyms[aIndex].has_value();
+    }, { .threadCount = 4, .maxBytesInFlight = 1 });
+
+    EXPECT_EQ(callCounts, std::vector<int>(fileNames.size(), 1));
+    ASSERT_EQ(timings.size(), fileNames.size());
+    EXPECT_FALSE(timings[1].succeeded);
+    EXPECT_FALSE(usyms[1].has_value());
+    for (const size_t index : { 0, 2, 3, 4 })
+    {
+      EXPECT_TRUE(timings[index].succeeded) << index;
+      ASSERT_TRUE(usyms[index].has_value()) << index;
+      ASSERT_EQ(usyms[index]->typeSymbols.size(), reference->typeSymbols.size());
+      for (const auto& [id, symbol] : reference->typeSymbols)
+      {
+        const auto pOther = usyms[index]->typeSymbols.find(id);
+        ASSERT_NE(pOther, usyms[index]->typeSymbols.end());
+        EXPECT_EQ(symbol, pOther->second);
+      }
+      EXPECT_EQ(usyms[index]->functionSymbols.size(), reference->functionSymbols.size());
+    }
+  }
+
+  TEST_F(ElfInterfaceTest, TestHeader)
+  {
+    EXPECT_EQ(pUsym->header.magic, 'MYSU');
+    EXPECT_EQ(pUsym->header.originalFormat, USYM::OriginalFormat::kDwarf);
+    EXPECT_EQ(pUsym->header.architecture, USYM::Architecture::kX86_64);
+  }
+
+  TEST_F(ElfInterfaceTest, TestBaseTypeSymbol)
+  {
+    const auto& typeSymbol = pUsym->GetTypeSymbolByName("float");
+
+    ASSERT_NE(typeSymbol.id, 0);
+
+    EXPECT_EQ(typeSymbol.name, "float");
+    EXPECT_EQ(typeSymbol.type, USYM::TypeSymbol::Type::kBase);
+    EXPECT_EQ(typeSymbol.length, 4);
+  }
+
+  TEST_F(ElfInterfaceTest, TestUdtClassTypeSymbol)
+  {
+    const auto& typeSymbol = pUsym->GetTypeSymbolByName("TestClass1");
+
+    ASSERT_NE(typeSymbol.id, 0);
+
+    EXPECT_EQ(typeSymbol.name, "TestClass1");
+    EXPECT_EQ(typeSymbol.type, USYM::TypeSymbol::Type::kClass);
+    EXPECT_EQ(typeSymbol.length, 16);
+    EXPECT_EQ(typeSymbol.fieldCount, 2);
+    EXPECT_EQ(typeSymbol.fieldCount, typeSymbol.fields.size());
+    EXPECT_EQ(typeSymbol.typedefSource, 0);
+
+    const auto& field = typeSymbol.fields[1];
+    EXPECT_EQ(field.name, "p");
+    EXPECT_EQ(field.offset, 8);
+
+    const auto pUnderlyingTypeOfField = pUsym->typeSymbols.find(typeSymbol.fields[0].underlyingTypeId);
+    ASSERT_NE(pUnderlyingTypeOfField, pUsym->typeSymbols.end());
+
+    const auto& underlyingTypeOfField = pUnderlyingTypeOfField->second;
+    EXPECT_EQ(underlyingTypeOfField.name, "TestStruct1");
+    EXPECT_EQ(underlyingTypeOfField.type, USYM::TypeSymbol::Type::kStruct);
+    EXPECT_EQ(underlyingTypeOfField.fieldCount, 2);
+  }
+
+  TEST_F(ElfInterfaceTest, TestEnumTypeSymbol)
+  {
+    const auto& typeSymbol = pUsym->GetTypeSymbolByName("TestEnum1");
+
+    ASSERT_NE(typeSymbol.id, 0);
+
+    EXPECT_EQ(typeSymbol.type, USYM::TypeSymbol::Type::kEnum);
+    EXPECT_EQ(typeSymbol.length, 4);
+    EXPECT_EQ(typeSymbol.fieldCount, 3);
+    EXPECT_EQ(typeSymbol.fields[2].name, "kTestC");
+
+    const auto pUnderlyingTypeOfField = pUsym->typeSymbols.find(typeSymbol.fields[0].underlyingTypeId);
+    ASSERT_NE(pUnderlyingTypeOfField, pUsym->typeSymbols.end());
+    EXPECT_EQ(pUnderlyingTypeOfField->second.type, USYM::TypeSymbol::Type::kBase);
+    EXPECT_EQ(pUnderlyingTypeOfField->second.length, 4);
+  }
+
+  TEST_F(ElfInterfaceTest, TestTypedefSymbol)
+  {
+    const auto& typeSymbol = pUsym->GetTypeSymbolByName("pInt");
+
+    ASSERT_NE(typeSymbol.id, 0);
+
+    EXPECT_EQ(typeSymbol.type, USYM::TypeSymbol::Type::kTypedef);
+    EXPECT_EQ(typeSymbol.length, 8);
+
+    const auto pUnderlyingType = pUsym->typeSymbols.find(typeSymbol.typedefSource);
+    ASSERT_NE(pUnderlyingType, pUsym->typeSymbols.end());
+
+    const auto& underlyingType = pUnderlyingType->second;
+    EXPECT_EQ(underlyingType.type, USYM::TypeSymbol::Type::kPointer);
+    EXPECT_EQ(underlyingType.name, "int*");
+  }
+
+  TEST_F(ElfInterfaceTest, TestFunctionSymbol)
+  {
+    const auto& functionSymbol = pUsym->GetFunctionSymbolByName("PrintTestClass");
+
+    ASSERT_NE(functionSymbol.id, 0);
+
+    EXPECT_NE(functionSymbol.returnTypeId, 0);
+    EXPECT_NE(functionSymbol.virtualAddress, 0);
+    EXPECT_NE(functionSymbol.length, 0);
+    EXPECT_EQ(pUsym->Symbolize(functionSymbol.virtualAddress + functionSymbol.length - 1), &functionSymbol);
+    EXPECT_EQ(functionSymbol.argumentCount, 1);
+    ASSERT_EQ(functionSymbol.argumentTypeIds.size(), 1);
+
+    const auto pArgumentType = pUsym->typeSymbols.find(functionSymbol.argumentTypeIds[0]);
+    ASSERT_NE(pArgumentType, pUsym->typeSymbols.end());
+    EXPECT_EQ(pArgumentType->second.name, "TestClass1*");
+  }
+
+  TEST_F(ElfInterfaceTest, VerifyTypeIds)
+  {
+    EXPECT_TRUE(pUsym->VerifyTypeIds());
+  }
+
+  TEST(ElfEx, FindsDynamicSymbolsWithGnuHash)
+  {
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    ASSERT_FALSE(elf.GetDynamicSymbols().empty());
+    ASSERT_FALSE(elf.gnuHash.empty());
+
+    size_t definedCount = 0;
+    for (const auto& symbol : elf.GetDynamicSymbols())
+    {
+      if (!symbol.IsDefined() || symbol.name.empty())
+        continue;
+
+      definedCount++;
+      const ElfInterface::Elf_SymEx* pFound = elf.FindDynamicSymbol(symbol.name);
+      ASSERT_NE(pFound, nullptr) << symbol.name;
+      EXPECT_EQ(pFound->name, symbol.name);
+      EXPECT_EQ(pFound->st_value, symbol.st_value);
+    }
+    EXPECT_NE(definedCount, 0);
+
+    // Imports are not in the hash table.
+    for (const auto& symbol : elf.GetDynamicSymbols())
+    {
+      if (!symbol.IsDefined() && !symbol.name.empty())
+      {
+        EXPECT_EQ(elf.FindDynamicSymbol(symbol.name), nullptr) << symbol.name;
+      }
+    }
+
+    EXPECT_EQ(elf.FindDynamicSymbol("DoesNotExist"), nullptr);
+  }
+
+  TEST(ElfEx, FindsDynamicSymbolsWithSysvHash)
+  {
+    ElfInterface::ElfEx elf{};
+    const char* names[] = { "", "printf", "malloc", "free", "exit", "imported" };
+    for (const char* pName : names)
+    {
+      auto& symbol = elf.dynamicSymbols.emplace_back();
+      symbol.name = pName;
+      symbol.st_shndx = symbol.name == "imported" ? ELF::SHN_UNDEF : 1;
+    }
+
+    // Two buckets, so chains hold several symbols.
+    const uint32_t bucketCount = 2;
+    const uint32_t chainCount = static_cast<uint32_t>(elf.dynamicSymbols.size());
+    std::vector<uint32_t> buckets(bucketCount, 0);
+    std::vector<uint32_t> chains(chainCount, 0);
+    for (uint32_t i = 1; i < chainCount; i++)
+    {
+      uint32_t& bucket = buckets[ElfInterface::ElfEx::SysvHash(elf.dynamicSymbols[i].name) % bucketCount];
+      chains[i] = bucket;
+      bucket = i;
+    }
+
+    std::vector<uint32_t> table{ bucketCount, chainCount };
+    table.insert(table.end(), buckets.begin(), buckets.end());
+    table.insert(table.end(), chains.begin(), chains.end());
+    elf.sysvHash = { reinterpret_cast<const uint8_t*>(table.data()), table.size() * sizeof(uint32_t) };
+
+    for (const char* pName : { "printf", "malloc", "free", "exit" })
+    {
+      const ElfInterface::Elf_SymEx* pFound = elf.FindDynamicSymbol(pName);
+      ASSERT_NE(pFound, nullptr) << pName;
+      EXPECT_EQ(pFound->name, pName);
+    }
+
+    EXPECT_EQ(elf.FindDynamicSymbol("imported"), nullptr);
+    EXPECT_EQ(elf.FindDynamicSymbol("DoesNotExist"), nullptr);
+
+    // A chain that loops back on itself must not hang the lookup.
+    chains.assign(chainCount, 1);
+    table.resize(2 + bucketCount);
+    table.insert(table.end(), chains.begin(), chains.end());
+    elf.sysvHash = { reinterpret_cast<const uint8_t*>(table.data()), table.size() * sizeof(uint32_t) };
+    elf.FindDynamicSymbol("DoesNotExist");
+  }
+
+  TEST(ElfEx, ReadsTablesOnFirstUse)
+  {
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    EXPECT_EQ(elf.GetArchitecture(), USYM::Architecture::kX86_64);
+    EXPECT_TRUE(elf.sections.empty());
+
+    // The build id only needs the section headers.
+    EXPECT_EQ(elf.GetBuildId().size(), 20);
+    EXPECT_FALSE(elf.sections.empty());
+    EXPECT_TRUE(elf.symbols.empty());
+    EXPECT_TRUE(elf.dynamicSymbols.empty());
+
+    const auto& symbols = elf.GetSymbols();
+    EXPECT_FALSE(symbols.empty());
+    EXPECT_EQ(&elf.GetSymbols(), &symbols);
+    EXPECT_TRUE(elf.dynamicSymbols.empty());
+
+    // Parsing again drops what was read from the previous file.
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    EXPECT_TRUE(elf.sections.empty());
+    EXPECT_TRUE(elf.symbols.empty());
+    EXPECT_FALSE(elf.GetSymbols().empty());
+  }
+
+  TEST(ElfEx, HashFunctions)
+  {
+    EXPECT_EQ(ElfInterface::ElfEx::GnuHash(""), 5381);
+    EXPECT_EQ(ElfInterface::ElfEx::GnuHash("printf"), 0x156b2bb8);
+    EXPECT_EQ(ElfInterface::ElfEx::SysvHash("printf"), 0x077905a6);
+    EXPECT_EQ(ElfInterface::ElfEx::SysvHash("exit"), 0x0006cf04);
+  }
+
+  TEST(ElfInterface, FunctionsFromSymbolTableWithoutDwarf)
+  {
+    // A copy of the sample whose debug sections are renamed away, like a file built without -g.
+    std::ifstream input("CppApp1", std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(contents.empty());
+
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    ASSERT_TRUE(elf.is64Bit);
+    const auto& sections = elf.GetSections();
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+      if (sections[i].name.starts_with(".debug_"))
+      {
+        char* pName = contents.data() + elf.elfHeader.e_shoff + i * elf.elfHeader.e_shentsize;
+        const uint32_t emptyName = 0;
+        std::memcpy(pName, &emptyName, sizeof(emptyName));
+      }
+    }
+
+    std::ofstream("CppApp1NoDwarf", std::ios::binary).write(contents.data(), contents.size());
+
+    auto usym = ElfInterface::CreateUsymFromFile("CppApp1NoDwarf");
+    ASSERT_TRUE(usym.has_value());
+    EXPECT_TRUE(usym->typeSymbols.empty());
+
+    const auto& function = usym->GetFunctionSymbolByName("_Z14PrintTestClassP10TestClass1");
+    ASSERT_NE(function.id, 0);
+    EXPECT_NE(function.virtualAddress, 0);
+    EXPECT_NE(function.length, 0);
+    EXPECT_EQ(usym->Symbolize(function.virtualAddress + function.length - 1), &function);
+  }
+
+  // A zlib stream of stored blocks, valid input for the decompressor without needing a compressor.
+  std::vector<uint8_t> CreateStoredZlib(std::span<const uint8_t> aData)
+  {
+    std::vector<uint8_t> stream{ 0x78, 0x01 };
+    size_t offset = 0;
+    do
+    {
+      const uint16_t length = static_cast<uint16_t>(std::min<size_t>(0xFFFF, aData.size() - offset));
+      stream.push_back(offset + length == aData.size() ? 1 : 0);
+      stream.push_back(static_cast<uint8_t>(length));
+      stream.push_back(static_cast<uint8_t>(length >> 8));
+      stream.push_back(static_cast<uint8_t>(~length));
+      stream.push_back(static_cast<uint8_t>(~length >> 8));
+      stream.insert(stream.end(), aData.begin() + offset, aData.begin() + offset + length);
+      offset += length;
+    } while (offset != aData.size());
+
+    const uint32_t adler = Inflate::Adler32(aData.data(), aData.size());
+    for (int shift = 24; shift >= 0; shift -= 8)
+      stream.push_back(static_cast<uint8_t>(adler >> shift));
+    return stream;
+  }
+
+  // Writes a copy of the sample with every debug section compressed, either with SHF_COMPRESSED
+  // or renamed to .zdebug_*. The new contents and names are appended to the file.
+  void WriteCompressedCopy(const char* apFileName, bool aUseFlag)
+  {
+    std::ifstream input("CppApp1", std::ios::binary);
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(contents.empty());
+
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    ASSERT_TRUE(elf.is64Bit);
+
+    const auto& sections = elf.GetSections();
+    const auto names = elf.GetRawSectionData(sections[elf.elfHeader.e_shstrndx]);
+    std::vector<uint8_t> newNames(names.begin(), names.end());
+
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+      const auto& section = sections[i];
+      if (!section.name.starts_with(".debug_"))
+        continue;
+
+      const auto data = elf.GetRawSectionData(section);
+      std::vector<uint8_t> compressed{};
+      ELF::Elf64_Shdr header{};
+      const size_t headerOffset = elf.elfHeader.e_shoff + i * elf.elfHeader.e_shentsize;
+      std::memcpy(&header, contents.data() + headerOffset, sizeof(header));
+
+      if (aUseFlag)
+      {
+        ELF::Elf64_Chdr compressionHeader{ ELF::ELFCOMPRESS_ZLIB, 0, data.size(), 1 };
+        const auto pBytes = reinterpret_cast<const uint8_t*>(&compressionHeader);
+        compressed.assign(pBytes, pBytes + sizeof(compressionHeader));
+        header.sh_flags |= ELF::SHF_COMPRESSED;
+      }
+      else
+      {
+        compressed = { 'Z', 'L', 'I', 'B' };
+        for (int shift = 56; shift >= 0; shift -= 8)
+          compressed.push_back(static_cast<uint8_t>(data.size() >> shift));
+
+        header.sh_name = static_cast<uint32_t>(newNames.size());
+        const std::string name = ".zdebug_" + std::string(section.name.substr(7));
+        newNames.insert(newNames.end(), name.c_str(), name.c_str() + name.size() + 1);
+      }
+
+      const std::vector<uint8_t> stream = CreateStoredZlib(data);
+      compressed.insert(compressed.end(), stream.begin(), stream.end());
+
+      contents.resize((contents.size() + 7) & ~size_t(7));
+      header.sh_offset = contents.size();
+      header.sh_size = compressed.size();
+      contents.insert(contents.end(), compressed.begin(), compressed.end());
+      std::memcpy(contents.data() + headerOffset, &header, sizeof(header));
+    }
+
+    if (!aUseFlag)
+    {
+      ELF::Elf64_Shdr header{};
+      const size_t headerOffset = elf.elfHeader.e_shoff + elf.elfHeader.e_shstrndx * elf.elfHeader.e_shentsize;
+      std::memcpy(&header, contents.data() + headerOffset, sizeof(header));
+      header.sh_offset = contents.size();
+      header.sh_size = newNames.size();
+      contents.insert(contents.end(), newNames.begin(), newNames.end());
+      std::memcpy(contents.data() + headerOffset, &header, sizeof(header));
+    }
+
+    std::ofstream(apFileName, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()), contents.size());
+  }
+
+  TEST(ElfInterface, CompressedDebugSections)
+  {
+    auto reference = ElfInterface::CreateUsymFromFile("CppApp1");
+    ASSERT_TRUE(reference.has_value());
+
+    ElfInterface::ElfEx original{};
+    ASSERT_TRUE(original.Parse("CppApp1"));
+    const auto info = original.GetSectionData(".debug_info");
+    ASSERT_FALSE(info.empty());
+
+    for (const bool useFlag : { true, false })
+    {
+      const char* pFileName = useFlag ? "CppApp1Compressed" : "CppApp1Zdebug";
+      WriteCompressedCopy(pFileName, useFlag);
+
+      ElfInterface::ElfEx elf{};
+      ASSERT_TRUE(elf.Parse(pFileName));
+      const auto* pSection = elf.FindSection(useFlag ? ".debug_info" : ".zdebug_info");
+      ASSERT_NE(pSection, nullptr);
+      EXPECT_TRUE(pSection->IsCompressed());
+
+      const auto decompressed = elf.GetSectionData(".debug_info");
+      ASSERT_TRUE(std::equal(decompressed.begin(), decompressed.end(), info.begin(), info.end())) << pFileName;
+      // Cached, not decompressed again.
+      EXPECT_EQ(elf.GetSectionData(".debug_info").data(), decompressed.data());
+
+      auto usym = ElfInterface::CreateUsymFromFile(pFileName, 4);
+      ASSERT_TRUE(usym.has_value());
+      EXPECT_EQ(usym->typeSymbols.size(), reference->typeSymbols.size());
+      EXPECT_EQ(usym->functionSymbols.size(), reference->functionSymbols.size());
+      EXPECT_EQ(usym->GetFunctionSymbolByName("_Z14PrintTestClassP10TestClass1").virtualAddress,
+        reference->GetFunctionSymbolByName("_Z14PrintTestClassP10TestClass1").virtualAddress);
+    }
+  }
+
+  TEST(ElfEx, RejectsCorruptCompressedSection)
+  {
+    WriteCompressedCopy("CppApp1Compressed", true);
+
+    std::ifstream input("CppApp1Compressed", std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1Compressed"));
+    const auto* pSection = elf.FindSection(".debug_abbrev");
+    ASSERT_NE(pSection, nullptr);
+
+    // The last byte of the checksum.
+    contents[pSection->sh_offset + pSection->sh_size - 1] ^= 1;
+    std::ofstream("CppApp1Corrupt", std::ios::binary).write(contents.data(), contents.size());
+
+    ASSERT_TRUE(elf.Parse("CppApp1Corrupt"));
+    EXPECT_TRUE(elf.GetSectionData(".debug_abbrev").empty());
+    EXPECT_FALSE(elf.GetSectionData(".debug_info").empty());
+  }
+
+  TEST(ElfEx, DecompressesSectionsFilledInByHand)
+  {
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = static_cast<uint8_t>(i * 7);
+
+    ELF::Elf64_Chdr compressionHeader{ ELF::ELFCOMPRESS_ZLIB, 0, data.size(), 1 };
+    const auto pBytes = reinterpret_cast<const uint8_t*>(&compressionHeader);
+    std::vector<uint8_t> contents(pBytes, pBytes + sizeof(compressionHeader));
+    const std::vector<uint8_t> stream = CreateStoredZlib(data);
+    contents.insert(contents.end(), stream.begin(), stream.end());
+
+    // Never parsed, so nothing is read on first use and decompressedSections starts out empty.
+    ElfInterface::ElfEx elf{};
+    elf.is64Bit = true;
+    elf.reader.Resize(contents.size());
+    std::memcpy(elf.reader.GetData(), contents.data(), contents.size());
+
+    ElfInterface::Elf_ShdrEx section{};
+    section.name = ".debug_info";
+    section.sh_type = ELF::SHT_PROGBITS;
+    section.sh_flags = ELF::SHF_COMPRESSED;
+    section.sh_size = contents.size();
+    elf.sections.push_back(section);
+
+    const auto decompressed = elf.GetSectionData(".debug_info");
+    EXPECT_TRUE(std::equal(decompressed.begin(), decompressed.end(), data.begin(), data.end()));
+    EXPECT_EQ(elf.decompressedSections.size(), elf.sections.size());
+
+    const std::string_view names[] = { ".debug_info" };
+    elf.DecompressSections(names);
+    EXPECT_EQ(elf.GetSectionData(".debug_info").data(), decompressed.data());
+  }
+
+  std::vector<uint8_t> ReadFile(const char* apFileName)
+  {
+    std::ifstream input(apFileName, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  }
+
+  // Writes a copy of the sample as strip leaves it: .symtab and the debug sections are gone,
+  // here turned into SHT_NOBITS. Optionally without the build id note, and with a
+  // .gnu_debuglink section, added with a new section header table at the end of the file.
+  void WriteStrippedCopy(const char* apFileName, bool aKeepBuildId, std::optional<std::pair<std::string, uint32_t>> aDebugLink)
+  {
+    std::vector<uint8_t> contents = ReadFile("CppApp1");
+    ASSERT_FALSE(contents.empty());
+
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    ASSERT_TRUE(elf.is64Bit);
+
+    const auto& sections = elf.GetSections();
+    std::vector<ELF::Elf64_Shdr> headers(sections.size());
+    std::memcpy(headers.data(), contents.data() + elf.elfHeader.e_shoff, headers.size() * sizeof(ELF::Elf64_Shdr));
+    for (size_t i = 0; i < headers.size(); i++)
+    {
+      const auto& name = sections[i].name;
+      if (name.starts_with(".debug_") || name == ".symtab")
+        headers[i].sh_type = ELF::SHT_NOBITS;
+      else if (name == ".note.gnu.build-id" && !aKeepBuildId)
+        headers[i].sh_type = ELF::SHT_PROGBITS;
+    }
+
+    if (aDebugLink)
+    {
+      const auto names = elf.GetRawSectionData(sections[elf.elfHeader.e_shstrndx]);
+      std::vector<uint8_t> newNames(names.begin(), names.end());
+      ELF::Elf64_Shdr link{};
+      link.sh_type = ELF::SHT_PROGBITS;
+      link.sh_addralign = 4;
+      link.sh_name = static_cast<uint32_t>(newNames.size());
+      newNames.insert(newNames.end(), { '.', 'g', 'n', 'u', '_', 'd', 'e', 'b', 'u', 'g', 'l', 'i', 'n', 'k', '\0' });
+
+      headers[elf.elfHeader.e_shstrndx].sh_offset = contents.size();
+      headers[elf.elfHeader.e_shstrndx].sh_size = newNames.size();
+      contents.insert(contents.end(), newNames.begin(), newNames.end());
+
+      contents.resize((contents.size() + 3) & ~size_t(3));
+      link.sh_offset = contents.size();
+      contents.insert(contents.end(), aDebugLink->first.begin(), aDebugLink->first.end());
+      contents.resize((contents.size() + 4) & ~size_t(3));
+      const uint32_t crc = aDebugLink->second;
+      contents.insert(contents.end(), reinterpret_cast<const uint8_t*>(&crc), reinterpret_cast<const uint8_t*>(&crc) + sizeof(crc));
+      link.sh_size = contents.size() - link.sh_offset;
+      headers.push_back(link);
+    }
+
+    contents.resize((contents.size() + 7) & ~size_t(7));
+    const uint64_t headerOffset = contents.size();
+    const uint16_t headerCount = static_cast<uint16_t>(headers.size());
+    contents.insert(contents.end(), reinterpret_cast<const uint8_t*>(headers.data()), reinterpret_cast<const uint8_t*>(headers.data() + headers.size()));
+    std::memcpy(contents.data() + offsetof(ELF::Elf64_Ehdr, e_shoff), &headerOffset, sizeof(headerOffset));
+    std::memcpy(contents.data() + offsetof(ELF::Elf64_Ehdr, e_shnum), &headerCount, sizeof(headerCount));
+
+    std::ofstream(apFileName, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()), contents.size());
+  }
+
+  TEST(ElfInterface, SeparateDebugFileByDebugLink)
+  {
+    auto reference = ElfInterface::CreateUsymFromFile("CppApp1");
+    ASSERT_TRUE(reference.has_value());
+
+    std::filesystem::copy_file("CppApp1", "CppApp1.debug", std::filesystem::copy_options::overwrite_existing);
+    const std::vector<uint8_t> debugFile = ReadFile("CppApp1.debug");
+    const uint32_t crc = Crc32(debugFile.data(), debugFile.size());
+
+    WriteStrippedCopy("CppApp1Stripped", false, std::make_pair(std::string("CppApp1.debug"), crc));
+
+    ElfInterface::ElfEx stripped{};
+    ASSERT_TRUE(stripped.Parse("CppApp1Stripped"));
+    EXPECT_TRUE(stripped.GetBuildId().empty());
+    EXPECT_TRUE(stripped.GetSymbols().empty());
+
+    std::string_view linkName{};
+    uint32_t linkCrc = 0;
+    ASSERT_TRUE(stripped.GetDebugLink(linkName, linkCrc));
+    EXPECT_EQ(linkName, "CppApp1.debug");
+    EXPECT_EQ(linkCrc, crc);
+
+    // Found next to the file, its sections and .symtab stand in for the stripped ones.
+    auto usym = ElfInterface::CreateUsymFromFile("CppApp1Stripped");
+    ASSERT_TRUE(usym.has_value());
+    EXPECT_EQ(usym->typeSymbols.size(), reference->typeSymbols.size());
+    EXPECT_EQ(usym->functionSymbols.size(), reference->functionSymbols.size());
+    const auto& function = usym->GetFunctionSymbolByName("_Z14PrintTestClassP10TestClass1");
+    EXPECT_EQ(function.length, reference->GetFunctionSymbolByName("_Z14PrintTestClassP10TestClass1").length);
+
+    // A debug file whose CRC does not match is not used.
+    WriteStrippedCopy("CppApp1StrippedBadCrc", false, std::make_pair(std::string("CppApp1.debug"), crc ^ 1));
+    usym = ElfInterface::CreateUsymFromFile("CppApp1StrippedBadCrc");
+    ASSERT_TRUE(usym.has_value());
+    EXPECT_TRUE(usym->typeSymbols.empty());
+  }
+
+  TEST(ElfInterface, SeparateDebugFileByBuildId)
+  {
+    auto reference = ElfInterface::CreateUsymFromFile("CppApp1");
+    ASSERT_TRUE(reference.has_value());
+
+    ElfInterface::ElfEx elf{};
+    ASSERT_TRUE(elf.Parse("CppApp1"));
+    const auto buildId = elf.GetBuildId();
+    ASSERT_EQ(buildId.size(), 20);
+
+    std::string hex{};
+    for (const uint8_t byte : buildId)
+    {
+      char digits[3]{};
+      std::snprintf(digits, sizeof(digits), "%02x", byte);
+      hex += digits;
+    }
+
+    const std::filesystem::path directory = std::filesystem::path("DebugFiles") / ".build-id" / hex.substr(0, 2);
+    std::filesystem::create_directories(directory);
+    std::filesystem::copy_file("CppApp1", directory / (hex.substr(2) + ".debug"), std::filesystem::copy_options::overwrite_existing);
+
+    WriteStrippedCopy("CppApp1StrippedBuildId", true, std::nullopt);
+
+    // Not in any directory that is searched.
+    auto usym = ElfInterface::CreateUsymFromFile("CppApp1StrippedBuildId");
+    ASSERT_TRUE(usym.has_value());
+    EXPECT_TRUE(usym->typeSymbols.empty());
+
+    const std::vector<std::string> debugDirectories{ "DoesNotExist", "DebugFiles" };
+    usym = ElfInterface::CreateUsymFromFile("CppApp1StrippedBuildId", 0, debugDirectories);
+    ASSERT_TRUE(usym.has_value());
+    EXPECT_EQ(usym->typeSymbols.size(), reference->typeSymbols.size());
+    EXPECT_EQ(usym->functionSymbols.size(), reference->functionSymbols.size());
+  }
+}
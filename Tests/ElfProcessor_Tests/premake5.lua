@@ -0,0 +1,23 @@
+group("Tests")
+project "ElfProcessor_Tests"
+   kind "ConsoleApp"
+   language "C++"
+
+   files {"**.h", "**.cpp", "../main.cpp"}
+
+   includedirs
+   {
+      "../../Components",
+      "../../Libraries/RECore",
+      "../../Vendor/googletest/include"
+   }
+
+   libdirs
+   {
+      "../Build/Bin/%{cfg.longname}"
+   }
+
+   links "googletest"
+   links "ElfProcessor"
+   links "UniversalSymbolsFormat"
+   links "RECore"
@@ -0,0 +1,461 @@
+#include "SyntheticElf.h"
+
+#include <ElfProcessor/DWARF.h>
+#include <ElfProcessor/ELF.h>
+#include <Inflate.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  enum AbbreviationCode : uint8_t
+  {
+    kCompileUnit = 1,
+    kBaseType,
+    kStructure,
+    kMember,
+    kPointer,
+    kSubprogram,
+    kParameter,
+  };
+
+  constexpr uint8_t kAteSigned = 0x05;
+  constexpr uint16_t kShnAbs = 0xfff1;
+  constexpr uint32_t kPtLoad = 1;
+  constexpr uint64_t kTextAddress = 0x401000;
+  constexpr uint64_t kFunctionLength = 0x40;
+
+  class Buffer
+  {
+  public:
+    template <class T>
+    void Write(const T& aValue)
+    {
+      const size_t offset = data.size();
+      data.resize(offset + sizeof(T));
+      std::memcpy(data.data() + offset, &aValue, sizeof(T));
+    }
+
+    template <class T>
+    void Patch(size_t aOffset, const T& aValue)
+    {
+      std::memcpy(data.data() + aOffset, &aValue, sizeof(T));
+    }
+
+    void WriteULEB128(uint64_t aValue)
+    {
+      do
+      {
+        uint8_t byte = aValue & 0x7f;
+        aValue >>= 7;
+        if (aValue != 0)
+          byte |= 0x80;
+        data.push_back(byte);
+      } while (aValue != 0);
+    }
+
+    void WriteString(const std::string& aString)
+    {
+      data.insert(data.end(), aString.begin(), aString.end());
+      data.push_back(0);
+    }
+
+    void Align(size_t aAlignment)
+    {
+      data.resize((data.size() + aAlignment - 1) & ~(aAlignment - 1));
+    }
+
+    size_t size() const { return data.size(); }
+
+    std::vector<uint8_t> data{};
+  };
+
+  // A NUL terminated string section, which stores every string once.
+  class StringTable
+  {
+  public:
+    StringTable()
+    {
+      buffer.WriteString("");
+    }
+
+    uint32_t Add(const std::string& aString)
+    {
+      const auto [it, isNew] = offsets.emplace(aString, static_cast<uint32_t>(buffer.size()));
+      if (isNew)
+        buffer.WriteString(aString);
+      return it->second;
+    }
+
+    Buffer buffer{};
+
+  private:
+    std::unordered_map<std::string, uint32_t> offsets{};
+  };
+
+  void WriteAbbreviation(Buffer& aAbbrev, uint8_t aCode, uint16_t aTag, bool aHasChildren, std::initializer_list<std::pair<uint16_t, uint16_t>> aAttributes)
+  {
+    aAbbrev.WriteULEB128(aCode);
+    aAbbrev.WriteULEB128(aTag);
+    aAbbrev.Write<uint8_t>(aHasChildren ? DWARF::DW_CHILDREN_yes : DWARF::DW_CHILDREN_no);
+
+    for (const auto& [attribute, form] : aAttributes)
+    {
+      aAbbrev.WriteULEB128(attribute);
+      aAbbrev.WriteULEB128(form);
+    }
+
+    aAbbrev.WriteULEB128(0);
+    aAbbrev.WriteULEB128(0);
+  }
+
+  Buffer CreateAbbreviations()
+  {
+    Buffer abbrev{};
+
+    WriteAbbreviation(abbrev, kCompileUnit, DWARF::DW_TAG_compile_unit, true,
+      { { DWARF::DW_AT_name, DWARF::DW_FORM_strp } });
+    WriteAbbreviation(abbrev, kBaseType, DWARF::DW_TAG_base_type, false,
+      { { DWARF::DW_AT_name, DWARF::DW_FORM_strp }, { DWARF::DW_AT_byte_size, DWARF::DW_FORM_data1 }, { DWARF::DW_AT_encoding, DWARF::DW_FORM_data1 } });
+    WriteAbbreviation(abbrev, kStructure, DWARF::DW_TAG_structure_type, true,
+      { { DWARF::DW_AT_name, DWARF::DW_FORM_strp }, { DWARF::DW_AT_byte_size, DWARF::DW_FORM_data4 } });
+    WriteAbbreviation(abbrev, kMember, DWARF::DW_TAG_member, false,
+      { { DWARF::DW_AT_name, DWARF::DW_FORM_strp }, { DWARF::DW_AT_type, DWARF::DW_FORM_ref4 }, { DWARF::DW_AT_data_member_location, DWARF::DW_FORM_data1 } });
+    WriteAbbreviation(abbrev, kPointer, DWARF::DW_TAG_pointer_type, false,
+      { { DWARF::DW_AT_byte_size, DWARF::DW_FORM_data1 }, { DWARF::DW_AT_type, DWARF::DW_FORM_ref4 } });
+    WriteAbbreviation(abbrev, kSubprogram, DWARF::DW_TAG_subprogram, true,
+      { { DWARF::DW_AT_external, DWARF::DW_FORM_flag_present }, { DWARF::DW_AT_name, DWARF::DW_FORM_strp }, { DWARF::DW_AT_type, DWARF::DW_FORM_ref4 },
+        { DWARF::DW_AT_low_pc, DWARF::DW_FORM_addr }, { DWARF::DW_AT_high_pc, DWARF::DW_FORM_data4 } });
+    WriteAbbreviation(abbrev, kParameter, DWARF::DW_TAG_formal_parameter, false,
+      { { DWARF::DW_AT_name, DWARF::DW_FORM_strp }, { DWARF::DW_AT_type, DWARF::DW_FORM_ref4 } });
+
+    abbrev.WriteULEB128(0);
+    return abbrev;
+  }
+
+  void WriteUnit(Buffer& aInfo, StringTable& aStrings, const SyntheticElfOptions& aOptions, uint32_t aUnitIndex)
+  {
+    const size_t unitStart = aInfo.size();
+    // References are relative to the start of the unit.
+    auto unitOffset = [&aInfo, unitStart]() { return static_cast<uint32_t>(aInfo.size() - unitStart); };
+
+    aInfo.Write<uint32_t>(0);
+    aInfo.Write<uint16_t>(4);
+    aInfo.Write<uint32_t>(0);
+    aInfo.Write<uint8_t>(8);
+
+    aInfo.WriteULEB128(kCompileUnit);
+    aInfo.Write(aStrings.Add("unit" + std::to_string(aUnitIndex) + ".cpp"));
+
+    const uint32_t intOffset = unitOffset();
+    aInfo.WriteULEB128(kBaseType);
+    aInfo.Write(aStrings.Add("int"));
+    aInfo.Write<uint8_t>(4);
+    aInfo.Write(kAteSigned);
+
+    // Neighbouring units share half of their types.
+    const uint32_t firstType = aUnitIndex * (aOptions.typesPerUnit / 2);
+
+    std::vector<uint32_t> pointerOffsets{};
+    pointerOffsets.reserve(aOptions.typesPerUnit);
+
+    for (uint32_t i = 0; i < aOptions.typesPerUnit; i++)
+    {
+      const uint32_t typeIndex = (firstType + i) % aOptions.distinctTypeCount;
+
+      const uint32_t structOffset = unitOffset();
+      aInfo.WriteULEB128(kStructure);
+      aInfo.Write(aStrings.Add("Type" + std::to_string(typeIndex)));
+      aInfo.Write<uint32_t>(aOptions.fieldsPerType * 8);
+
+      // The first member points to the struct itself, through the pointer type that
+      // follows the struct, so the members only depend on the name of the struct.
+      size_t selfReference = 0;
+      for (uint32_t j = 0; j < aOptions.fieldsPerType; j++)
+      {
+        aInfo.WriteULEB128(kMember);
+        aInfo.Write(aStrings.Add(j == 0 ? "next" : "m" + std::to_string(j)));
+        if (j == 0)
+          selfReference = aInfo.size();
+        aInfo.Write(intOffset);
+        aInfo.Write<uint8_t>(static_cast<uint8_t>(j * 8));
+      }
+
+      aInfo.WriteULEB128(0);
+
+      const uint32_t pointerOffset = unitOffset();
+      if (aOptions.fieldsPerType != 0)
+        aInfo.Patch(selfReference, pointerOffset);
+
+      aInfo.WriteULEB128(kPointer);
+      aInfo.Write<uint8_t>(8);
+      aInfo.Write(structOffset);
+      pointerOffsets.push_back(pointerOffset);
+    }
+
+    for (uint32_t i = 0; i < aOptions.functionsPerUnit; i++)
+    {
+      const uint64_t functionIndex = static_cast<uint64_t>(aUnitIndex) * aOptions.functionsPerUnit + i;
+
+      aInfo.WriteULEB128(kSubprogram);
+      aInfo.Write(aStrings.Add("Function" + std::to_string(functionIndex)));
+      aInfo.Write(aOptions.typesPerUnit ? pointerOffsets[i % aOptions.typesPerUnit] : intOffset);
+      aInfo.Write(kTextAddress + functionIndex * kFunctionLength);
+      aInfo.Write(static_cast<uint32_t>(kFunctionLength));
+
+      for (uint32_t j = 0; j < aOptions.parametersPerFunction; j++)
+      {
+        aInfo.WriteULEB128(kParameter);
+        aInfo.Write(aStrings.Add("p" + std::to_string(j)));
+        aInfo.Write(j % 2 == 0 || aOptions.typesPerUnit == 0 ? intOffset : pointerOffsets[(i + j) % aOptions.typesPerUnit]);
+      }
+
+      aInfo.WriteULEB128(0);
+    }
+
+    aInfo.WriteULEB128(0);
+
+    aInfo.Patch(unitStart, static_cast<uint32_t>(aInfo.size() - unitStart - sizeof(uint32_t)));
+  }
+
+  // Deflate bits go out least significant bit first, Huffman codes most significant bit first.
+  class BitWriter
+  {
+  public:
+    void Write(uint32_t aValue, unsigned aCount)
+    {
+      bits |= static_cast<uint64_t>(aValue) << count;
+      count += aCount;
+      for (; count >= 8; count -= 8, bits >>= 8)
+        data.push_back(static_cast<uint8_t>(bits));
+    }
+
+    void WriteCode(uint32_t aCode, unsigned aLength)
+    {
+      uint32_t reversed = 0;
+      for (unsigned i = 0; i < aLength; i++)
+        reversed |= ((aCode >> i) & 1) << (aLength - 1 - i);
+      Write(reversed, aLength);
+    }
+
+    void Flush()
+    {
+      if (count != 0)
+        Write(0, 8 - count);
+    }
+
+    std::vector<uint8_t> data{};
+
+  private:
+    uint64_t bits{};
+    unsigned count{};
+  };
+
+  void WriteFixedLiteralLength(BitWriter& aWriter, uint32_t aSymbol)
+  {
+    if (aSymbol < 144)
+      aWriter.WriteCode(0x30 + aSymbol, 8);
+    else if (aSymbol < 256)
+      aWriter.WriteCode(0x190 + aSymbol - 144, 9);
+    else if (aSymbol < 280)
+      aWriter.WriteCode(aSymbol - 256, 7);
+    else
+      aWriter.WriteCode(0xC0 + aSymbol - 280, 8);
+  }
+
+  // A zlib stream of a single fixed Huffman block with greedy LZ77 matches. Compresses worse
+  // than zlib, but decompresses with the same kind of work.
+  std::vector<uint8_t> CompressZlib(const std::vector<uint8_t>& aData)
+  {
+    constexpr uint16_t kLengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr uint8_t kLengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr uint16_t kDistanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr uint8_t kDistanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    constexpr size_t kWindowSize = 32768;
+    constexpr size_t kMaxMatch = 258;
+    constexpr unsigned kHashBits = 15;
+
+    BitWriter writer{};
+    writer.data = { 0x78, 0x01 };
+    writer.Write(1, 1);
+    writer.Write(1, 2);
+
+    std::vector<uint32_t> lastPositions(size_t(1) << kHashBits, UINT32_MAX);
+    for (size_t position = 0; position < aData.size();)
+    {
+      size_t length = 0;
+      size_t distance = 0;
+      if (position + 3 <= aData.size())
+      {
+        const uint32_t hash = ((aData[position] << 16 | aData[position + 1] << 8 | aData[position + 2]) * 2654435761u) >> (32 - kHashBits);
+        const uint32_t candidate = lastPositions[hash];
+        lastPositions[hash] = static_cast<uint32_t>(position);
+
+        if (candidate != UINT32_MAX && position - candidate <= kWindowSize)
+        {
+          const size_t limit = std::min(kMaxMatch, aData.size() - position);
+          while (length < limit && aData[candidate + length] == aData[position + length])
+            length++;
+          distance = position - candidate;
+        }
+      }
+
+      if (length < 3)
+      {
+        WriteFixedLiteralLength(writer, aData[position++]);
+        continue;
+      }
+
+      size_t code = std::size(kLengthBase) - 1;
+      while (kLengthBase[code] > length)
+        code--;
+      WriteFixedLiteralLength(writer, static_cast<uint32_t>(257 + code));
+      writer.Write(static_cast<uint32_t>(length - kLengthBase[code]), kLengthExtra[code]);
+
+      code = std::size(kDistanceBase) - 1;
+      while (kDistanceBase[code] > distance)
+        code--;
+      writer.WriteCode(static_cast<uint32_t>(code), 5);
+      writer.Write(static_cast<uint32_t>(distance - kDistanceBase[code]), kDistanceExtra[code]);
+
+      position += length;
+    }
+
+    WriteFixedLiteralLength(writer, 256);
+    writer.Flush();
+
+    const uint32_t adler = Inflate::Adler32(aData.data(), aData.size());
+    for (int shift = 24; shift >= 0; shift -= 8)
+      writer.data.push_back(static_cast<uint8_t>(adler >> shift));
+    return std::move(writer.data);
+  }
+}
+
+bool WriteSyntheticElf(const char* apFileName, const SyntheticElfOptions& aOptions)
+{
+  enum SectionIndex : uint16_t
+  {
+    kNull,
+    kAbbrev,
+    kInfo,
+    kStr,
+    kSymtab,
+    kStrtab,
+    kShstrtab,
+    kSectionCount
+  };
+
+  const Buffer abbrev = CreateAbbreviations();
+
+  Buffer info{};
+  StringTable debugStrings{};
+  for (uint32_t i = 0; i < aOptions.unitCount; i++)
+    WriteUnit(info, debugStrings, aOptions, i);
+
+  Buffer symtab{};
+  StringTable symbolNames{};
+  symtab.Write(ELF::Elf64_Sym{});
+  for (uint64_t i = 0; i < static_cast<uint64_t>(aOptions.unitCount) * aOptions.functionsPerUnit; i++)
+  {
+    ELF::Elf64_Sym symbol{};
+    // Mangled like real C++ symbols, which are rarely short enough for the small string optimization.
+    const std::string name = "Function" + std::to_string(i);
+    symbol.st_name = symbolNames.Add("_ZN9Synthetic" + std::to_string(name.size()) + name + "EPKvm");
+    symbol.st_info = (ELF::STB_GLOBAL << 4) | ELF::STT_FUNC;
+    symbol.st_shndx = kShnAbs;
+    symbol.st_value = kTextAddress + i * kFunctionLength;
+    symbol.st_size = kFunctionLength;
+    symtab.Write(symbol);
+  }
+
+  StringTable sectionNames{};
+  const Buffer* sectionContents[kSectionCount] = { nullptr, &abbrev, &info, &debugStrings.buffer, &symtab, &symbolNames.buffer, &sectionNames.buffer };
+  const char* sectionNameStrings[kSectionCount] = { "", ".debug_abbrev", ".debug_info", ".debug_str", ".symtab", ".strtab", ".shstrtab" };
+
+  ELF::Elf64_Shdr sections[kSectionCount]{};
+  for (uint16_t i = kAbbrev; i < kSectionCount; i++)
+    sections[i].sh_name = sectionNames.Add(sectionNameStrings[i]);
+
+  Buffer file{};
+  file.Write(ELF::Elf64_Ehdr{});
+  const size_t programHeaderOffset = file.size();
+  file.Write(ELF::Elf64_Phdr{});
+
+  for (uint16_t i = kAbbrev; i < kSectionCount; i++)
+  {
+    file.Align(8);
+
+    ELF::Elf64_Shdr& section = sections[i];
+    section.sh_type = i == kSymtab ? ELF::SHT_SYMTAB : (i == kStrtab || i == kShstrtab ? ELF::SHT_STRTAB : ELF::SHT_PROGBITS);
+    section.sh_offset = file.size();
+    section.sh_size = sectionContents[i]->size();
+    section.sh_addralign = 1;
+
+    const std::vector<uint8_t>& contents = sectionContents[i]->data;
+    if (aOptions.compressDebugSections && i <= kStr)
+    {
+      // Like linking with --compress-debug-sections=zlib.
+      const ELF::Elf64_Chdr compressionHeader{ ELF::ELFCOMPRESS_ZLIB, 0, contents.size(), 1 };
+      const std::vector<uint8_t> stream = CompressZlib(contents);
+      file.Write(compressionHeader);
+      file.data.insert(file.data.end(), stream.begin(), stream.end());
+
+      section.sh_flags |= ELF::SHF_COMPRESSED;
+      section.sh_size = sizeof(compressionHeader) + stream.size();
+      section.sh_addralign = 8;
+      continue;
+    }
+
+    file.data.insert(file.data.end(), contents.begin(), contents.end());
+  }
+
+  sections[kSymtab].sh_link = kStrtab;
+  sections[kSymtab].sh_info = 1;
+  sections[kSymtab].sh_entsize = sizeof(ELF::Elf64_Sym);
+  sections[kSymtab].sh_addralign = 8;
+
+  file.Align(8);
+  const size_t sectionHeaderOffset = file.size();
+  for (const auto& section : sections)
+    file.Write(section);
+
+  ELF::Elf64_Ehdr header{};
+  std::memcpy(header.e_ident, "\x7f" "ELF", 4);
+  header.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+  header.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+  header.e_ident[ELF::EI_VERSION] = 1;
+  header.e_type = 2;
+  header.e_machine = ELF::EM_X86_64;
+  header.e_version = 1;
+  header.e_entry = kTextAddress;
+  header.e_phoff = programHeaderOffset;
+  header.e_shoff = sectionHeaderOffset;
+  header.e_ehsize = sizeof(ELF::Elf64_Ehdr);
+  header.e_phentsize = sizeof(ELF::Elf64_Phdr);
+  header.e_phnum = 1;
+  header.e_shentsize = sizeof(ELF::Elf64_Shdr);
+  header.e_shnum = kSectionCount;
+  header.e_shstrndx = kShstrtab;
+  file.Patch(0, header);
+
+  ELF::Elf64_Phdr programHeader{};
+  programHeader.p_type = kPtLoad;
+  programHeader.p_vaddr = kTextAddress;
+  programHeader.p_paddr = kTextAddress;
+  programHeader.p_align = 0x1000;
+  file.Patch(programHeaderOffset, programHeader);
+
+  std::ofstream output(apFileName, std::ios::binary | std::ios::trunc);
+  output.write(reinterpret_cast<const char*>(file.data.data()), file.data.size());
+  return output.good();
+}
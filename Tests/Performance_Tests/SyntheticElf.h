@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Shape of a generated x86-64 ELF file with DWARF 4 debug information.
+// Every compile unit has its own copy of the struct types it uses, like a real
+// program where many source files include the same headers.
+struct SyntheticElfOptions
+{
+  uint32_t unitCount = 64;
+  uint32_t typesPerUnit = 200;
+  // Struct names are drawn from this many names; equal names have equal members in every unit.
+  uint32_t distinctTypeCount = 2000;
+  uint32_t fieldsPerType = 6;
+  uint32_t functionsPerUnit = 100;
+  uint32_t parametersPerFunction = 2;
+  // Stores the debug sections zlib compressed, with SHF_COMPRESSED.
+  bool compressDebugSections = false;
+};
+
+// Writes .debug_abbrev, .debug_info, .debug_str and a .symtab with one symbol per function.
+bool WriteSyntheticElf(const char* apFileName, const SyntheticElfOptions& aOptions);
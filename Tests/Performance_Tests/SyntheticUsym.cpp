@@ -0,0 +1,141 @@
+#include "SyntheticUsym.h"
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using Type = USYM::TypeSymbol::Type;
+
+  // std::mt19937 is fully specified, unlike the standard distributions,
+  // so only the raw engine output is used.
+  class Random
+  {
+  public:
+    explicit Random(uint32_t aSeed)
+      : engine(aSeed)
+    {}
+
+    uint32_t Next(uint32_t aBound)
+    {
+      return aBound == 0 ? 0 : static_cast<uint32_t>(engine() % aBound);
+    }
+
+    double NextUnit()
+    {
+      return engine() / 4294967296.0;
+    }
+
+  private:
+    std::mt19937 engine;
+  };
+
+  std::string CreateName(Random& aRandom, const SyntheticUsymOptions& aOptions, char aPrefix, uint32_t aIndex)
+  {
+    // The prefix and index keep names unique, the rest pads them to the drawn length.
+    std::string name = aPrefix + std::to_string(aIndex) + "_";
+
+    const double skew = aRandom.NextUnit();
+    const uint32_t range = aOptions.maxNameLength > aOptions.minNameLength ? aOptions.maxNameLength - aOptions.minNameLength : 0;
+    const size_t length = aOptions.minNameLength + static_cast<size_t>(range * skew * skew);
+
+    while (name.size() < length)
+      name += static_cast<char>('a' + aRandom.Next(26));
+
+    return name;
+  }
+}
+
+USYM CreateSyntheticUsym(const SyntheticUsymOptions& aOptions)
+{
+  constexpr const char* kBaseTypes[] = { "char", "short", "int", "long long", "float", "double", "bool", "unsigned int" };
+  constexpr uint64_t kBaseTypeLengths[] = { 1, 2, 4, 8, 4, 8, 1, 4 };
+  constexpr uint32_t kBaseTypeCount = static_cast<uint32_t>(std::size(kBaseTypes));
+
+  Random random(aOptions.seed);
+
+  USYM usym{};
+  usym.header.originalFormat = USYM::OriginalFormat::kDwarf;
+  usym.header.architecture = USYM::Architecture::kX86_64;
+  usym.typeSymbols.reserve(kBaseTypeCount + aOptions.typeCount);
+  usym.functionSymbols.reserve(aOptions.functionCount);
+
+  std::vector<uint32_t> typeIds{};
+  typeIds.reserve(kBaseTypeCount + aOptions.typeCount);
+
+  uint32_t nextId = 1;
+
+  for (uint32_t i = 0; i < kBaseTypeCount; i++)
+  {
+    USYM::TypeSymbol& symbol = usym.typeSymbols[nextId];
+    symbol.id = nextId;
+    symbol.name = usym.Intern(kBaseTypes[i]);
+    symbol.type = Type::kBase;
+    symbol.length = kBaseTypeLengths[i];
+    typeIds.push_back(nextId++);
+  }
+
+  // Structs that were not copied from another struct; the candidates for duplicates.
+  std::vector<uint32_t> originals{};
+
+  for (uint32_t i = 0; i < aOptions.typeCount; i++)
+  {
+    const uint32_t id = nextId++;
+
+    if (!originals.empty() && random.NextUnit() < aOptions.duplicateRatio)
+    {
+      // Copy first, inserting can move the original.
+      USYM::TypeSymbol copy = usym.typeSymbols.at(originals[random.Next(static_cast<uint32_t>(originals.size()))]);
+      copy.id = id;
+      for (auto& field : copy.fields)
+        field.id = nextId++;
+
+      usym.typeSymbols[id] = std::move(copy);
+      typeIds.push_back(id);
+      continue;
+    }
+
+    USYM::TypeSymbol& symbol = usym.typeSymbols[id];
+    symbol.id = id;
+    symbol.name = usym.Intern(CreateName(random, aOptions, 'S', i));
+    symbol.type = Type::kStruct;
+
+    const uint32_t fieldCount = random.Next(aOptions.fieldFanOut * 2 + 1);
+    symbol.fields.reserve(fieldCount);
+
+    for (uint32_t j = 0; j < fieldCount; j++)
+    {
+      // Fields only use types that already exist, so the type graph has no cycles.
+      USYM::FieldSymbol& field = symbol.fields.emplace_back();
+      field.id = nextId++;
+      field.name = usym.Intern("m" + std::to_string(j));
+      field.underlyingTypeId = typeIds[random.Next(static_cast<uint32_t>(typeIds.size()))];
+      field.offset = symbol.length;
+      symbol.length += 8;
+    }
+
+    symbol.fieldCount = symbol.fields.size();
+    originals.push_back(id);
+    typeIds.push_back(id);
+  }
+
+  for (uint32_t i = 0; i < aOptions.functionCount; i++)
+  {
+    const uint32_t id = nextId++;
+
+    USYM::FunctionSymbol& function = usym.functionSymbols[id];
+    function.id = id;
+    function.name = usym.Intern(CreateName(random, aOptions, 'F', i));
+    function.returnTypeId = typeIds[random.Next(static_cast<uint32_t>(typeIds.size()))];
+    function.argumentCount = random.Next(5);
+    for (uint32_t j = 0; j < function.argumentCount; j++)
+      function.argumentTypeIds.push_back(typeIds[random.Next(static_cast<uint32_t>(typeIds.size()))]);
+    function.callingConvention = USYM::CallingConvention::kNearC;
+    function.virtualAddress = 0x401000 + static_cast<size_t>(i) * 0x40;
+    function.length = 0x30;
+  }
+
+  return usym;
+}
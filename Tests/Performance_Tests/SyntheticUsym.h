@@ -0,0 +1,25 @@
+#pragma once
+
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include <cstdint>
+
+// Shape of a generated USYM. The same options and seed always give the same USYM,
+// on every platform, so results of different machines and commits can be compared.
+struct SyntheticUsymOptions
+{
+  uint32_t typeCount = 10000;
+  // Structs get between 0 and twice this many fields.
+  uint32_t fieldFanOut = 8;
+  // Share of the structs that are copies of an earlier struct under a new id,
+  // like the types of a header that is included in many compile units.
+  double duplicateRatio = 0.5;
+  // Most names are close to the minimum length, with a long tail up to the maximum,
+  // which is roughly what mangled and templated C++ names look like.
+  uint32_t minNameLength = 4;
+  uint32_t maxNameLength = 64;
+  uint32_t functionCount = 10000;
+  uint32_t seed = 1;
+};
+
+USYM CreateSyntheticUsym(const SyntheticUsymOptions& aOptions);
@@ -1,7 +1,25 @@
 #include <benchmark/benchmark.h>
 
+#ifdef _WIN32
 #include <DiaProcessor/DiaInterface.h>
+#endif
+#include <ElfProcessor/ElfEx.h>
+#include <ElfProcessor/ElfInterface.h>
+#include <UniversalSymbolsFormat/BatchSymbolizer.h>
 #include <UniversalSymbolsFormat/Serializers/ISerializer.h>
+#include <UniversalSymbolsFormat/UsymView.h>
+
+#include "SyntheticElf.h"
+#include "SyntheticUsym.h"
+
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
 
 static void BM_DiaProcessorSmall(benchmark::State& state) {
   for (auto _ : state)
@@ -41,6 +59,28 @@ static void BM_JsonSerializerLarge(benchmark::State& state) {
 }
 BENCHMARK(BM_JsonSerializerLarge)->Unit(benchmark::kMillisecond);
 
+static void BM_StreamingJsonSerializerSmall(benchmark::State& state) {
+  USYM usym = DiaInterface::CreateUsymFromFile("CppApp1.pdb").value();
+  usym.SetSerializer(ISerializer::Type::kStreamingJson);
+
+  for (auto _ : state)
+  {
+    usym.Serialize("CppApp1");
+  }
+}
+BENCHMARK(BM_StreamingJsonSerializerSmall)->Unit(benchmark::kMillisecond);
+
+static void BM_StreamingJsonSerializerLarge(benchmark::State& state) {
+  USYM usym = DiaInterface::CreateUsymFromFile("binding.pdb").value();
+  usym.SetSerializer(ISerializer::Type::kStreamingJson);
+
+  for (auto _ : state)
+  {
+    usym.Serialize("binding");
+  }
+}
+BENCHMARK(BM_StreamingJsonSerializerLarge)->Unit(benchmark::kMillisecond);
+
 static void BM_BinarySerializerSmall(benchmark::State& state) {
   USYM usym = DiaInterface::CreateUsymFromFile("CppApp1.pdb").value();
   usym.SetSerializer(ISerializer::Type::kBinary);
@@ -63,4 +103,465 @@ static void BM_BinarySerializerLarge(benchmark::State& state) {
 }
 BENCHMARK(BM_BinarySerializerLarge)->Unit(benchmark::kMillisecond);
 
+static void BM_BinaryDeserializerSmall(benchmark::State& state) {
+  USYM original = DiaInterface::CreateUsymFromFile("CppApp1.pdb").value();
+  original.SetSerializer(ISerializer::Type::kBinary);
+  original.Serialize("CppApp1");
+
+  for (auto _ : state)
+  {
+    USYM usym{};
+    usym.Deserialize("CppApp1.usym");
+  }
+}
+BENCHMARK(BM_BinaryDeserializerSmall)->Unit(benchmark::kMillisecond);
+
+static void BM_BinaryDeserializerLarge(benchmark::State& state) {
+  USYM original = DiaInterface::CreateUsymFromFile("binding.pdb").value();
+  original.SetSerializer(ISerializer::Type::kBinary);
+  original.Serialize("binding");
+
+  for (auto _ : state)
+  {
+    USYM usym{};
+    usym.Deserialize("binding.usym");
+  }
+}
+BENCHMARK(BM_BinaryDeserializerLarge)->Unit(benchmark::kMillisecond);
+
+// Baselines for the deserializer: only parsing the JSON output, without building a USYM from it.
+static void BM_JsonParseSmall(benchmark::State& state) {
+  USYM original = DiaInterface::CreateUsymFromFile("CppApp1.pdb").value();
+  original.SetSerializer(ISerializer::Type::kJson);
+  original.Serialize("CppApp1");
+
+  for (auto _ : state)
+  {
+    std::ifstream file("CppApp1.json");
+    nlohmann::json json = nlohmann::json::parse(file);
+    benchmark::DoNotOptimize(json);
+  }
+}
+BENCHMARK(BM_JsonParseSmall)->Unit(benchmark::kMillisecond);
+
+static void BM_JsonParseLarge(benchmark::State& state) {
+  USYM original = DiaInterface::CreateUsymFromFile("binding.pdb").value();
+  original.SetSerializer(ISerializer::Type::kJson);
+  original.Serialize("binding");
+
+  for (auto _ : state)
+  {
+    std::ifstream file("binding.json");
+    nlohmann::json json = nlohmann::json::parse(file);
+    benchmark::DoNotOptimize(json);
+  }
+}
+BENCHMARK(BM_JsonParseLarge)->Unit(benchmark::kMillisecond);
+
+static void BM_UsymViewFindFunctionLarge(benchmark::State& state) {
+  USYM original = DiaInterface::CreateUsymFromFile("binding.pdb").value();
+  original.SetSerializer(ISerializer::Type::kIndexedBinary);
+  original.Serialize("binding_indexed");
+
+  std::vector<std::string> names{};
+  for (const auto& [id, function] : original.functionSymbols)
+    names.emplace_back(function.name);
+
+  UsymView view{};
+  view.Open("binding_indexed.usym");
+
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const auto* pFunction = view.FindFunctionByName(names[i++ % names.size()]);
+    benchmark::DoNotOptimize(pFunction);
+  }
+}
+BENCHMARK(BM_UsymViewFindFunctionLarge)->Unit(benchmark::kMicrosecond);
+
+#endif
+
+// Synthetic benchmarks, which run on every platform and need no input files.
+// The first argument is the number of types and functions, the second the percentage of duplicate structs.
+
+static SyntheticUsymOptions GetSyntheticOptions(const benchmark::State& state) {
+  SyntheticUsymOptions options{};
+  options.typeCount = static_cast<uint32_t>(state.range(0));
+  options.functionCount = static_cast<uint32_t>(state.range(0));
+  options.duplicateRatio = state.range(1) / 100.0;
+  return options;
+}
+
+static void SyntheticArguments(benchmark::internal::Benchmark* pBenchmark) {
+  for (int64_t count : { 1 << 12, 1 << 16 })
+  {
+    for (int64_t duplicatePercentage : { 0, 50, 90 })
+      pBenchmark->Args({ count, duplicatePercentage });
+  }
+}
+
+static void BM_SyntheticPurgeDuplicateTypes(benchmark::State& state) {
+  const SyntheticUsymOptions options = GetSyntheticOptions(state);
+
+  for (auto _ : state)
+  {
+    // Purging changes the USYM, so every iteration starts from a fresh one.
+    state.PauseTiming();
+    USYM usym = CreateSyntheticUsym(options);
+    state.ResumeTiming();
+
+    usym.PurgeDuplicateTypes();
+    size_t typeCount = usym.typeSymbols.size();
+    benchmark::DoNotOptimize(typeCount);
+
+    state.PauseTiming();
+    usym = USYM{};
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * options.typeCount);
+}
+BENCHMARK(BM_SyntheticPurgeDuplicateTypes)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+
+static void BM_SyntheticVerifyTypeIds(benchmark::State& state) {
+  const SyntheticUsymOptions options = GetSyntheticOptions(state);
+  USYM usym = CreateSyntheticUsym(options);
+
+  for (auto _ : state)
+  {
+    bool isValid = usym.VerifyTypeIds();
+    benchmark::DoNotOptimize(isValid);
+  }
+
+  state.SetItemsProcessed(state.iterations() * (options.typeCount + options.functionCount));
+}
+BENCHMARK(BM_SyntheticVerifyTypeIds)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+
+// The third argument is the number of threads.
+static void BM_SyntheticVerifyTypeIdsThreads(benchmark::State& state) {
+  const SyntheticUsymOptions options = GetSyntheticOptions(state);
+  const USYM usym = CreateSyntheticUsym(options);
+
+  USYM::VerifyOptions verifyOptions{};
+  verifyOptions.threadCount = static_cast<size_t>(state.range(2));
+
+  for (auto _ : state)
+  {
+    bool isValid = usym.VerifyTypeIds(verifyOptions).IsValid();
+    benchmark::DoNotOptimize(isValid);
+  }
+
+  state.SetItemsProcessed(state.iterations() * (options.typeCount + options.functionCount));
+}
+BENCHMARK(BM_SyntheticVerifyTypeIdsThreads)->ArgsProduct({ { 1 << 20 }, { 0 }, { 1, 2, 4, 8 } })->Unit(benchmark::kMillisecond);
+
+static void BM_SyntheticGetTypeSymbolByName(benchmark::State& state) {
+  USYM usym = CreateSyntheticUsym(GetSyntheticOptions(state));
+
+  std::vector<std::string> names{};
+  for (const auto& [id, symbol] : usym.typeSymbols)
+    names.emplace_back(symbol.name);
+
+  // The first lookup builds the name index.
+  usym.GetTypeSymbolByName(names[0]);
+
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const USYM::TypeSymbol* pSymbol = &usym.GetTypeSymbolByName(names[i++ % names.size()].c_str());
+    benchmark::DoNotOptimize(pSymbol);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticGetTypeSymbolByName)->Args({ 1 << 12, 0 })->Args({ 1 << 16, 0 })->Args({ 1 << 20, 0 })->Unit(benchmark::kMicrosecond);
+
+// Baseline for the name index: the linear scan that GetTypeSymbolByName used to do.
+static void BM_SyntheticScanTypeSymbolByName(benchmark::State& state) {
+  USYM usym = CreateSyntheticUsym(GetSyntheticOptions(state));
+
+  std::vector<std::string> names{};
+  for (const auto& [id, symbol] : usym.typeSymbols)
+    names.emplace_back(symbol.name);
+
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const std::string_view name = usym.strings.Find(names[i++ % names.size()]);
+    for (const auto& [id, symbol] : usym.typeSymbols)
+    {
+      if (StringPool::IsSame(symbol.name, name))
+      {
+        const USYM::TypeSymbol* pSymbol = &symbol;
+        benchmark::DoNotOptimize(pSymbol);
+        break;
+      }
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticScanTypeSymbolByName)->Args({ 1 << 12, 0 })->Args({ 1 << 16, 0 })->Unit(benchmark::kMicrosecond);
+
+// Symbolizes a batch of random addresses inside and between the synthetic functions.
+static void BM_SyntheticSymbolize(benchmark::State& state) {
+  SyntheticUsymOptions options = GetSyntheticOptions(state);
+  options.typeCount = 64;
+  USYM usym = CreateSyntheticUsym(options);
+
+  std::mt19937_64 random(options.seed);
+  std::vector<uint64_t> addresses(4096);
+  for (uint64_t& address : addresses)
+    address = 0x401000 + random() % (static_cast<uint64_t>(options.functionCount) * 0x40);
+
+  // The first lookup builds the address index.
+  usym.Symbolize(addresses[0]);
+
+  for (auto _ : state)
+  {
+    std::vector<const USYM::FunctionSymbol*> functions = usym.Symbolize(addresses);
+    benchmark::DoNotOptimize(functions);
+  }
+
+  state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+BENCHMARK(BM_SyntheticSymbolize)->Args({ 1 << 12, 0 })->Args({ 1 << 16, 0 })->Args({ 1 << 20, 0 })->Unit(benchmark::kMicrosecond);
+
+// The same batches through BatchSymbolizer, which sorts them and sweeps the functions of a mapped file.
+static void BM_SyntheticBatchSymbolizer(benchmark::State& state) {
+  SyntheticUsymOptions options = GetSyntheticOptions(state);
+  options.typeCount = 64;
+  USYM usym = CreateSyntheticUsym(options);
+  usym.SetSerializer(ISerializer::Type::kIndexedBinary);
+  usym.Serialize("SyntheticSymbolizer");
+
+  BatchSymbolizer symbolizer{};
+  symbolizer.AddFile("SyntheticSymbolizer.usym");
+
+  std::mt19937_64 random(options.seed);
+  std::vector<uint64_t> addresses(4096);
+  for (uint64_t& address : addresses)
+    address = 0x401000 + random() % (static_cast<uint64_t>(options.functionCount) * 0x40);
+
+  std::vector<BatchSymbolizer::Result> results(addresses.size());
+  for (auto _ : state)
+  {
+    symbolizer.Symbolize(addresses, results);
+    benchmark::DoNotOptimize(results);
+  }
+
+  state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+BENCHMARK(BM_SyntheticBatchSymbolizer)->Args({ 1 << 12, 0 })->Args({ 1 << 16, 0 })->Args({ 1 << 20, 0 })->Unit(benchmark::kMicrosecond);
+
+// Serialize() also purges duplicates and verifies the type ids. The USYM is purged
+// before timing, so the timed purges find nothing to remove.
+static void BM_SyntheticSerializer(benchmark::State& state, ISerializer::Type aType) {
+  const SyntheticUsymOptions options = GetSyntheticOptions(state);
+  USYM usym = CreateSyntheticUsym(options);
+  usym.PurgeDuplicateTypes();
+  usym.SetSerializer(aType);
+
+  for (auto _ : state)
+  {
+    if (usym.Serialize("synthetic") != ISerializer::SerializeResult::kOk)
+    {
+      state.SkipWithError("Serializing failed.");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * (options.typeCount + options.functionCount));
+}
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, Binary, ISerializer::Type::kBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, CompactBinary, ISerializer::Type::kCompactBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, CompressedBinary, ISerializer::Type::kCompressedBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, IndexedBinary, ISerializer::Type::kIndexedBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, Json, ISerializer::Type::kJson)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticSerializer, StreamingJson, ISerializer::Type::kStreamingJson)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+
+static void BM_SyntheticDeserializer(benchmark::State& state, ISerializer::Type aType) {
+  const SyntheticUsymOptions options = GetSyntheticOptions(state);
+  {
+    USYM original = CreateSyntheticUsym(options);
+    original.SetSerializer(aType);
+    original.Serialize("synthetic_load");
+  }
+  state.counters["fileSize"] = static_cast<double>(std::filesystem::file_size("synthetic_load.usym"));
+
+  for (auto _ : state)
+  {
+    USYM usym{};
+    if (usym.Deserialize("synthetic_load.usym") != IDeserializer::DeserializeResult::kOk)
+    {
+      state.SkipWithError("Deserializing failed.");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * (options.typeCount + options.functionCount));
+}
+BENCHMARK_CAPTURE(BM_SyntheticDeserializer, Binary, ISerializer::Type::kBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticDeserializer, CompactBinary, ISerializer::Type::kCompactBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticDeserializer, CompressedBinary, ISerializer::Type::kCompressedBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SyntheticDeserializer, IndexedBinary, ISerializer::Type::kIndexedBinary)->Apply(SyntheticArguments)->Unit(benchmark::kMillisecond);
+
+static void BM_SyntheticUsymViewOpen(benchmark::State& state) {
+  {
+    USYM original = CreateSyntheticUsym(GetSyntheticOptions(state));
+    original.SetSerializer(ISerializer::Type::kIndexedBinary);
+    original.Serialize("synthetic_view");
+  }
+
+  for (auto _ : state)
+  {
+    UsymView view{};
+    if (!view.Open("synthetic_view.usym"))
+    {
+      state.SkipWithError("Opening the view failed.");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_SyntheticUsymViewOpen)->Args({ 1 << 16, 50 })->Unit(benchmark::kMicrosecond);
+
+static void BM_SyntheticUsymViewFindFunctionByName(benchmark::State& state) {
+  std::vector<std::string> names{};
+  {
+    USYM original = CreateSyntheticUsym(GetSyntheticOptions(state));
+    original.SetSerializer(ISerializer::Type::kIndexedBinary);
+    original.Serialize("synthetic_view");
+
+    for (const auto& [id, function] : original.functionSymbols)
+      names.emplace_back(function.name);
+  }
+
+  UsymView view{};
+  view.Open("synthetic_view.usym");
+
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    const auto* pFunction = view.FindFunctionByName(names[i++ % names.size()]);
+    benchmark::DoNotOptimize(pFunction);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticUsymViewFindFunctionByName)->Args({ 1 << 16, 50 })->Unit(benchmark::kMicrosecond);
+
+// Opens a generated ELF file and looks at its architecture and build id, which does not read
+// the symbol tables. The first argument is the number of compile units.
+static void BM_SyntheticElfOpen(benchmark::State& state) {
+  SyntheticElfOptions options{};
+  options.unitCount = static_cast<uint32_t>(state.range(0));
+
+  const std::string fileName = "synthetic_" + std::to_string(options.unitCount) + ".elf";
+  if (!WriteSyntheticElf(fileName.c_str(), options))
+  {
+    state.SkipWithError("Writing the ELF file failed.");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    ElfInterface::ElfEx elf{};
+    if (!elf.Parse(fileName.c_str()))
+    {
+      state.SkipWithError("Parsing the ELF file failed.");
+      break;
+    }
+    USYM::Architecture architecture = elf.GetArchitecture();
+    std::span<const uint8_t> buildId = elf.GetBuildId();
+    benchmark::DoNotOptimize(architecture);
+    benchmark::DoNotOptimize(buildId);
+  }
+}
+BENCHMARK(BM_SyntheticElfOpen)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+// Parses the headers and the symbol table of a generated ELF file, the first argument is the number of compile units.
+static void BM_SyntheticElfParse(benchmark::State& state) {
+  SyntheticElfOptions options{};
+  options.unitCount = static_cast<uint32_t>(state.range(0));
+
+  const std::string fileName = "synthetic_" + std::to_string(options.unitCount) + ".elf";
+  if (!WriteSyntheticElf(fileName.c_str(), options))
+  {
+    state.SkipWithError("Writing the ELF file failed.");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    ElfInterface::ElfEx elf{};
+    if (!elf.Parse(fileName.c_str()))
+    {
+      state.SkipWithError("Parsing the ELF file failed.");
+      break;
+    }
+    const ElfInterface::Elf_SymEx* pSymbols = elf.GetSymbols().data();
+    benchmark::DoNotOptimize(pSymbols);
+  }
+
+  state.SetItemsProcessed(state.iterations() * options.unitCount * options.functionsPerUnit);
+}
+BENCHMARK(BM_SyntheticElfParse)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+// Converts a generated ELF file. The first argument is the number of compile units, the second the thread count.
+static void BM_SyntheticElfProcessor(benchmark::State& state) {
+  SyntheticElfOptions options{};
+  options.unitCount = static_cast<uint32_t>(state.range(0));
+
+  const std::string fileName = "synthetic_" + std::to_string(options.unitCount) + ".elf";
+  if (!WriteSyntheticElf(fileName.c_str(), options))
+  {
+    state.SkipWithError("Writing the ELF file failed.");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    if (!ElfInterface::CreateUsymFromFile(fileName.c_str(), static_cast<size_t>(state.range(1))))
+    {
+      state.SkipWithError("Converting the ELF file failed.");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * options.unitCount);
+}
+BENCHMARK(BM_SyntheticElfProcessor)
+  ->ArgsProduct({ { 16, 256 }, { 1, 2, 4, 8 } })
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+// BM_SyntheticElfProcessor with zlib compressed debug sections, to compare against.
+static void BM_SyntheticCompressedElfProcessor(benchmark::State& state) {
+  SyntheticElfOptions options{};
+  options.unitCount = static_cast<uint32_t>(state.range(0));
+  options.compressDebugSections = true;
+
+  const std::string fileName = "synthetic_compressed_" + std::to_string(options.unitCount) + ".elf";
+  if (!WriteSyntheticElf(fileName.c_str(), options))
+  {
+    state.SkipWithError("Writing the ELF file failed.");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    if (!ElfInterface::CreateUsymFromFile(fileName.c_str(), static_cast<size_t>(state.range(1))))
+    {
+      state.SkipWithError("Converting the ELF file failed.");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * options.unitCount);
+}
+BENCHMARK(BM_SyntheticCompressedElfProcessor)
+  ->ArgsProduct({ { 16, 256 }, { 1, 2, 4, 8 } })
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -14,6 +14,8 @@ project "Performance_Tests"
    includedirs
    {
       "../../Components",
+      "../../Libraries/RECore",
+      "../../Vendor/json",
       "../../Vendor/benchmark/include"
    }
 
@@ -23,6 +25,16 @@ project "Performance_Tests"
    }
 
    links "benchmark"
-   links "Shlwapi"
-   links "DiaProcessor"
-   links "UniversalSymbolsFormat"
\ No newline at end of file
+   links "ElfProcessor"
+   links "UniversalSymbolsFormat"
+   links "RECore"
+
+   -- The PDB benchmarks need the DIA SDK; everything else runs on every platform.
+   filter { "system:windows" }
+      links "Shlwapi"
+      links "DiaProcessor"
+
+   filter { "system:linux" }
+      links "pthread"
+
+   filter { }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+  USYM::FunctionSymbol& AddFunction(USYM& aUsym, uint32_t aId, size_t aVirtualAddress, uint64_t aLength)
+  {
+    USYM::FunctionSymbol& function = aUsym.functionSymbols[aId];
+    function.id = aId;
+    function.virtualAddress = aVirtualAddress;
+    function.length = aLength;
+    return function;
+  }
+
+  uint32_t SymbolizeId(const USYM& aUsym, uint64_t aAddress)
+  {
+    const USYM::FunctionSymbol* pFunction = aUsym.Symbolize(aAddress);
+    return pFunction ? pFunction->id : 0;
+  }
+
+  TEST(AddressIndex, FindsContainingFunction)
+  {
+    USYM usym{};
+    AddFunction(usym, 3, 0x3000, 0x100);
+    AddFunction(usym, 1, 0x1000, 0x10);
+    AddFunction(usym, 2, 0x2000, 0);
+    AddFunction(usym, 4, 0, 0x100);
+
+    EXPECT_EQ(SymbolizeId(usym, 0x0), 0);
+    EXPECT_EQ(SymbolizeId(usym, 0xFFF), 0);
+    EXPECT_EQ(SymbolizeId(usym, 0x1000), 1);
+    EXPECT_EQ(SymbolizeId(usym, 0x100F), 1);
+    EXPECT_EQ(SymbolizeId(usym, 0x1010), 0);
+
+    // Without a length, only the first address is known to be in the function.
+    EXPECT_EQ(SymbolizeId(usym, 0x2000), 2);
+    EXPECT_EQ(SymbolizeId(usym, 0x2001), 0);
+
+    EXPECT_EQ(SymbolizeId(usym, 0x30FF), 3);
+    EXPECT_EQ(SymbolizeId(usym, 0x3100), 0);
+    EXPECT_EQ(SymbolizeId(usym, UINT64_MAX), 0);
+  }
+
+  TEST(AddressIndex, PrefersFirstOfFoldedFunctions)
+  {
+    USYM usym{};
+    AddFunction(usym, 2, 0x1000, 0x10);
+    AddFunction(usym, 1, 0x1000, 0x10);
+
+    EXPECT_EQ(SymbolizeId(usym, 0x1008), 2);
+  }
+
+  TEST(AddressIndex, SeesAddedFunctions)
+  {
+    USYM usym{};
+    EXPECT_EQ(SymbolizeId(usym, 0x1000), 0);
+
+    AddFunction(usym, 1, 0x1000, 0x10);
+    EXPECT_EQ(SymbolizeId(usym, 0x1000), 1);
+
+    usym.functionSymbols.at(1).virtualAddress = 0x2000;
+    usym.InvalidateIndexes();
+    EXPECT_EQ(SymbolizeId(usym, 0x1000), 0);
+    EXPECT_EQ(SymbolizeId(usym, 0x2000), 1);
+  }
+
+  TEST(AddressIndex, MatchesLinearSearch)
+  {
+    std::mt19937 random(7);
+
+    // Every tree shape, from empty to a few full levels deep.
+    for (uint32_t count = 0; count < 70; count++)
+    {
+      USYM usym{};
+      size_t address = 0x1000;
+      for (uint32_t i = 0; i < count; i++)
+      {
+        address += random() % 0x20;
+        AddFunction(usym, i + 1, address, random() % 0x20);
+        address += std::max<uint64_t>(usym.functionSymbols.at(i + 1).length, 1);
+      }
+
+      std::vector<uint64_t> addresses{};
+      for (uint64_t i = 0xFF0; i < address + 0x10; i++)
+        addresses.push_back(i);
+
+      const auto functions = usym.Symbolize(addresses);
+      ASSERT_EQ(functions.size(), addresses.size());
+
+      for (size_t i = 0; i < addresses.size(); i++)
+      {
+        const USYM::FunctionSymbol* pExpected = nullptr;
+        for (const auto& [id, function] : usym.functionSymbols)
+        {
+          const uint64_t end = function.virtualAddress + std::max<uint64_t>(function.length, 1);
+          if (addresses[i] >= function.virtualAddress && addresses[i] < end)
+          {
+            pExpected = &function;
+            break;
+          }
+        }
+
+        ASSERT_EQ(functions[i], pExpected) << "count " << count << ", address " << addresses[i];
+      }
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <BatchScheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  TEST(BatchScheduler, RunsLargestFirst)
+  {
+    const std::vector<uint64_t> sizes{ 10, 300, 20, 300, 0, 50 };
+    std::vector<size_t> order{};
+
+    const auto timings = RunBatch(sizes, [&](size_t aIndex, size_t aThreadIndex) {
+      EXPECT_EQ(aThreadIndex, 0u);
+      order.push_back(aIndex);
+      return aIndex != 2;
+    }, { .threadCount = 1 });
+
+    // Inputs of the same size keep their order.
+    EXPECT_EQ(order, (std::vector<size_t>{ 1, 3, 5, 2, 0, 4 }));
+
+    ASSERT_EQ(timings.size(), sizes.size());
+    for (size_t i = 0; i < timings.size(); i++)
+    {
+      EXPECT_EQ(timings[i].succeeded, i != 2) << i;
+      EXPECT_GE(timings[i].seconds, 0.0);
+    }
+
+    // Started one after the other.
+    for (size_t i = 1; i < order.size(); i++)
+      EXPECT_GE(timings[order[i]].startSeconds, timings[order[i - 1]].startSeconds + timings[order[i - 1]].seconds);
+
+    EXPECT_TRUE(RunBatch({}, [](size_t, size_t) { return true; }).empty());
+  }
+
+  TEST(BatchScheduler, BoundsBytesInFlight)
+  {
+    constexpr uint64_t kMaxBytesInFlight = 100;
+
+    // 250 is over the bound on its own and has to run alone.
+    const std::vector<uint64_t> sizes{ 60, 40, 250, 30, 30, 30, 70, 10, 10, 90, 50, 20 };
+
+    std::mutex mutex{};
+    uint64_t bytesInFlight = 0;
+    uint64_t mostBytesInFlight = 0;
+    std::vector<int> callCounts(sizes.size());
+
+    const auto timings = RunBatch(sizes, [&](size_t aIndex, size_t) {
+      {
+        std::lock_guard lock(mutex);
+        callCounts[aIndex]++;
+        bytesInFlight += sizes[aIndex];
+        if (sizes[aIndex] <= kMaxBytesInFlight)
+          mostBytesInFlight = std::max(mostBytesInFlight, bytesInFlight);
+        else
+          EXPECT_EQ(bytesInFlight, sizes[aIndex]);
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+      std::lock_guard lock(mutex);
+      bytesInFlight -= sizes[aIndex];
+      return true;
+    }, { .threadCount = 4, .maxBytesInFlight = kMaxBytesInFlight });
+
+    EXPECT_EQ(callCounts, std::vector<int>(sizes.size(), 1));
+    EXPECT_LE(mostBytesInFlight, kMaxBytesInFlight);
+    EXPECT_TRUE(std::all_of(timings.begin(), timings.end(), [](const BatchTiming& aTiming) {
+      return aTiming.succeeded && aTiming.threadIndex < 4;
+    }));
+  }
+
+  TEST(BatchScheduler, ListsFilesAndReadsManifests)
+  {
+    const std::filesystem::path directory = "BatchSchedulerFiles";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "Nested");
+    std::ofstream(directory / "a.pdb") << "12345";
+    std::ofstream(directory / "b.txt") << "1";
+    std::ofstream(directory / "Nested" / "c.pdb") << "123";
+
+    std::vector<std::string> fileNames{};
+    ASSERT_TRUE(ListFiles(directory.string(), [](const std::string& aFileName) {
+      return aFileName.ends_with(".pdb");
+    }, fileNames));
+    std::sort(fileNames.begin(), fileNames.end());
+
+    ASSERT_EQ(fileNames.size(), 2u);
+    EXPECT_EQ(std::filesystem::path(fileNames[0]), directory / "Nested" / "c.pdb");
+    EXPECT_EQ(std::filesystem::path(fileNames[1]), directory / "a.pdb");
+    EXPECT_EQ(GetFileSizes(fileNames), (std::vector<uint64_t>{ 3, 5 }));
+    EXPECT_FALSE(ListFiles("DoesNotExist", [](const std::string&) { return true; }, fileNames));
+
+    const std::string manifest = (directory / "Manifest.txt").string();
+    std::ofstream(manifest, std::ios::binary) << "# Comment\r\nfirst.so\r\n\nsecond.so\nthird.so";
+
+    std::vector<std::string> listed{};
+    ASSERT_TRUE(ReadFileList(manifest, listed));
+    EXPECT_EQ(listed, (std::vector<std::string>{ "first.so", "second.so", "third.so" }));
+    EXPECT_EQ(GetFileSizes(listed), (std::vector<uint64_t>{ 0, 0, 0 }));
+    EXPECT_FALSE(ReadFileList("DoesNotExist.txt", listed));
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST(BatchScheduler, WritesTimingsAndCountsFailures)
+  {
+    const std::vector<std::string> inputs{ "a.so", "b.so", "c.so" };
+    const std::vector<uint64_t> sizes{ 2048, 10, 0 };
+    const std::vector<BatchTiming> timings{
+      { .startSeconds = 0.0, .seconds = 1.5, .threadIndex = 0, .succeeded = true },
+      { .startSeconds = 0.0, .seconds = 0.25, .threadIndex = 1, .succeeded = false },
+      { .startSeconds = 0.25, .seconds = 2.0, .threadIndex = 1, .succeeded = true },
+    };
+
+    const std::string fileName = "BatchTimings.csv";
+    ASSERT_TRUE(WriteBatchTimings(fileName, inputs, sizes, timings));
+
+    std::ifstream file(fileName);
+    std::vector<std::string> lines{};
+    for (std::string line{}; std::getline(file, line);)
+      lines.push_back(line);
+    file.close();
+
+    EXPECT_EQ(lines, (std::vector<std::string>{
+      "file,bytes,start_seconds,seconds,thread,succeeded",
+      "a.so,2048,0,1.5,0,1",
+      "b.so,10,0,0.25,1,0",
+      "c.so,0,0.25,2,1,1" }));
+    std::filesystem::remove(fileName);
+
+    EXPECT_FALSE(WriteBatchTimings("DoesNotExist/BatchTimings.csv", inputs, sizes, timings));
+
+    EXPECT_EQ(LogBatchSummary(inputs, sizes, timings), 1u);
+    EXPECT_EQ(LogBatchSummary(inputs, sizes, timings, 0), 1u);
+    EXPECT_EQ(LogBatchSummary({}, {}, {}), 0u);
+  }
+}
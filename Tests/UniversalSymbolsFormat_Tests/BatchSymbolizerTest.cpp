@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/BatchSymbolizer.h>
+
+#include "TestUsym.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Functions of 0x20 bytes, every 0x40 bytes from aBase. The first two are folded into one address.
+  void WriteTestUsym(const char* apFileName, ISerializer::Type aType, uint64_t aBase, uint32_t aCount)
+  {
+    USYM usym{};
+
+    AddType(usym, 1, "int", USYM::TypeSymbol::Type::kBase, 4);
+
+    for (uint32_t i = 0; i < aCount; i++)
+    {
+      USYM::FunctionSymbol& function = AddFunction(usym, 10 + i, std::string(apFileName) + "_" + std::to_string(i), 1);
+      function.virtualAddress = aBase + (i == 0 ? 0 : (i - 1) * 0x40);
+      function.length = 0x20;
+    }
+
+    usym.SetSerializer(aType);
+    ASSERT_EQ(usym.Serialize(apFileName), ISerializer::SerializeResult::kOk);
+  }
+
+  std::string Describe(const BatchSymbolizer& aSymbolizer, const BatchSymbolizer::Result& aResult)
+  {
+    if (!aResult.IsResolved())
+      return "??";
+
+    return std::string(aResult.name) + "+" + std::to_string(aResult.offset) + "@" + aSymbolizer.GetFileName(aResult.fileIndex);
+  }
+
+  TEST(BatchSymbolizer, ResolvesAcrossFiles)
+  {
+    WriteTestUsym("BatchSymbolizerIndexed", ISerializer::Type::kIndexedBinary, 0x1000, 100);
+    WriteTestUsym("BatchSymbolizerBinary", ISerializer::Type::kBinary, 0x400000, 100);
+
+    BatchSymbolizer symbolizer{};
+    ASSERT_TRUE(symbolizer.AddFile("BatchSymbolizerIndexed.usym"));
+    ASSERT_TRUE(symbolizer.AddFile("BatchSymbolizerBinary.usym"));
+    EXPECT_FALSE(symbolizer.AddFile("BatchSymbolizerMissing.usym"));
+    ASSERT_EQ(symbolizer.GetFileCount(), 2);
+
+    // Unsorted, with duplicates, gaps and addresses of both files mixed.
+    const std::vector<uint64_t> addresses{ 0x400045, 0x1000, 0x101F, 0x1020, 0x0, 0x1000, 0x400000, 0x1081, UINT64_MAX };
+    std::vector<BatchSymbolizer::Result> results(addresses.size());
+    symbolizer.Symbolize(addresses, results);
+
+    const std::vector<std::string> expected{
+      "BatchSymbolizerBinary_2+5@BatchSymbolizerBinary.usym",
+      "BatchSymbolizerIndexed_0+0@BatchSymbolizerIndexed.usym",
+      "BatchSymbolizerIndexed_0+31@BatchSymbolizerIndexed.usym",
+      "??",
+      "??",
+      "BatchSymbolizerIndexed_0+0@BatchSymbolizerIndexed.usym",
+      "BatchSymbolizerBinary_0+0@BatchSymbolizerBinary.usym",
+      "BatchSymbolizerIndexed_3+1@BatchSymbolizerIndexed.usym",
+      "??",
+    };
+
+    for (size_t i = 0; i < addresses.size(); i++)
+      EXPECT_EQ(Describe(symbolizer, results[i]), expected[i]) << "address " << addresses[i];
+  }
+
+  TEST(BatchSymbolizer, MatchesUsymSymbolize)
+  {
+    WriteTestUsym("BatchSymbolizerRandom", ISerializer::Type::kBinary, 0x1000, 1000);
+
+    USYM usym{};
+    ASSERT_EQ(usym.Deserialize("BatchSymbolizerRandom.usym"), IDeserializer::DeserializeResult::kOk);
+
+    BatchSymbolizer symbolizer{};
+    ASSERT_TRUE(symbolizer.AddFile("BatchSymbolizerRandom.usym"));
+
+    // Dense and sparse batches, so the sweep both steps and gallops.
+    std::mt19937_64 random(3);
+    for (const uint64_t range : { 0x100ull, 0x10000ull, 0x1000000ull })
+    {
+      std::vector<uint64_t> addresses(500);
+      for (uint64_t& address : addresses)
+        address = 0x1000 + random() % range;
+
+      std::vector<BatchSymbolizer::Result> results(addresses.size());
+      symbolizer.Symbolize(addresses, results);
+
+      for (size_t i = 0; i < addresses.size(); i++)
+      {
+        const USYM::FunctionSymbol* pFunction = usym.Symbolize(addresses[i]);
+        ASSERT_EQ(results[i].IsResolved(), pFunction != nullptr) << "address " << addresses[i];
+        if (pFunction)
+        {
+          EXPECT_EQ(results[i].name, pFunction->name);
+          EXPECT_EQ(results[i].offset, addresses[i] - pFunction->virtualAddress);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include "TestUsym.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+  using DR = IDeserializer::DeserializeResult;
+
+  USYM CreateTestUsym()
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    usym.header.originalFormat = USYM::OriginalFormat::kDwarf;
+    usym.header.architecture = USYM::Architecture::kX86_64;
+
+    AddType(usym, 1, "int", Type::kBase, 4);
+    AddType(usym, 2, "float", Type::kBase, 4);
+    AddType(usym, 3, "Value*", Type::kPointer, 8, 4);
+
+    auto& value = AddType(usym, 4, "Value", Type::kStruct, 8);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+      USYM::FieldSymbol& field = AddField(usym, value, 10 + i, i == 2 ? "" : (i == 0 ? "i" : "f"), i == 0 ? 1 : 2, 4);
+      field.isAnonymousUnion = true;
+      field.unionId = 1;
+    }
+
+    auto& function = AddFunction(usym, 20, "GetValue", 3, { 1, 2, 4 });
+    function.callingConvention = USYM::CallingConvention::kNearFast;
+    function.virtualAddress = 0x140001000;
+    function.length = 0x80;
+
+    usym.functionSymbols[21].id = 21;
+
+    return usym;
+  }
+
+  std::vector<char> ReadFile(const std::string& aFileName)
+  {
+    std::ifstream file(aFileName, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void WriteFile(const std::string& aFileName, const std::vector<char>& aContents)
+  {
+    std::ofstream file(aFileName, std::ios::binary);
+    file.write(aContents.data(), aContents.size());
+  }
+
+  void ExpectRoundTrip(ISerializer::Type aType, const std::string& aFileName)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(aType);
+    ASSERT_EQ(original.Serialize(aFileName.c_str()), ISerializer::SerializeResult::kOk);
+
+    USYM usym{};
+    ASSERT_EQ(usym.Deserialize((aFileName + ".usym").c_str()), DR::kOk);
+
+    EXPECT_EQ(usym.header.magic, original.header.magic);
+    EXPECT_EQ(usym.header.originalFormat, original.header.originalFormat);
+    EXPECT_EQ(usym.header.architecture, original.header.architecture);
+
+    ASSERT_EQ(usym.typeSymbols.size(), original.typeSymbols.size());
+    for (const auto& [id, symbol] : original.typeSymbols)
+    {
+      const auto it = usym.typeSymbols.find(id);
+      ASSERT_NE(it, usym.typeSymbols.end());
+      EXPECT_EQ(it->second.id, symbol.id);
+      EXPECT_EQ(it->second, symbol);
+
+      for (size_t i = 0; i < symbol.fields.size(); i++)
+        EXPECT_EQ(it->second.fields[i].id, symbol.fields[i].id);
+    }
+
+    ASSERT_EQ(usym.functionSymbols.size(), original.functionSymbols.size());
+    for (const auto& [id, symbol] : original.functionSymbols)
+    {
+      const auto it = usym.functionSymbols.find(id);
+      ASSERT_NE(it, usym.functionSymbols.end());
+      EXPECT_EQ(it->second.id, symbol.id);
+      EXPECT_EQ(it->second.name, symbol.name);
+      EXPECT_EQ(it->second.returnTypeId, symbol.returnTypeId);
+      EXPECT_EQ(it->second.argumentCount, symbol.argumentCount);
+      EXPECT_EQ(it->second.argumentTypeIds, symbol.argumentTypeIds);
+      EXPECT_EQ(it->second.callingConvention, symbol.callingConvention);
+      EXPECT_EQ(it->second.virtualAddress, symbol.virtualAddress);
+      EXPECT_EQ(it->second.length, symbol.length);
+    }
+
+    // Names are interned in the new USYM, so lookups by name work.
+    EXPECT_EQ(usym.GetTypeSymbolByName("Value").id, 4);
+    EXPECT_EQ(usym.GetFunctionSymbolByName("GetValue").id, 20);
+  }
+
+  TEST(BinaryDeserializer, RoundTrip)
+  {
+    ExpectRoundTrip(ISerializer::Type::kBinary, "BinaryDeserializerRoundTrip");
+  }
+
+  TEST(BinaryDeserializer, CompactRoundTrip)
+  {
+    ExpectRoundTrip(ISerializer::Type::kCompactBinary, "BinaryDeserializerCompactRoundTrip");
+  }
+
+  TEST(BinaryDeserializer, CompressedRoundTrip)
+  {
+    ExpectRoundTrip(ISerializer::Type::kCompressedBinary, "BinaryDeserializerCompressedRoundTrip");
+  }
+
+  TEST(BinaryDeserializer, CompactIsSmaller)
+  {
+    USYM original = CreateTestUsym();
+    // Repeated names and small steps between ids and addresses, like real symbols.
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+      auto& function = AddFunction(original, 100 + i, i % 2 ? "operator=" : "~Value", 4, { 3 });
+      function.virtualAddress = 0x140002000 + i * 0x40;
+      function.length = 0x30;
+    }
+
+    original.SetSerializer(ISerializer::Type::kBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerFixedSize"), ISerializer::SerializeResult::kOk);
+    original.SetSerializer(ISerializer::Type::kCompactBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerCompactSize"), ISerializer::SerializeResult::kOk);
+
+    const uintmax_t fixedSize = std::filesystem::file_size("BinaryDeserializerFixedSize.usym");
+    const uintmax_t compactSize = std::filesystem::file_size("BinaryDeserializerCompactSize.usym");
+    EXPECT_LT(compactSize * 4, fixedSize);
+
+    USYM usym{};
+    ASSERT_EQ(usym.Deserialize("BinaryDeserializerCompactSize.usym"), DR::kOk);
+    EXPECT_EQ(usym.functionSymbols.size(), original.functionSymbols.size());
+    EXPECT_EQ(usym.functionSymbols.at(1099).name, "operator=");
+    EXPECT_EQ(usym.functionSymbols.at(1099).virtualAddress, 0x140002000 + 999 * 0x40);
+  }
+
+  TEST(BinaryDeserializer, ReadsFilesWithoutFunctionLengths)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(ISerializer::Type::kBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerNoLengths"), ISerializer::SerializeResult::kOk);
+
+    // Older files end right before the count and lengths of the functions.
+    std::vector<char> contents = ReadFile("BinaryDeserializerNoLengths.usym");
+    contents.resize(contents.size() - sizeof(size_t) - original.functionSymbols.size() * sizeof(uint64_t));
+    WriteFile("BinaryDeserializerNoLengths.usym", contents);
+
+    USYM usym{};
+    ASSERT_EQ(usym.Deserialize("BinaryDeserializerNoLengths.usym"), DR::kOk);
+    ASSERT_EQ(usym.functionSymbols.size(), original.functionSymbols.size());
+    EXPECT_EQ(usym.functionSymbols.at(20).virtualAddress, 0x140001000);
+    EXPECT_EQ(usym.functionSymbols.at(20).length, 0);
+  }
+
+  TEST(BinaryDeserializer, MissingFile)
+  {
+    USYM usym{};
+    EXPECT_EQ(usym.Deserialize("DoesNotExist.usym"), DR::kFileReadFailed);
+  }
+
+  TEST(BinaryDeserializer, RejectsWrongMagic)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(ISerializer::Type::kBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerWrongMagic"), ISerializer::SerializeResult::kOk);
+
+    std::vector<char> contents = ReadFile("BinaryDeserializerWrongMagic.usym");
+    contents[0] ^= 0xFF;
+    WriteFile("BinaryDeserializerWrongMagic.usym", contents);
+
+    USYM usym{};
+    EXPECT_EQ(usym.Deserialize("BinaryDeserializerWrongMagic.usym"), DR::kHeaderFailed);
+  }
+
+  TEST(BinaryDeserializer, RejectsTruncatedFile)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(ISerializer::Type::kBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerTruncated"), ISerializer::SerializeResult::kOk);
+
+    const std::vector<char> contents = ReadFile("BinaryDeserializerTruncated.usym");
+
+    // Files without function lengths end where those start, which is not a truncation.
+    const size_t lengthsOffset = contents.size() - sizeof(size_t) - original.functionSymbols.size() * sizeof(uint64_t);
+
+    // Cutting the file anywhere inside the symbols must fail cleanly, and leave the USYM empty.
+    for (size_t length = sizeof(uint32_t) + 2; length < contents.size() - 1; length += 7)
+    {
+      if (length == lengthsOffset)
+        continue;
+
+      WriteFile("BinaryDeserializerTruncated.usym", std::vector<char>(contents.begin(), contents.begin() + length));
+
+      USYM usym{};
+      EXPECT_NE(usym.Deserialize("BinaryDeserializerTruncated.usym"), DR::kOk) << "length " << length;
+      EXPECT_TRUE(usym.typeSymbols.empty());
+      EXPECT_TRUE(usym.functionSymbols.empty());
+    }
+  }
+
+  TEST(BinaryDeserializer, RejectsTruncatedCompactFile)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(ISerializer::Type::kCompactBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerCompactTruncated"), ISerializer::SerializeResult::kOk);
+
+    const std::vector<char> contents = ReadFile("BinaryDeserializerCompactTruncated.usym");
+
+    // The compact encoding has no optional trailer, so every cut must fail.
+    for (size_t length = sizeof(uint32_t) + 2; length < contents.size(); length++)
+    {
+      WriteFile("BinaryDeserializerCompactTruncated.usym", std::vector<char>(contents.begin(), contents.begin() + length));
+
+      USYM usym{};
+      EXPECT_NE(usym.Deserialize("BinaryDeserializerCompactTruncated.usym"), DR::kOk) << "length " << length;
+      EXPECT_TRUE(usym.typeSymbols.empty());
+      EXPECT_TRUE(usym.functionSymbols.empty());
+    }
+  }
+
+  TEST(BinaryDeserializer, RejectsTruncatedCompressedFile)
+  {
+    USYM original = CreateTestUsym();
+    original.SetSerializer(ISerializer::Type::kCompressedBinary);
+    ASSERT_EQ(original.Serialize("BinaryDeserializerCompressedTruncated"), ISerializer::SerializeResult::kOk);
+
+    const std::vector<char> contents = ReadFile("BinaryDeserializerCompressedTruncated.usym");
+
+    for (size_t length = 0; length < contents.size(); length++)
+    {
+      WriteFile("BinaryDeserializerCompressedTruncated.usym", std::vector<char>(contents.begin(), contents.begin() + length));
+
+      USYM usym{};
+      EXPECT_NE(usym.Deserialize("BinaryDeserializerCompressedTruncated.usym"), DR::kOk) << "length " << length;
+      EXPECT_TRUE(usym.functionSymbols.empty());
+    }
+  }
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <Lz.h>
+#include <UniversalSymbolsFormat/Serializers/BlockCompressedReader.h>
+#include <UniversalSymbolsFormat/Serializers/BlockCompressedWriter.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::vector<uint8_t> ReadFile(const std::string& aFileName)
+  {
+    std::ifstream file(aFileName, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // Symbol like text: names repeating with small changes, mixed with a few random bytes.
+  std::vector<uint8_t> CreateTestData(size_t aSize, uint32_t aSeed = 1)
+  {
+    std::mt19937 random(aSeed);
+    const char* const names[] = { "std::vector<int>::push_back", "operator new", "Value::GetValue", "main" };
+
+    std::vector<uint8_t> data{};
+    while (data.size() < aSize)
+    {
+      const std::string name = names[random() % std::size(names)] + std::to_string(random() % 100);
+      data.insert(data.end(), name.begin(), name.end());
+      data.push_back(static_cast<uint8_t>(random()));
+    }
+    data.resize(aSize);
+    return data;
+  }
+
+  std::vector<uint8_t> Compress(const std::vector<uint8_t>& aData)
+  {
+    std::vector<uint8_t> compressed(Lz::GetMaxCompressedSize(aData.size()));
+    compressed.resize(Lz::Compress(aData.data(), aData.size(), compressed.data()));
+    return compressed;
+  }
+
+  TEST(Lz, RoundTrip)
+  {
+    std::mt19937 random(7);
+    std::vector<uint8_t> noise(100000);
+    for (auto& byte : noise)
+      byte = static_cast<uint8_t>(random());
+
+    const std::vector<std::vector<uint8_t>> inputs{
+      {},
+      { 1 },
+      { 1, 2, 3, 4, 5 },
+      std::vector<uint8_t>(100000, 0xAB),
+      CreateTestData(100000),
+      noise,
+    };
+
+    for (const auto& input : inputs)
+    {
+      const std::vector<uint8_t> compressed = Compress(input);
+      EXPECT_LE(compressed.size(), Lz::GetMaxCompressedSize(input.size()));
+
+      std::vector<uint8_t> output(input.size());
+      ASSERT_TRUE(Lz::Decompress(compressed.data(), compressed.size(), output.data(), output.size())) << input.size();
+      EXPECT_EQ(output, input);
+    }
+  }
+
+  TEST(Lz, CompressesRepeatedData)
+  {
+    const std::vector<uint8_t> input = CreateTestData(100000);
+    EXPECT_LT(Compress(input).size() * 2, input.size());
+    EXPECT_LT(Compress(std::vector<uint8_t>(100000, 0)).size(), 1000);
+  }
+
+  TEST(Lz, RejectsMalformedData)
+  {
+    const std::vector<uint8_t> input = CreateTestData(10000);
+    const std::vector<uint8_t> compressed = Compress(input);
+    std::vector<uint8_t> output(input.size());
+
+    // Wrong sizes.
+    EXPECT_FALSE(Lz::Decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+    output.push_back(0);
+    EXPECT_FALSE(Lz::Decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+    output.pop_back();
+
+    // Cut off anywhere.
+    for (size_t size = 0; size < compressed.size(); size += 13)
+      EXPECT_FALSE(Lz::Decompress(compressed.data(), size, output.data(), output.size())) << size;
+
+    // A match before the start of the output.
+    const uint8_t badOffset[] = { 0x10, 'a', 0x02, 0x00 };
+    EXPECT_FALSE(Lz::Decompress(badOffset, sizeof(badOffset), output.data(), 5));
+
+    // Random corruption must never read or write out of bounds, whatever it returns.
+    std::mt19937 random(3);
+    for (int i = 0; i < 1000; i++)
+    {
+      std::vector<uint8_t> corrupt = compressed;
+      corrupt[random() % corrupt.size()] = static_cast<uint8_t>(random());
+      Lz::Decompress(corrupt.data(), corrupt.size(), output.data(), output.size());
+    }
+  }
+
+  TEST(BlockCompressed, WriterAndReader)
+  {
+    const std::vector<uint8_t> input = CreateTestData(10000);
+
+    // Small blocks, so writes cross blocks and the last block is a partial one.
+    BlockCompressedWriter writer{ 1000 };
+    ASSERT_TRUE(writer.Open("BlockCompressed.bin"));
+    for (size_t offset = 0; offset < input.size(); offset += 333)
+      ASSERT_TRUE(writer.WriteImpl(input.data() + offset, std::min<size_t>(333, input.size() - offset)));
+    EXPECT_EQ(writer.GetPosition(), input.size());
+    ASSERT_TRUE(writer.Close());
+
+    const std::vector<uint8_t> file = ReadFile("BlockCompressed.bin");
+    EXPECT_LT(file.size(), input.size());
+    ASSERT_TRUE(BlockCompressedReader::IsBlockCompressed(file.data(), file.size()));
+
+    BlockCompressedReader reader{};
+    ASSERT_TRUE(reader.Open(file.data(), file.size()));
+    EXPECT_EQ(reader.GetSize(), input.size());
+    EXPECT_EQ(reader.GetBlockCount(), 10);
+    EXPECT_EQ(reader.GetBlockSize(), 1000);
+
+    std::vector<uint8_t> output(reader.GetSize());
+    ASSERT_TRUE(reader.ReadAll(output.data(), 4));
+    EXPECT_EQ(output, input);
+
+    // A single block, without touching the others.
+    std::vector<uint8_t> block(reader.GetBlockSize(7));
+    ASSERT_TRUE(reader.ReadBlock(7, block.data()));
+    EXPECT_EQ(block, std::vector<uint8_t>(input.begin() + 7000, input.begin() + 8000));
+  }
+
+  TEST(BlockCompressed, StoresIncompressibleBlocks)
+  {
+    std::mt19937 random(5);
+    std::vector<uint8_t> input(5000);
+    for (auto& byte : input)
+      byte = static_cast<uint8_t>(random());
+
+    BlockCompressedWriter writer{ 4096 };
+    ASSERT_TRUE(writer.Open("BlockCompressedStored.bin"));
+    writer.WriteImpl(input.data(), input.size());
+    ASSERT_TRUE(writer.Close());
+
+    // Random data only costs the header and the index.
+    const std::vector<uint8_t> file = ReadFile("BlockCompressedStored.bin");
+    EXPECT_EQ(file.size(), input.size() + sizeof(BlockCompressedFormat::FileHeader) + 2 * sizeof(BlockCompressedFormat::BlockEntry));
+
+    BlockCompressedReader reader{};
+    ASSERT_TRUE(reader.Open(file.data(), file.size()));
+    std::vector<uint8_t> output(reader.GetSize());
+    ASSERT_TRUE(reader.ReadAll(output.data()));
+    EXPECT_EQ(output, input);
+  }
+
+  TEST(BlockCompressed, RejectsCorruptIndex)
+  {
+    const std::vector<uint8_t> input = CreateTestData(3000);
+
+    BlockCompressedWriter writer{ 1000 };
+    ASSERT_TRUE(writer.Open("BlockCompressedCorrupt.bin"));
+    writer.WriteImpl(input.data(), input.size());
+    ASSERT_TRUE(writer.Close());
+
+    const std::vector<uint8_t> file = ReadFile("BlockCompressedCorrupt.bin");
+    BlockCompressedFormat::FileHeader header{};
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    // Every field of every index entry pointing somewhere else.
+    for (size_t offset = header.indexOffset; offset < file.size(); offset += sizeof(uint32_t))
+    {
+      std::vector<uint8_t> corrupt = file;
+      corrupt[offset + 1] ^= 0x40;
+
+      BlockCompressedReader reader{};
+      EXPECT_FALSE(reader.Open(corrupt.data(), corrupt.size())) << offset;
+    }
+
+    // Cut off before the end of the index.
+    BlockCompressedReader reader{};
+    EXPECT_FALSE(reader.Open(file.data(), file.size() - 1));
+  }
+}
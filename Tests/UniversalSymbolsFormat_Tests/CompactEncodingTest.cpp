@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/Serializers/CompactEncoding.h>
+
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+  TEST(CompactEncoding, VarintRoundTrip)
+  {
+    const uint64_t values[] = { 0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, 0x140001000, std::numeric_limits<uint64_t>::max() };
+    for (const uint64_t value : values)
+    {
+      uint8_t bytes[CompactEncoding::kMaxVarintSize]{};
+      const size_t size = CompactEncoding::EncodeVarint(value, bytes);
+
+      uint64_t decoded = 0;
+      EXPECT_EQ(CompactEncoding::DecodeVarint(bytes, size, decoded), size) << value;
+      EXPECT_EQ(decoded, value);
+    }
+  }
+
+  TEST(CompactEncoding, VarintSizes)
+  {
+    uint8_t bytes[CompactEncoding::kMaxVarintSize]{};
+    EXPECT_EQ(CompactEncoding::EncodeVarint(0x7F, bytes), 1);
+    EXPECT_EQ(CompactEncoding::EncodeVarint(0x80, bytes), 2);
+    EXPECT_EQ(CompactEncoding::EncodeVarint(std::numeric_limits<uint64_t>::max(), bytes), CompactEncoding::kMaxVarintSize);
+  }
+
+  TEST(CompactEncoding, RejectsBadVarints)
+  {
+    uint64_t value = 0;
+
+    // Cut off before the last byte.
+    const uint8_t cutOff[] = { 0x80, 0x80 };
+    EXPECT_EQ(CompactEncoding::DecodeVarint(cutOff, sizeof(cutOff), value), 0);
+    EXPECT_EQ(CompactEncoding::DecodeVarint(cutOff, 0, value), 0);
+
+    // More than 64 bits.
+    const uint8_t tooLarge[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 };
+    EXPECT_EQ(CompactEncoding::DecodeVarint(tooLarge, sizeof(tooLarge), value), 0);
+
+    const uint8_t tooLong[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+    EXPECT_EQ(CompactEncoding::DecodeVarint(tooLong, sizeof(tooLong), value), 0);
+  }
+
+  TEST(CompactEncoding, DeltaRoundTrip)
+  {
+    // Small steps either way encode to small numbers.
+    EXPECT_EQ(CompactEncoding::EncodeDelta(10, 10), 0);
+    EXPECT_EQ(CompactEncoding::EncodeDelta(9, 10), 1);
+    EXPECT_EQ(CompactEncoding::EncodeDelta(11, 10), 2);
+
+    const uint64_t values[] = { 0, 1, 0x140001000, 0x1000, std::numeric_limits<uint64_t>::max(), 0 };
+    uint64_t previous = 0;
+    for (const uint64_t value : values)
+    {
+      EXPECT_EQ(CompactEncoding::DecodeDelta(CompactEncoding::EncodeDelta(value, previous), previous), value);
+      previous = value;
+    }
+  }
+}
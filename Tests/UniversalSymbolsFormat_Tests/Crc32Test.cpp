@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <Crc32.h>
+
+#include <string_view>
+#include <vector>
+
+namespace
+{
+  uint32_t Crc32(std::string_view aText, uint32_t aCrc = 0)
+  {
+    return ::Crc32(reinterpret_cast<const uint8_t*>(aText.data()), aText.size(), aCrc);
+  }
+
+  TEST(Crc32, KnownValues)
+  {
+    EXPECT_EQ(Crc32(""), 0u);
+    EXPECT_EQ(Crc32("a"), 0xE8B7BE43u);
+    EXPECT_EQ(Crc32("123456789"), 0xCBF43926u);
+    EXPECT_EQ(Crc32("The quick brown fox jumps over the lazy dog"), 0x414FA339u);
+  }
+
+  TEST(Crc32, Continues)
+  {
+    // Splits at every offset, so both the 8 byte steps and the remainder are continued.
+    const std::string_view text = "The quick brown fox jumps over the lazy dog";
+    for (size_t split = 0; split <= text.size(); split++)
+      EXPECT_EQ(Crc32(text.substr(split), Crc32(text.substr(0, split))), 0x414FA339u) << split;
+  }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <Inflate.h>
+
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+  // zlib.compress(b"Hello, Hello, Hello, Hello!", 9), a single fixed Huffman block.
+  constexpr std::string_view kFixedText = "Hello, Hello, Hello, Hello!";
+  const std::vector<uint8_t> kFixed{
+    0x78, 0xDA, 0xF3, 0x48, 0xCD, 0xC9, 0xC9, 0xD7, 0x51, 0xF0, 0xC0, 0xA4, 0x14, 0x01, 0x7D, 0x2C,
+    0x08, 0xD6,
+  };
+
+  // zlib.compress of the text below at level 9, a single dynamic Huffman block.
+  constexpr std::string_view kDynamicText = "eeertaeeeetaelheeaatehedeeeednleleeeeen_r__te_itntaeeeaeed_adeeeose_haettietteeeedleeetneaanasteneet";
+  const std::vector<uint8_t> kDynamic{
+    0x78, 0xDA, 0x1D, 0x8C, 0x01, 0x0A, 0x00, 0x31, 0x08, 0xC3, 0x9E, 0x2A, 0x82, 0x01, 0x07, 0xC3,
+    0x83, 0xAD, 0xFF, 0xE7, 0x74, 0x42, 0xA4, 0x95, 0x56, 0xE0, 0xC8, 0xE9, 0xE9, 0xBD, 0x13, 0xDC,
+    0x45, 0x12, 0x73, 0x89, 0xDA, 0xEC, 0x11, 0x94, 0x1D, 0x33, 0x61, 0x4B, 0xF5, 0xC2, 0x4D, 0x98,
+    0x4F, 0xE8, 0xBB, 0x58, 0x3A, 0xD2, 0x6A, 0x5E, 0x69, 0x1A, 0xAA, 0xFE, 0x53, 0x7E, 0x45, 0xB5,
+    0xF9, 0x01, 0xF6, 0x49, 0x28, 0x86,
+  };
+
+  // A zlib stream of stored blocks, which any input fits in.
+  std::vector<uint8_t> CreateStoredZlib(const std::vector<uint8_t>& aData, size_t aBlockSize)
+  {
+    std::vector<uint8_t> stream{ 0x78, 0x01 };
+    size_t offset = 0;
+    do
+    {
+      const size_t size = std::min(aBlockSize, aData.size() - offset);
+      const uint16_t length = static_cast<uint16_t>(size);
+      stream.push_back(offset + size == aData.size() ? 1 : 0);
+      stream.push_back(static_cast<uint8_t>(length));
+      stream.push_back(static_cast<uint8_t>(length >> 8));
+      stream.push_back(static_cast<uint8_t>(~length));
+      stream.push_back(static_cast<uint8_t>(~length >> 8));
+      stream.insert(stream.end(), aData.begin() + offset, aData.begin() + offset + size);
+      offset += size;
+    } while (offset != aData.size());
+
+    const uint32_t adler = Inflate::Adler32(aData.data(), aData.size());
+    for (int shift = 24; shift >= 0; shift -= 8)
+      stream.push_back(static_cast<uint8_t>(adler >> shift));
+    return stream;
+  }
+
+  std::string Decompress(const std::vector<uint8_t>& aStream, size_t aSize)
+  {
+    std::string output(aSize, '\0');
+    if (!Inflate::DecompressZlib(aStream.data(), aStream.size(), reinterpret_cast<uint8_t*>(output.data()), output.size()))
+      return "<failed>";
+    return output;
+  }
+
+  TEST(Inflate, HuffmanBlocks)
+  {
+    EXPECT_EQ(Decompress(kFixed, kFixedText.size()), kFixedText);
+    EXPECT_EQ(Decompress(kDynamic, kDynamicText.size()), kDynamicText);
+  }
+
+  TEST(Inflate, StoredBlocks)
+  {
+    std::mt19937 random(11);
+    std::vector<uint8_t> input(100000);
+    for (auto& byte : input)
+      byte = static_cast<uint8_t>(random());
+
+    for (const size_t blockSize : { 1, 1000, 65535 })
+    {
+      const std::vector<uint8_t> stream = CreateStoredZlib(input, blockSize);
+      std::vector<uint8_t> output(input.size());
+      ASSERT_TRUE(Inflate::DecompressZlib(stream.data(), stream.size(), output.data(), output.size())) << blockSize;
+      EXPECT_EQ(output, input);
+    }
+
+    const std::vector<uint8_t> empty = CreateStoredZlib({}, 1);
+    EXPECT_TRUE(Inflate::DecompressZlib(empty.data(), empty.size(), nullptr, 0));
+  }
+
+  TEST(Inflate, Adler32)
+  {
+    const std::string_view text = "Wikipedia";
+    EXPECT_EQ(Inflate::Adler32(reinterpret_cast<const uint8_t*>(text.data()), text.size()), 0x11E60398u);
+    EXPECT_EQ(Inflate::Adler32(nullptr, 0), 1u);
+
+    // Long enough for the sums to be reduced along the way.
+    const std::vector<uint8_t> ones(100000, 0xFF);
+    const uint32_t whole = Inflate::Adler32(ones.data(), ones.size());
+    EXPECT_EQ(Inflate::Adler32(ones.data() + 12345, ones.size() - 12345, Inflate::Adler32(ones.data(), 12345)), whole);
+  }
+
+  TEST(Inflate, RejectsMalformedData)
+  {
+    std::vector<uint8_t> output(kDynamicText.size());
+
+    // Wrong sizes.
+    EXPECT_FALSE(Inflate::DecompressZlib(kDynamic.data(), kDynamic.size(), output.data(), output.size() - 1));
+    output.push_back(0);
+    EXPECT_FALSE(Inflate::DecompressZlib(kDynamic.data(), kDynamic.size(), output.data(), output.size()));
+    output.pop_back();
+
+    // Cut off anywhere, the checksum included.
+    for (size_t size = 0; size < kDynamic.size(); size++)
+      EXPECT_FALSE(Inflate::DecompressZlib(kDynamic.data(), size, output.data(), output.size())) << size;
+
+    // A wrong checksum, header, or a preset dictionary.
+    for (const size_t offset : { size_t(0), size_t(1), kDynamic.size() - 1 })
+    {
+      std::vector<uint8_t> corrupt = kDynamic;
+      corrupt[offset] ^= 0x20;
+      EXPECT_FALSE(Inflate::DecompressZlib(corrupt.data(), corrupt.size(), output.data(), output.size())) << offset;
+    }
+
+    // Block type 3 does not exist.
+    const uint8_t reserved[] = { 0x07 };
+    EXPECT_FALSE(Inflate::Decompress(reserved, sizeof(reserved), output.data(), output.size()));
+
+    // A fixed Huffman match, length 3 at distance 1, before any output.
+    const uint8_t badDistance[] = { 0x03, 0x02, 0x00 };
+    EXPECT_FALSE(Inflate::Decompress(badDistance, sizeof(badDistance), output.data(), 3));
+
+    // Random corruption must never read or write out of bounds, whatever it returns.
+    std::mt19937 random(3);
+    for (int i = 0; i < 1000; i++)
+    {
+      std::vector<uint8_t> corrupt = kDynamic;
+      corrupt[2 + random() % (corrupt.size() - 2)] ^= static_cast<uint8_t>(1 << (random() % 8));
+      Inflate::DecompressZlib(corrupt.data(), corrupt.size(), output.data(), output.size());
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include "TestUsym.h"
+
+#include <string>
+
+namespace
+{
+  TEST(NameIndex, FindsEveryOverload)
+  {
+    USYM usym{};
+    AddFunction(usym, 30, "Overloaded");
+    AddFunction(usym, 10, "Single");
+    AddFunction(usym, 20, "Overloaded");
+    AddFunction(usym, 40, "");
+
+    const auto overloads = usym.GetFunctionSymbolsByName("Overloaded");
+    ASSERT_EQ(overloads.size(), 2);
+    EXPECT_EQ(overloads[0]->id, 30);
+    EXPECT_EQ(overloads[1]->id, 20);
+
+    EXPECT_EQ(usym.GetFunctionSymbolByName("Overloaded").id, 30);
+    EXPECT_EQ(usym.GetFunctionSymbolByName(std::string("Single")).id, 10);
+
+    EXPECT_EQ(usym.GetFunctionSymbolByName("Missing").id, 0);
+    EXPECT_EQ(usym.GetFunctionSymbolByName("").id, 0);
+    EXPECT_TRUE(usym.GetFunctionSymbolsByName("Missing").empty());
+  }
+
+  TEST(NameIndex, SeesAddedAndRemovedSymbols)
+  {
+    USYM usym{};
+    AddType(usym, 1, "First", USYM::TypeSymbol::Type::kStruct);
+    EXPECT_EQ(usym.GetTypeSymbolByName("First").id, 1);
+    EXPECT_EQ(usym.GetTypeSymbolByName("Second").id, 0);
+
+    AddType(usym, 2, "Second", USYM::TypeSymbol::Type::kStruct);
+    EXPECT_EQ(usym.GetTypeSymbolByName("Second").id, 2);
+
+    usym.typeSymbols.erase_if([](const auto& aEntry) { return aEntry.first == 1; });
+    EXPECT_EQ(usym.GetTypeSymbolByName("First").id, 0);
+    EXPECT_EQ(usym.GetTypeSymbolByName("Second").id, 2);
+
+    usym.Clear();
+    EXPECT_EQ(usym.GetTypeSymbolByName("Second").id, 0);
+  }
+
+  TEST(NameIndex, SeesPurgedDuplicates)
+  {
+    USYM usym{};
+    AddType(usym, 1, "Duplicate", USYM::TypeSymbol::Type::kStruct);
+    AddType(usym, 2, "Duplicate", USYM::TypeSymbol::Type::kStruct);
+    ASSERT_EQ(usym.GetTypeSymbolsByName("Duplicate").size(), 2);
+
+    usym.PurgeDuplicateTypes();
+    ASSERT_EQ(usym.GetTypeSymbolsByName("Duplicate").size(), 1);
+  }
+
+  TEST(NameIndex, RenamingNeedsInvalidate)
+  {
+    USYM usym{};
+    AddFunction(usym, 1, "Before");
+    EXPECT_EQ(usym.GetFunctionSymbolByName("Before").id, 1);
+
+    usym.functionSymbols.at(1).name = usym.Intern("After");
+    usym.InvalidateIndexes();
+
+    EXPECT_EQ(usym.GetFunctionSymbolByName("Before").id, 0);
+    EXPECT_EQ(usym.GetFunctionSymbolByName("After").id, 1);
+  }
+
+  TEST(NameIndex, SurvivesMove)
+  {
+    USYM usym{};
+    AddFunction(usym, 1, "Function");
+    EXPECT_EQ(usym.GetFunctionSymbolByName("Function").id, 1);
+
+    USYM moved = std::move(usym);
+    EXPECT_EQ(moved.GetFunctionSymbolByName("Function").id, 1);
+
+    // Replacing a table with one of the same size must not reuse the old index.
+    USYM other{};
+    AddFunction(other, 2, "Other");
+    moved.functionSymbols = std::move(other.functionSymbols);
+    EXPECT_EQ(moved.GetFunctionSymbolByName("Function").id, 0);
+  }
+}
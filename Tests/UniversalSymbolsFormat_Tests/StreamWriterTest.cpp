@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <StreamWriter.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::vector<uint8_t> ReadFile(const std::string& aFileName)
+  {
+    std::ifstream file(aFileName, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  TEST(StreamWriter, WritesBlocksAndPatches)
+  {
+    // Tiny blocks, so writes cross blocks and most patches land in blocks written already.
+    StreamWriter writer{ 7 };
+    ASSERT_TRUE(writer.Open("StreamWriterBlocks.bin"));
+
+    std::vector<uint8_t> expected{};
+    for (uint32_t i = 0; i < 3000; i++)
+    {
+      std::vector<uint8_t> bytes(i % 23, static_cast<uint8_t>(i));
+      ASSERT_TRUE(writer.WriteImpl(bytes.data(), bytes.size()));
+      expected.insert(expected.end(), bytes.begin(), bytes.end());
+
+      uint32_t value = i;
+      ASSERT_TRUE(writer.Write(value));
+      expected.insert(expected.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
+
+      // Overwrite a value written earlier, which might still be in the current block, or partly.
+      if (i % 10 == 9)
+      {
+        const uint32_t patch = 0xA5A5A5A5 ^ i;
+        const size_t offset = expected.size() - sizeof(patch) - (i % 40);
+        ASSERT_TRUE(writer.Patch(offset, &patch, sizeof(patch)));
+        std::memcpy(expected.data() + offset, &patch, sizeof(patch));
+      }
+    }
+
+    ASSERT_TRUE(writer.WriteString("end"));
+    expected.insert(expected.end(), { 'e', 'n', 'd', '\0' });
+    EXPECT_EQ(writer.GetPosition(), expected.size());
+
+    const uint32_t header = 0x12345678;
+    ASSERT_TRUE(writer.Patch(0, &header, sizeof(header)));
+    std::memcpy(expected.data(), &header, sizeof(header));
+
+    ASSERT_TRUE(writer.Close());
+    EXPECT_FALSE(writer.IsOpen());
+    EXPECT_EQ(ReadFile("StreamWriterBlocks.bin"), expected);
+  }
+
+  TEST(StreamWriter, RejectsPatchesPastTheEnd)
+  {
+    StreamWriter writer{};
+    ASSERT_TRUE(writer.Open("StreamWriterPastEnd.bin"));
+
+    uint64_t value = 1;
+    writer.Write(value);
+    EXPECT_FALSE(writer.Patch(4, &value, sizeof(value)));
+    EXPECT_TRUE(writer.Patch(0, &value, sizeof(value)));
+
+    EXPECT_TRUE(writer.Close());
+  }
+
+  TEST(StreamWriter, CanBeReopened)
+  {
+    StreamWriter writer{ 4 };
+    for (const char* pText : { "first file", "second" })
+    {
+      const std::string fileName = std::string("StreamWriter_") + pText + ".bin";
+      ASSERT_TRUE(writer.Open(fileName));
+      writer.WriteString(pText);
+      ASSERT_TRUE(writer.Close());
+
+      const std::vector<uint8_t> contents = ReadFile(fileName);
+      EXPECT_EQ(std::string(contents.begin(), contents.end()), std::string(pText) + '\0');
+    }
+  }
+
+  TEST(StreamWriter, FailsToOpenMissingDirectory)
+  {
+    StreamWriter writer{};
+    EXPECT_FALSE(writer.Open("StreamWriterMissingDirectory/file.bin"));
+    EXPECT_FALSE(writer.Close());
+  }
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include "TestUsym.h"
+
+#include <json.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+  USYM CreateTestUsym()
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    usym.header.originalFormat = USYM::OriginalFormat::kPdb;
+    usym.header.architecture = USYM::Architecture::kX86;
+
+    AddType(usym, 1, "unsigned int", Type::kBase, 4);
+
+    // Names that need every kind of escaping, and some UTF-8.
+    auto& escaped = AddType(usym, 2, "Quote\" Backslash\\ Tab\t Newline\n Control\x01 Caf\xC3\xA9", Type::kUnion, 8);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      USYM::FieldSymbol& field = AddField(usym, escaped, 10 + i, i == 0 ? "a" : "", 1);
+      field.isAnonymousUnion = i == 0;
+      field.unionId = 3;
+    }
+
+    auto& function = AddFunction(usym, 20, "operator<<", 2, { 1, 2 });
+    function.virtualAddress = 0xFFFFFFFFFFF;
+    function.length = 0x20;
+
+    usym.functionSymbols[21].id = 21;
+
+    return usym;
+  }
+
+  std::string ReadFile(const std::string& aFileName)
+  {
+    std::ifstream file(aFileName, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  std::string Serialize(ISerializer::Type aType, const char* apFileName)
+  {
+    USYM usym = CreateTestUsym();
+    usym.SetSerializer(aType);
+    EXPECT_EQ(usym.Serialize(apFileName), ISerializer::SerializeResult::kOk);
+
+    return ReadFile(std::string(apFileName) + ".json");
+  }
+
+  TEST(StreamingJsonSerializer, MatchesJsonSerializer)
+  {
+    const auto expected = nlohmann::json::parse(Serialize(ISerializer::Type::kJson, "StreamingJsonExpected"));
+
+    const std::string pretty = Serialize(ISerializer::Type::kStreamingJson, "StreamingJsonPretty");
+    EXPECT_EQ(nlohmann::json::parse(pretty), expected);
+
+    const std::string compact = Serialize(ISerializer::Type::kStreamingJsonCompact, "StreamingJsonCompact");
+    EXPECT_EQ(nlohmann::json::parse(compact), expected);
+
+    EXPECT_EQ(compact.find('\n'), std::string::npos);
+    EXPECT_LT(compact.size(), pretty.size());
+  }
+
+  TEST(StreamingJsonSerializer, PrettyOutputMatchesNlohmannLayout)
+  {
+    const std::string pretty = Serialize(ISerializer::Type::kStreamingJson, "StreamingJsonLayout");
+
+    // Same keys in the same order, so dumping the parsed document must give back the same text.
+    const auto document = nlohmann::ordered_json::parse(pretty);
+    EXPECT_EQ(document.dump(4) + "\n", pretty);
+  }
+}
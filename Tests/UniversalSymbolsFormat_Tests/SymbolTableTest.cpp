@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/SymbolTable.h>
+
+#include <string>
+
+namespace
+{
+  TEST(SymbolTable, IteratesInInsertionOrder)
+  {
+    SymbolTable<std::string> table{};
+    table[30] = "c";
+    table[10] = "a";
+    table[20] = "b";
+
+    std::string order{};
+    for (const auto& [id, value] : table)
+      order += value;
+
+    EXPECT_EQ(order, "cab");
+    EXPECT_EQ(table.IndexOf(10), 1);
+  }
+
+  TEST(SymbolTable, FindsSparseIds)
+  {
+    SymbolTable<uint32_t> table{};
+    // DWARF ids are DIE offsets, which are sparse and can be close to 2^32.
+    for (uint32_t i = 0; i < 10000; i++)
+      table.emplace(i * 4099 + 0xF0000000u, i);
+
+    ASSERT_EQ(table.size(), 10000);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+      const auto it = table.find(i * 4099 + 0xF0000000u);
+      ASSERT_NE(it, table.end());
+      EXPECT_EQ(it->second, i);
+    }
+
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(table.find(1), table.end());
+    EXPECT_THROW(table.at(1), std::out_of_range);
+  }
+
+  TEST(SymbolTable, EmplaceKeepsExistingSymbol)
+  {
+    SymbolTable<std::string> table{};
+
+    const auto [first, isFirstNew] = table.emplace(5, "first");
+    EXPECT_TRUE(isFirstNew);
+
+    const auto [second, isSecondNew] = table.emplace(5, "second");
+    EXPECT_FALSE(isSecondNew);
+    EXPECT_EQ(second->second, "first");
+    EXPECT_EQ(table.size(), 1);
+  }
+
+  TEST(SymbolTable, EraseIfKeepsLookupsValid)
+  {
+    SymbolTable<uint32_t> table{};
+    for (uint32_t i = 1; i <= 100; i++)
+      table[i] = i * 2;
+
+    const size_t erased = table.erase_if([](const auto& aEntry) {
+      return aEntry.first % 3 == 0;
+    });
+
+    EXPECT_EQ(erased, 33);
+    EXPECT_EQ(table.size(), 67);
+
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+      if (i % 3 == 0)
+        EXPECT_FALSE(table.contains(i));
+      else
+        EXPECT_EQ(table.at(i), i * 2);
+    }
+
+    EXPECT_EQ(table.begin()->first, 1);
+    EXPECT_EQ((table.begin() + 2)->first, 4);
+  }
+}
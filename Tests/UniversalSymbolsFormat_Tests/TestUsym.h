@@ -0,0 +1,45 @@
+#pragma once
+
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Builders for the small USYMs the tests write by hand. Names are interned in aUsym.
+// The returned references are only valid until the next symbol is added to the same table.
+
+inline USYM::TypeSymbol& AddType(USYM& aUsym, uint32_t aId, std::string_view aName, USYM::TypeSymbol::Type aType, uint64_t aLength = 0, uint32_t aTypedefSource = 0)
+{
+  USYM::TypeSymbol& symbol = aUsym.typeSymbols[aId];
+  symbol.id = aId;
+  symbol.name = aUsym.Intern(aName);
+  symbol.type = aType;
+  symbol.length = aLength;
+  symbol.typedefSource = aTypedefSource;
+  return symbol;
+}
+
+// Also keeps the field count of aType up to date.
+inline USYM::FieldSymbol& AddField(USYM& aUsym, USYM::TypeSymbol& aType, uint32_t aId, std::string_view aName, uint32_t aUnderlyingTypeId, size_t aOffset = 0)
+{
+  USYM::FieldSymbol& field = aType.fields.emplace_back();
+  field.id = aId;
+  field.name = aUsym.Intern(aName);
+  field.underlyingTypeId = aUnderlyingTypeId;
+  field.offset = aOffset;
+  aType.fieldCount = aType.fields.size();
+  return field;
+}
+
+inline USYM::FunctionSymbol& AddFunction(USYM& aUsym, uint32_t aId, std::string_view aName, uint32_t aReturnTypeId = 0, std::vector<uint32_t> aArgumentTypeIds = {})
+{
+  USYM::FunctionSymbol& function = aUsym.functionSymbols[aId];
+  function.id = aId;
+  function.name = aUsym.Intern(aName);
+  function.returnTypeId = aReturnTypeId;
+  function.argumentCount = static_cast<uint32_t>(aArgumentTypeIds.size());
+  function.argumentTypeIds = std::move(aArgumentTypeIds);
+  return function;
+}
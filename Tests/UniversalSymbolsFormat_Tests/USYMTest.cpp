@@ -2,8 +2,138 @@
 #include <UniversalSymbolsFormat/USYM.h>
 #include <DiaProcessor/DiaInterface.h>
 
+#include "TestUsym.h"
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
 namespace
 {
+  // A linked list node as it would appear in one compile unit: int, Node and Node*.
+  void AddLinkedList(USYM& aUsym, uint32_t aBaseId)
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    AddType(aUsym, aBaseId, "int", Type::kBase, 4);
+    AddType(aUsym, aBaseId + 1, "Node*", Type::kPointer, 8, aBaseId + 2);
+    auto& node = AddType(aUsym, aBaseId + 2, "Node", Type::kStruct, 16);
+    AddField(aUsym, node, aBaseId + 3, "value", aBaseId, 0);
+    AddField(aUsym, node, aBaseId + 4, "next", aBaseId + 1, 8);
+  }
+
+  TEST(USYM, PurgeDuplicateRecursiveTypes)
+  {
+    USYM usym{};
+    AddLinkedList(usym, 100);
+    AddLinkedList(usym, 200);
+    AddLinkedList(usym, 300);
+
+    auto& function = usym.functionSymbols[1];
+    function.id = 1;
+    function.returnTypeId = 301;
+    function.argumentTypeIds = { 202, 300 };
+    function.argumentCount = 2;
+
+    usym.PurgeDuplicateTypes();
+
+    ASSERT_EQ(usym.typeSymbols.size(), 3);
+    EXPECT_TRUE(usym.typeSymbols.contains(100));
+    EXPECT_TRUE(usym.typeSymbols.contains(101));
+    EXPECT_TRUE(usym.typeSymbols.contains(102));
+    EXPECT_EQ(usym.typeSymbols[102].fields[1].underlyingTypeId, 101);
+    EXPECT_EQ(usym.typeSymbols[101].typedefSource, 102);
+
+    EXPECT_EQ(function.returnTypeId, 101);
+    EXPECT_EQ(function.argumentTypeIds, std::vector<uint32_t>({ 102, 100 }));
+    EXPECT_TRUE(usym.VerifyTypeIds());
+  }
+
+  TEST(USYM, PurgeKeepsTypesThatOnlyDifferInReferencedTypes)
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    AddType(usym, 1, "int", Type::kBase, 4);
+    AddType(usym, 2, "float", Type::kBase, 4);
+    AddField(usym, AddType(usym, 3, "Value", Type::kStruct, 4), 4, "v", 1, 0);
+    AddField(usym, AddType(usym, 5, "Value", Type::kStruct, 4), 6, "v", 2, 0);
+    AddType(usym, 7, "Value*", Type::kPointer, 8, 3);
+    AddType(usym, 8, "Value*", Type::kPointer, 8, 5);
+
+    usym.PurgeDuplicateTypes();
+
+    EXPECT_EQ(usym.typeSymbols.size(), 6);
+  }
+
+  TEST(USYM, PurgeDistinguishesTypeKinds)
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    AddType(usym, 1, "Value", Type::kStruct, 4);
+    AddType(usym, 2, "Value", Type::kClass, 4);
+    AddType(usym, 3, "Value", Type::kStruct, 4);
+
+    usym.PurgeDuplicateTypes();
+
+    EXPECT_EQ(usym.typeSymbols.size(), 2);
+    EXPECT_TRUE(usym.typeSymbols.contains(1));
+    EXPECT_TRUE(usym.typeSymbols.contains(2));
+  }
+
+  TEST(USYM, InternSharesEqualNames)
+  {
+    USYM usym{};
+    const std::string name = "Value";
+
+    const std::string_view first = usym.Intern(name);
+    const std::string_view second = usym.Intern(std::string("Val") + "ue");
+
+    EXPECT_EQ(first, "Value");
+    EXPECT_EQ(first.data(), second.data());
+    EXPECT_NE(first.data(), name.data());
+    EXPECT_EQ(first.data()[first.size()], '\0');
+    EXPECT_EQ(usym.strings.GetCount(), 1);
+
+    EXPECT_TRUE(usym.Intern("").empty());
+    EXPECT_EQ(usym.strings.GetCount(), 1);
+  }
+
+  TEST(USYM, NamesOnlyComeFromThePool)
+  {
+    // A literal or a temporary string would not be found by the lookups by name.
+    static_assert(!std::is_assignable_v<InternedName&, const char*>);
+    static_assert(!std::is_assignable_v<InternedName&, std::string_view>);
+    static_assert(!std::is_constructible_v<InternedName, std::string>);
+
+    USYM usym{};
+    USYM other{};
+    const InternedName name = usym.Intern("Value");
+    EXPECT_EQ(name, other.Intern("Value"));
+    EXPECT_NE(name.data(), other.Intern("Value").data());
+    EXPECT_EQ(usym.strings.Find("Value").data(), name.data());
+    EXPECT_TRUE(usym.strings.Find("Other").empty());
+  }
+
+  TEST(USYM, InternedNamesSurviveMove)
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    AddType(usym, 1, "int", Type::kBase, 4);
+    // Enough names to need more than one block of the pool.
+    for (uint32_t i = 2; i < 10000; i++)
+      AddType(usym, i, ("Type" + std::to_string(i)).c_str(), Type::kStruct, 4);
+
+    const USYM moved = std::move(usym);
+
+    EXPECT_EQ(moved.typeSymbols.at(1).name, "int");
+    EXPECT_EQ(moved.typeSymbols.at(9999).name, "Type9999");
+    EXPECT_EQ(moved.GetTypeSymbolByName("Type5000").id, 5000);
+    EXPECT_EQ(moved.GetTypeSymbolByName("Type10000").id, 0);
+  }
+
   class USYMTest : public ::testing::Test
   {
   public:
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+#include <UniversalSymbolsFormat/UsymView.h>
+
+#include "TestUsym.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using DR = IDeserializer::DeserializeResult;
+
+  USYM CreateTestUsym(uint32_t aExtraTypeCount = 0)
+  {
+    using Type = USYM::TypeSymbol::Type;
+
+    USYM usym{};
+    usym.header.originalFormat = USYM::OriginalFormat::kPdb;
+    usym.header.architecture = USYM::Architecture::kArm64;
+
+    AddType(usym, 7, "int", Type::kBase, 4);
+    AddType(usym, 3, "Value*", Type::kPointer, 8, 5);
+
+    auto& value = AddType(usym, 5, "Value", Type::kStruct, 8);
+    AddField(usym, value, 100, "first", 7, 0);
+    AddField(usym, value, 101, "second", 7, 4);
+
+    // Structs without members, which have nothing in common to deduplicate on.
+    for (uint32_t i = 0; i < aExtraTypeCount; i++)
+      AddType(usym, 1000 + i * 3, "Extra" + std::to_string(i), Type::kStruct, i);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      // Overloads share a name.
+      auto& function = AddFunction(usym, 200 + i, "Overloaded", 3, std::vector<uint32_t>(i + 1, 7));
+      function.callingConvention = USYM::CallingConvention::kNearC;
+      function.virtualAddress = 0x1000 + i * 0x10;
+      function.length = 0x10;
+    }
+
+    return usym;
+  }
+
+  void Serialize(USYM& aUsym, const char* apFileName)
+  {
+    aUsym.SetSerializer(ISerializer::Type::kIndexedBinary);
+    ASSERT_EQ(aUsym.Serialize(apFileName), ISerializer::SerializeResult::kOk);
+  }
+
+  TEST(UsymView, FindsSymbols)
+  {
+    USYM usym = CreateTestUsym();
+    Serialize(usym, "UsymViewFind");
+
+    UsymView view{};
+    ASSERT_TRUE(view.Open("UsymViewFind.usym"));
+
+    EXPECT_EQ(view.GetOriginalFormat(), USYM::OriginalFormat::kPdb);
+    EXPECT_EQ(view.GetArchitecture(), USYM::Architecture::kArm64);
+
+    ASSERT_EQ(view.GetTypes().size(), 3);
+    EXPECT_EQ(view.GetTypes()[0].id, 3);
+    EXPECT_EQ(view.GetTypes()[2].id, 7);
+
+    const auto* pValue = view.FindTypeByName("Value");
+    ASSERT_NE(pValue, nullptr);
+    EXPECT_EQ(pValue->id, 5);
+    EXPECT_EQ(view.FindType(5), pValue);
+
+    const auto fields = view.GetFields(*pValue);
+    ASSERT_EQ(fields.size(), 2);
+    EXPECT_EQ(view.GetString(fields[1].name), "second");
+    EXPECT_EQ(fields[1].offset, 4);
+    EXPECT_EQ(fields[1].underlyingTypeId, 7);
+
+    const USYM::TypeSymbol symbol = view.ToTypeSymbol(*pValue, usym);
+    EXPECT_EQ(symbol, usym.typeSymbols.at(5));
+
+    const auto* pFunction = view.FindFunction(201);
+    ASSERT_NE(pFunction, nullptr);
+    EXPECT_EQ(view.GetString(pFunction->name), "Overloaded");
+    EXPECT_EQ(view.GetArgumentTypeIds(*pFunction).size(), 2);
+    EXPECT_EQ(pFunction->virtualAddress, 0x1010);
+    EXPECT_EQ(view.GetLength(*pFunction), 0x10);
+    EXPECT_EQ(view.ToFunctionSymbol(*pFunction, usym).length, 0x10);
+
+    const auto* pOverload = view.FindFunctionByName("Overloaded");
+    ASSERT_NE(pOverload, nullptr);
+    EXPECT_TRUE(pOverload->id == 200 || pOverload->id == 201);
+
+    EXPECT_EQ(view.FindType(4), nullptr);
+    EXPECT_EQ(view.FindTypeByName("Missing"), nullptr);
+    EXPECT_EQ(view.FindFunctionByName(""), nullptr);
+  }
+
+  TEST(UsymView, FindsEveryTypeInLargeFile)
+  {
+    constexpr uint32_t kExtraTypeCount = 5000;
+
+    USYM usym = CreateTestUsym(kExtraTypeCount);
+    Serialize(usym, "UsymViewLarge");
+
+    UsymView view{};
+    ASSERT_TRUE(view.Open("UsymViewLarge.usym"));
+    ASSERT_EQ(view.GetTypes().size(), kExtraTypeCount + 3);
+
+    for (uint32_t i = 0; i < kExtraTypeCount; i++)
+    {
+      const auto* pType = view.FindTypeByName("Extra" + std::to_string(i));
+      ASSERT_NE(pType, nullptr);
+      EXPECT_EQ(pType->id, 1000 + i * 3);
+      EXPECT_EQ(view.FindType(1000 + i * 3), pType);
+    }
+  }
+
+  TEST(UsymView, DeserializeIndexedFile)
+  {
+    USYM original = CreateTestUsym();
+    Serialize(original, "UsymViewDeserialize");
+
+    USYM usym{};
+    ASSERT_EQ(usym.Deserialize("UsymViewDeserialize.usym"), DR::kOk);
+
+    EXPECT_EQ(usym.header.originalFormat, original.header.originalFormat);
+    EXPECT_EQ(usym.header.architecture, original.header.architecture);
+
+    ASSERT_EQ(usym.typeSymbols.size(), original.typeSymbols.size());
+    for (const auto& [id, symbol] : original.typeSymbols)
+      EXPECT_EQ(usym.typeSymbols.at(id), symbol);
+
+    ASSERT_EQ(usym.functionSymbols.size(), original.functionSymbols.size());
+    EXPECT_EQ(usym.functionSymbols.at(201).argumentTypeIds, original.functionSymbols.at(201).argumentTypeIds);
+    EXPECT_EQ(usym.functionSymbols.at(201).length, 0x10);
+    EXPECT_EQ(usym.GetTypeSymbolByName("Value").id, 5);
+  }
+
+  TEST(UsymView, RejectsDamagedFiles)
+  {
+    USYM usym = CreateTestUsym();
+    Serialize(usym, "UsymViewDamaged");
+
+    std::vector<char> contents{};
+    {
+      std::ifstream file("UsymViewDamaged.usym", std::ios::binary);
+      contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    auto openWith = [](const std::vector<char>& aContents) {
+      {
+        std::ofstream file("UsymViewDamaged.usym", std::ios::binary | std::ios::trunc);
+        file.write(aContents.data(), aContents.size());
+      }
+
+      UsymView view{};
+      return view.Open("UsymViewDamaged.usym");
+    };
+
+    ASSERT_TRUE(openWith(contents));
+    EXPECT_FALSE(openWith(std::vector<char>(contents.begin(), contents.begin() + contents.size() / 2)));
+    EXPECT_FALSE(openWith(std::vector<char>(contents.begin(), contents.begin() + 8)));
+
+    std::vector<char> wrongVersion = contents;
+    wrongVersion[4] = 3;
+    EXPECT_FALSE(openWith(wrongVersion));
+  }
+}
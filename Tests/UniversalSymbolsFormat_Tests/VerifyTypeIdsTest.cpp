@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+
+#include "TestUsym.h"
+
+#include <string>
+
+namespace
+{
+  using Reference = USYM::TypeIdReport::Reference;
+
+  // aCount functions and structs, where every tenth of them references the missing type 999999.
+  USYM CreateTestUsym(uint32_t aCount)
+  {
+    USYM usym{};
+
+    AddType(usym, 1, "int", USYM::TypeSymbol::Type::kBase, 4);
+
+    for (uint32_t i = 0; i < aCount; i++)
+    {
+      const uint32_t missing = i % 10 == 0 ? 999999 : 1;
+
+      USYM::TypeSymbol& type = AddType(usym, 100 + i, "Struct" + std::to_string(i), USYM::TypeSymbol::Type::kStruct, 0, i % 20 == 0 ? missing : 0);
+      AddField(usym, type, 0, "field", missing);
+
+      AddFunction(usym, i + 1, "Function" + std::to_string(i), missing, { 1, missing, missing });
+    }
+
+    return usym;
+  }
+
+  TEST(VerifyTypeIds, CountsDanglingReferences)
+  {
+    const USYM usym = CreateTestUsym(100);
+
+    USYM::VerifyOptions options{};
+    options.maxSamples = 4;
+    const USYM::TypeIdReport report = usym.VerifyTypeIds(options);
+
+    EXPECT_FALSE(report.IsValid());
+    EXPECT_EQ(report.GetCount(Reference::kReturnType), 10);
+    EXPECT_EQ(report.GetCount(Reference::kArgumentType), 20);
+    EXPECT_EQ(report.GetCount(Reference::kTypedefSource), 5);
+    EXPECT_EQ(report.GetCount(Reference::kFieldType), 10);
+    EXPECT_EQ(report.GetTotalCount(), 45);
+
+    // The first references in table order, functions first.
+    ASSERT_EQ(report.samples.size(), 4);
+    EXPECT_EQ(report.samples[0].reference, Reference::kReturnType);
+    EXPECT_EQ(report.samples[0].symbolId, 1);
+    EXPECT_EQ(report.samples[0].typeId, 999999);
+    EXPECT_EQ(report.samples[1].reference, Reference::kArgumentType);
+    EXPECT_EQ(report.samples[2].reference, Reference::kArgumentType);
+    EXPECT_EQ(report.samples[3].reference, Reference::kReturnType);
+    EXPECT_EQ(report.samples[3].symbolId, 11);
+  }
+
+  TEST(VerifyTypeIds, ThreadCountDoesNotChangeReport)
+  {
+    // Large enough to be split over several chunks.
+    const USYM usym = CreateTestUsym(20000);
+
+    USYM::VerifyOptions options{};
+    options.threadCount = 1;
+    const USYM::TypeIdReport singleThreaded = usym.VerifyTypeIds(options);
+    options.threadCount = 8;
+    const USYM::TypeIdReport multiThreaded = usym.VerifyTypeIds(options);
+
+    EXPECT_EQ(singleThreaded.counts, multiThreaded.counts);
+    ASSERT_EQ(singleThreaded.samples.size(), multiThreaded.samples.size());
+    for (size_t i = 0; i < singleThreaded.samples.size(); i++)
+    {
+      EXPECT_EQ(singleThreaded.samples[i].reference, multiThreaded.samples[i].reference);
+      EXPECT_EQ(singleThreaded.samples[i].symbolId, multiThreaded.samples[i].symbolId);
+    }
+  }
+
+  TEST(VerifyTypeIds, ValidUsym)
+  {
+    USYM usym{};
+    USYM::FunctionSymbol& function = usym.functionSymbols[1];
+    function.id = 1;
+    function.returnTypeId = 0;
+
+    EXPECT_TRUE(usym.VerifyTypeIds(USYM::VerifyOptions{}).IsValid());
+    EXPECT_TRUE(usym.VerifyTypeIds());
+  }
+
+  TEST(VerifyTypeIds, SerializeWithEveryVerification)
+  {
+    using Verification = USYM::SerializeOptions::Verification;
+
+    for (const Verification verification : { Verification::kBefore, Verification::kConcurrent, Verification::kSkip })
+    {
+      USYM usym = CreateTestUsym(100);
+      usym.SetSerializer(ISerializer::Type::kBinary);
+
+      USYM::SerializeOptions options{};
+      options.verification = verification;
+      ASSERT_EQ(usym.Serialize("VerifyTypeIdsSerialize", options), ISerializer::SerializeResult::kOk);
+
+      USYM deserialized{};
+      ASSERT_EQ(deserialized.Deserialize("VerifyTypeIdsSerialize.usym"), IDeserializer::DeserializeResult::kOk);
+      EXPECT_EQ(deserialized.functionSymbols.size(), usym.functionSymbols.size());
+    }
+  }
+}
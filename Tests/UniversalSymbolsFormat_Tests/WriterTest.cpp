@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <UniversalSymbolsFormat/USYM.h>
+#include <Writer.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::vector<uint8_t> ReadFile(const std::string& aFileName)
+  {
+    std::ifstream file(aFileName, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  TEST(Writer, SplitsWritesOverChunks)
+  {
+    // A tiny first chunk, so almost every write crosses into a new chunk.
+    Writer writer{ 3 };
+
+    std::vector<uint8_t> expected{};
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+      std::vector<uint8_t> bytes(i % 37, static_cast<uint8_t>(i));
+      writer.WriteImpl(bytes.data(), bytes.size());
+      expected.insert(expected.end(), bytes.begin(), bytes.end());
+
+      uint32_t value = i;
+      writer.Write(value);
+      expected.insert(expected.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
+    }
+
+    writer.WriteString("end");
+    expected.insert(expected.end(), { 'e', 'n', 'd', '\0' });
+
+    EXPECT_EQ(writer.GetPosition(), expected.size());
+    // Chunks double, so at most half of the capacity is unused.
+    EXPECT_LE(writer.GetCapacity(), expected.size() * 2 + 3);
+
+    ASSERT_TRUE(writer.WriteToFile("WriterChunks.bin"));
+    EXPECT_EQ(ReadFile("WriterChunks.bin"), expected);
+  }
+
+  TEST(Writer, SmallOutputStaysSmall)
+  {
+    Writer writer{};
+    EXPECT_EQ(writer.GetCapacity(), 0);
+
+    uint64_t value = 1;
+    writer.Write(value);
+    EXPECT_EQ(writer.GetCapacity(), Writer::kDefaultInitialSize);
+  }
+
+  TEST(Writer, EmptyOutput)
+  {
+    Writer writer{};
+    ASSERT_TRUE(writer.WriteToFile("WriterEmpty.bin"));
+    EXPECT_EQ(std::filesystem::file_size("WriterEmpty.bin"), 0);
+  }
+
+  TEST(Writer, ResetKeepsFirstChunk)
+  {
+    Writer writer{ 16 };
+    std::vector<uint8_t> bytes(100, 1);
+    writer.WriteImpl(bytes.data(), bytes.size());
+
+    writer.Reset();
+    EXPECT_EQ(writer.GetPosition(), 0);
+    EXPECT_EQ(writer.GetCapacity(), 16);
+
+    writer.WriteString("reused");
+    ASSERT_TRUE(writer.WriteToFile("WriterReset.bin"));
+    EXPECT_EQ(ReadFile("WriterReset.bin"), (std::vector<uint8_t>{ 'r', 'e', 'u', 's', 'e', 'd', '\0' }));
+  }
+
+  TEST(Writer, BinarySerializerCanBeReused)
+  {
+    USYM usym{};
+    USYM::TypeSymbol& type = usym.typeSymbols[1];
+    type.id = 1;
+    type.name = usym.Intern("int");
+    type.type = USYM::TypeSymbol::Type::kBase;
+
+    usym.SetSerializer(ISerializer::Type::kBinary);
+    ASSERT_EQ(usym.Serialize("WriterReusedFirst"), ISerializer::SerializeResult::kOk);
+    ASSERT_EQ(usym.Serialize("WriterReusedSecond"), ISerializer::SerializeResult::kOk);
+
+    EXPECT_EQ(ReadFile("WriterReusedFirst.usym"), ReadFile("WriterReusedSecond.usym"));
+  }
+}
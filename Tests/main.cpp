@@ -8,6 +8,9 @@
 * 
 * NOTE: if you are running the test binary through Visual Studio,
 * put the "CppApp1.pdb" file in the "Generated" directory.
+*
+* The ElfProcessor tests expect a Linux build of "CppApp1" with debug info
+* (e.g. "g++ -g main.cpp -o CppApp1") in the same directory as the test binary.
 */
 
 int main(int argc, char* argv[])
@@ -1,5 +1,6 @@
 group "Tests"
 include("DiaProcessor_Tests")
+include("ElfProcessor_Tests")
 include("UniversalSymbolsFormat_Tests")
 include("Performance_Tests")
 include("Samples")
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <spdlog/spdlog.h>
+#include <spdlog/spdlog-inl.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <UniversalSymbolsFormat/BatchSymbolizer.h>
+
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Addresses are read and resolved this many at a time.
+constexpr size_t kBatchSize = 1 << 16;
+
+void InitializeLogger()
+{
+  // Logs go to stderr, so they do not mix with the symbolized addresses on stdout.
+  auto console = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
+  console->set_pattern("%^[%H:%M:%S] [%l]%$ %v");
+  auto logger = std::make_shared<spdlog::logger>("", spdlog::sinks_init_list{ console });
+  //logger->set_level(spdlog::level::debug);
+  set_default_logger(logger);
+}
+
+// Reads the hexadecimal address at the start of aLine, with or without 0x.
+bool ParseAddress(std::string_view aLine, uint64_t& aAddress)
+{
+  const size_t first = aLine.find_first_not_of(" \t");
+  if (first == std::string_view::npos)
+    return false;
+
+  aLine.remove_prefix(first);
+  if (aLine.starts_with("0x") || aLine.starts_with("0X"))
+    aLine.remove_prefix(2);
+
+  const auto [pEnd, error] = std::from_chars(aLine.data(), aLine.data() + aLine.size(), aAddress, 16);
+  return error == std::errc{} && (pEnd == aLine.data() + aLine.size() || *pEnd == ' ' || *pEnd == '\t' || *pEnd == '\r');
+}
+
+void SymbolizeBatch(BatchSymbolizer& aSymbolizer, const std::vector<std::string>& aLines, std::vector<uint64_t>& aAddresses,
+  std::vector<bool>& aIsAddress, std::vector<BatchSymbolizer::Result>& aResults, fmt::memory_buffer& aOutput)
+{
+  aResults.resize(aAddresses.size());
+  aSymbolizer.Symbolize(aAddresses, aResults);
+
+  size_t address = 0;
+  for (size_t i = 0; i < aLines.size(); i++)
+  {
+    if (!aIsAddress[i])
+    {
+      fmt::format_to(std::back_inserter(aOutput), "{} ??\n", aLines[i]);
+      continue;
+    }
+
+    const BatchSymbolizer::Result& result = aResults[address];
+    fmt::format_to(std::back_inserter(aOutput), "0x{:016x} ", aAddresses[address]);
+    address++;
+
+    if (!result.IsResolved())
+      fmt::format_to(std::back_inserter(aOutput), "??\n");
+    else if (aSymbolizer.GetFileCount() == 1)
+      fmt::format_to(std::back_inserter(aOutput), "{}+0x{:x}\n", result.name, result.offset);
+    else
+      fmt::format_to(std::back_inserter(aOutput), "{}+0x{:x} ({})\n", result.name, result.offset, aSymbolizer.GetFileName(result.fileIndex));
+  }
+
+  std::fwrite(aOutput.data(), 1, aOutput.size(), stdout);
+  aOutput.clear();
+}
+
+int main(int argc, char* argv[])
+{
+  InitializeLogger();
+
+  std::string inputFile{};
+  std::vector<std::string> usymFiles{};
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string argument = argv[i];
+    if (argument == "-i" && i + 1 < argc)
+      inputFile = argv[++i];
+    else
+      usymFiles.push_back(argument);
+  }
+
+  if (usymFiles.empty())
+  {
+    spdlog::info("Usage: {} [-i path_to_addresses] [path_to_usym]...", argv[0]);
+    spdlog::info("Reads one hexadecimal address per line, from stdin if no address file is given.");
+    exit(1);
+  }
+
+  BatchSymbolizer symbolizer{};
+  for (const auto& usymFile : usymFiles)
+  {
+    if (!symbolizer.AddFile(usymFile))
+    {
+      spdlog::error("Failed to load symbols from {}.", usymFile);
+      exit(1);
+    }
+  }
+
+  std::ifstream file{};
+  if (!inputFile.empty())
+  {
+    file.open(inputFile);
+    if (!file)
+    {
+      spdlog::error("Failed to open {}.", inputFile);
+      exit(1);
+    }
+  }
+
+  std::ios::sync_with_stdio(false);
+  std::istream& input = inputFile.empty() ? std::cin : file;
+
+  std::vector<std::string> lines{};
+  std::vector<uint64_t> addresses{};
+  std::vector<bool> isAddress{};
+  std::vector<BatchSymbolizer::Result> results{};
+  fmt::memory_buffer output{};
+
+  lines.reserve(kBatchSize);
+  addresses.reserve(kBatchSize);
+  isAddress.reserve(kBatchSize);
+
+  std::string line{};
+  while (std::getline(input, line))
+  {
+    uint64_t address = 0;
+    const bool parsed = ParseAddress(line, address);
+    if (parsed)
+      addresses.push_back(address);
+
+    isAddress.push_back(parsed);
+    lines.push_back(std::move(line));
+
+    if (lines.size() == kBatchSize)
+    {
+      SymbolizeBatch(symbolizer, lines, addresses, isAddress, results, output);
+      lines.clear();
+      addresses.clear();
+      isAddress.clear();
+    }
+  }
+
+  if (!lines.empty())
+    SymbolizeBatch(symbolizer, lines, addresses, isAddress, results, output);
+}
@@ -0,0 +1,21 @@
+group "Apps"
+project "UniSymbolizer"
+   kind "ConsoleApp"
+   language "C++"
+
+   files {"**.h", "**.cpp"}
+
+   includedirs 
+   {
+      "../Components",
+      "../Libraries/RECore",
+      "../Vendor/spdlog/include",
+   }
+
+   libdirs
+   {
+      "../Build/Bin/%{cfg.longname}"
+   }
+
+   links "UniversalSymbolsFormat"
+   links "RECore"
\ No newline at end of file
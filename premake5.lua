@@ -28,4 +28,5 @@ include("Libraries")
 include("Components")
 include("PdbToUni")
 include("DwarfToUni")
+include("UniSymbolizer")
 include("Tests")
\ No newline at end of file